@@ -86,11 +86,9 @@ void runSolver(PSSolver* solver, int startHorizon, int endHorizon, int maxSteps)
          i = solver->getStepCount()) {
 
   	  solver->step();
-  	  PSList<std::string> flaws;
   	  if (solver->isConstraintConsistent()) {
-  		  flaws = solver->getFlaws();
   		  //printFlaws(i,flaws);
-  		  if (flaws.size() == 0)
+  		  if (!solver->hasFlaws())
   			  break;
   	  }
   	  else
@@ -46,10 +46,15 @@ namespace EUROPA
     virtual void clearEmptyVariables();
     virtual void relaxEmptyVariables();
 
+    virtual void addConflictVariable(ConstrainedVariableId v);
+    virtual void removeConflictVariable(ConstrainedVariableId v);
+    virtual const ConstrainedVariableSet& getConflictVariables() const;
+
   protected:
     unsigned int m_maxViolationsAllowed;
     ConstraintSet m_violatedConstraints;
     ConstrainedVariableSet m_emptyVariables;
+    ConstrainedVariableSet m_conflictVariables;
     bool m_relaxing;
 
     ConstraintEngine & m_ce; // for sending back messages
@@ -57,7 +62,7 @@ namespace EUROPA
 
   ViolationMgrImpl::ViolationMgrImpl(unsigned int maxViolationsAllowed, ConstraintEngine& ce)
       : m_maxViolationsAllowed(maxViolationsAllowed), m_violatedConstraints(), 
-        m_emptyVariables(), m_relaxing(false), m_ce(ce)
+        m_emptyVariables(), m_conflictVariables(), m_relaxing(false), m_ce(ce)
   {
   }
 
@@ -200,6 +205,7 @@ PSList<PSConstraint*> ViolationMgrImpl::getAllViolations() const {
   void ViolationMgrImpl::clearEmptyVariables()
   {
     m_emptyVariables.clear();
+    m_conflictVariables.clear();
   }
 
   void ViolationMgrImpl::relaxEmptyVariables()
@@ -225,9 +231,26 @@ PSList<PSConstraint*> ViolationMgrImpl::getAllViolations() const {
     	m_emptyVariables.erase(v);
     }
 
+    m_conflictVariables.clear();
     m_relaxing = false;
   }
 
+  void ViolationMgrImpl::addConflictVariable(ConstrainedVariableId v)
+  {
+    debugMsg("ConstraintEngine:ViolationMgr", "Marking ConstrainedVariable as part of the conflict : " << v->toLongString());
+    m_conflictVariables.insert(v);
+  }
+
+  void ViolationMgrImpl::removeConflictVariable(ConstrainedVariableId v)
+  {
+    m_conflictVariables.erase(v);
+  }
+
+  const ConstrainedVariableSet& ViolationMgrImpl::getConflictVariables() const
+  {
+    return m_conflictVariables;
+  }
+
 namespace {
 bool allActiveVariables(const std::vector<ConstrainedVariableId>& vars) {
   for (std::vector<ConstrainedVariableId>::const_iterator it = vars.begin(); it != vars.end(); ++it) {
@@ -333,6 +356,19 @@ DomainListenerId ConstraintEngine::allocateVariableListener(const ConstrainedVar
     delete m_violationMgr;
   }
 
+  ConstraintEngineId ConstraintEngine::fork() const {
+    ConstraintEngine* child = new ConstraintEngine(m_schema);
+    for(PropagatorSet::const_iterator it = m_propagators.begin(); it != m_propagators.end(); ++it){
+      PropagatorId propagator = (*it)->copy(child->getId());
+      checkError(propagator.isValid(), "Failed to copy propagator " << (*it)->getName().toString());
+      if(!(*it)->isEnabled())
+        propagator->disable();
+    }
+    child->m_autoPropagate = m_autoPropagate;
+    child->setAllowViolations(getAllowViolations());
+    return child->getId();
+  }
+
   /**
    * Even if propagation is enabled automatically, we don't want to do it if already going on.
    */
@@ -456,6 +492,7 @@ DomainListenerId ConstraintEngine::allocateVariableListener(const ConstrainedVar
 
     if(getViolationMgr().isEmpty(variable))
       clearEmptyVariables();
+    getViolationMgr().removeConflictVariable(variable);
 
     publish(notifyRemoved(variable));
 
@@ -767,6 +804,21 @@ DomainListenerId ConstraintEngine::allocateVariableListener(const ConstrainedVar
     return result;
   }
 
+  bool ConstraintEngine::propagateDeferred(){
+    if(!propagate())
+      return false;
+
+    for(PropagatorSet::const_iterator it = m_propagators.begin(); it != m_propagators.end() && !provenInconsistent(); ++it){
+      if((*it)->isEnabled())
+        (*it)->executeDeferred();
+    }
+
+    // propagating now would relax what the deferred work emptied
+    if(provenInconsistent())
+      return false;
+    return propagate();
+  }
+
 void ConstraintEngine::notify(const ConstrainedVariableId source,
                               const DomainListener::ChangeType& changeType){
   check_error(!Entity::isPurging());
@@ -1079,6 +1131,21 @@ void ConstraintEngine::notify(const ConstrainedVariableId source,
     return m_violationMgr->isViolated(c);
   }
 
+  const ConstrainedVariableSet& ConstraintEngine::getEmptyVariables() const
+  {
+    return m_violationMgr->getEmptyVariables();
+  }
+
+  void ConstraintEngine::addConflictVariable(const ConstrainedVariableId var)
+  {
+    m_violationMgr->addConflictVariable(var);
+  }
+
+  const ConstrainedVariableSet& ConstraintEngine::getConflictVariables() const
+  {
+    return m_violationMgr->getConflictVariables();
+  }
+
   bool ConstraintEngine::isRelaxed() const {return !m_relaxed.empty();}
 
   PSVariable* ConstraintEngine::getVariableByKey(PSEntityKey id)
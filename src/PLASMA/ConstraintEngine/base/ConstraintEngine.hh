@@ -51,6 +51,10 @@ typedef Id<ConstraintEngineListener> ConstraintEngineListenerId;
   	  virtual void clearEmptyVariables() = 0;
       virtual void relaxEmptyVariables() = 0;
 
+      virtual void addConflictVariable(ConstrainedVariableId v) = 0;
+      virtual void removeConflictVariable(ConstrainedVariableId v) = 0;
+      virtual const ConstrainedVariableSet& getConflictVariables() const = 0;
+
   	protected:
   	   ViolationMgr() {}
   	   virtual ~ViolationMgr() {}
@@ -170,6 +174,13 @@ typedef Id<ConstraintEngineListener> ConstraintEngineListenerId;
      */
     void purge();
 
+    /**
+     * @brief Allocate a new, empty engine which shares this engine's schema and has a copy of each of
+     * its propagators, registered in the same order.  The caller owns the result.
+     * @see Propagator::copy(), PlanDatabase::fork()
+     */
+    ConstraintEngineId fork() const;
+
     /**
      * @brief test if the state is PROVEN_INCONSISTENT.
      */
@@ -211,6 +222,14 @@ typedef Id<ConstraintEngineListener> ConstraintEngineListenerId;
      */
     virtual bool propagate();
 
+    /**
+     * @brief Propagate, then have each propagator finish the work it put off on purpose (such as
+     * resource profiles past a horizon).  Call before taking a plan to be complete.
+     * @return true if the resulting state is CONSTRAINT_CONSISTENT.  Otherwise the state is left
+     * PROVEN_INCONSISTENT for the caller to see.
+     */
+    bool propagateDeferred();
+
     /**
      * @brief Indicates whether the ConstraintEngine is able to continue propagation.
      * should be invoked after the constraint has been proven inconsistent so that Propagators
@@ -302,6 +321,23 @@ typedef Id<ConstraintEngineListener> ConstraintEngineListenerId;
      */
     bool isViolated(ConstraintId c) const;
 
+    /**
+     * @brief The variables whose domains were emptied by the last propagation, if it failed
+     */
+    const ConstrainedVariableSet& getEmptyVariables() const;
+
+    /**
+     * @brief Names a variable whose domain, though not emptied, is part of the reason the current
+     * propagation fails, for when the constraints don't relate it to the emptied ones.  Forgotten
+     * along with the empty variables.
+     */
+    void addConflictVariable(const ConstrainedVariableId var);
+
+    /**
+     * @brief The variables named by addConflictVariable() since the empty variables were last cleared
+     */
+    const ConstrainedVariableSet& getConflictVariables() const;
+
     /**
      * @brief Test of the network is in a relaxed state
      */
@@ -25,6 +25,11 @@ namespace EUROPA
 
   int Propagator::getPriority() const { return m_priority; }
 
+  PropagatorId Propagator::copy(const ConstraintEngineId) const {
+    checkError(ALWAYS_FAIL, "Propagator " << m_name.toString() << " does not support copying.");
+    return PropagatorId::noId();
+  }
+
   const PropagatorId Propagator::getId() const {return m_id;}
 
   const LabelStr& Propagator::getName() const {return m_name;}
@@ -74,6 +79,7 @@ namespace EUROPA
 
 void Propagator::handleVariableDeactivated(const ConstrainedVariableId){}
 void Propagator::handleVariableActivated(const ConstrainedVariableId){}
+void Propagator::executeDeferred(){}
 
 
 }
@@ -70,6 +70,13 @@ namespace EUROPA {
 
     int getPriority() const;
 
+    /**
+     * @brief Allocate an equivalent, empty propagator in another engine.
+     * @param constraintEngine The engine to place the copy in.
+     * @see ConstraintEngine::fork()
+     */
+    virtual PropagatorId copy(const ConstraintEngineId constraintEngine) const;
+
   protected:
     friend class ConstraintEngine; /**< Grant access so protected members can be used to enforce collaboration model
                                       without exposing details publically. */
@@ -125,6 +132,12 @@ namespace EUROPA {
      */
     virtual bool updateRequired() const = 0;
 
+    /**
+     * @brief Instruction from ConstraintEngine to finish any work execute() put off on purpose.
+     * @see ConstraintEngine::propagateDeferred()
+     */
+    virtual void executeDeferred();
+
     /**
      * @brief Allow custom processing when a Constraint is added to the Propagator.
      * @param constraint The Constraint to be added.
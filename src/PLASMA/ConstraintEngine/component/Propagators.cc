@@ -23,6 +23,10 @@ DefaultPropagator::DefaultPropagator(const LabelStr& name,
       m_agenda(),
       m_activeConstraint(0) { }
 
+  PropagatorId DefaultPropagator::copy(const ConstraintEngineId constraintEngine) const {
+    return (new DefaultPropagator(getName(), constraintEngine, getPriority()))->getId();
+  }
+
   void DefaultPropagator::handleConstraintAdded(const ConstraintId constraint){
     debugMsg("DefaultPropagator:handleConstraintAdded", "Adding to the agenda: " << constraint->getName().toString() << "(" << constraint->getKey() << ")");
     m_agenda.insert(constraint);
@@ -115,6 +119,10 @@ EqualityConstraintPropagator::EqualityConstraintPropagator(const LabelStr& name,
 
   EqualityConstraintPropagator::~EqualityConstraintPropagator(){}
 
+  PropagatorId EqualityConstraintPropagator::copy(const ConstraintEngineId constraintEngine) const {
+    return (new EqualityConstraintPropagator(getName(), constraintEngine))->getId();
+  }
+
   void EqualityConstraintPropagator::execute() {
     check_error(!m_active);
     m_active = true;
@@ -19,6 +19,7 @@ namespace EUROPA {
   {
   public:
     DefaultPropagator(const LabelStr& name, const ConstraintEngineId constraintEngine, int priority=USER_PRIORITY);
+    virtual PropagatorId copy(const ConstraintEngineId constraintEngine) const;
     virtual void execute();
     virtual bool updateRequired() const;
   protected:
@@ -59,6 +60,8 @@ namespace EUROPA {
 
     ~EqualityConstraintPropagator();
 
+    PropagatorId copy(const ConstraintEngineId constraintEngine) const;
+
     void execute();
 
     bool updateRequired() const;
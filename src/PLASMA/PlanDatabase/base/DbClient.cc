@@ -139,6 +139,33 @@ ObjectId DbClient::createObject(const char* type, const char* name){
     return(token);
   }
 
+  void DbClient::createTokens(const char* tokenType,
+                              unsigned int count,
+                              std::vector<TokenId>& results,
+                              bool rejectable,
+                              bool isFact) {
+    checkError(supportsAutomaticAllocation(), "Cannot allocate tokens from the schema.");
+    const ConstraintEngineId ce = m_planDb->getConstraintEngine();
+    bool autoPropagate = ce->getAutoPropagation();
+    ce->setAutoPropagation(false);
+
+    std::vector<TokenId>::size_type first = results.size();
+    m_planDb->createTokens(tokenType, count, rejectable, isFact, results);
+
+    if (isTransactionLoggingEnabled()) {
+      m_keysOfTokensCreated.reserve(m_keysOfTokensCreated.size() + count);
+      for(std::vector<TokenId>::size_type i = first; i < results.size(); i++)
+        m_keysOfTokensCreated.push_back(results[i]->getKey());
+    }
+
+    debugMsg("DbClient:createTokens", "Created " << count << " " << tokenType);
+    for(std::vector<TokenId>::size_type i = first; i < results.size(); i++)
+      publish(notifyTokenCreated(results[i]));
+
+    // Restoring automatic propagation will propagate once for the whole batch
+    ce->setAutoPropagation(autoPropagate);
+  }
+
 void DbClient::deleteToken(const TokenId token, const std::string& name) {
   check_error(token.isValid());
   checkError(token->isInactive() || token->isFact(),
@@ -488,6 +515,18 @@ void DbClient::deleteToken(const TokenId token, const std::string& name) {
       return dynamic_cast<PSToken*>(static_cast<Token*>(tok));
   }
 
+  PSList<PSToken*> PSPlanDatabaseClientImpl::createTokens(const std::string& predicateName, unsigned int count,
+                                                          bool rejectable, bool isFact)
+  {
+      std::vector<TokenId> tokens;
+      m_client->createTokens(predicateName.c_str(), count, tokens, rejectable, isFact);
+
+      PSList<PSToken*> retval;
+      for(std::vector<TokenId>::const_iterator it = tokens.begin(); it != tokens.end(); ++it)
+          retval.push_back(dynamic_cast<PSToken*>(static_cast<Token*>(*it)));
+      return retval;
+  }
+
   void PSPlanDatabaseClientImpl::deleteToken(PSToken* token)
   {
       m_client->deleteToken(toId(token));
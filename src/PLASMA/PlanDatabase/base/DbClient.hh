@@ -100,6 +100,20 @@ namespace EUROPA {
                         bool rejectable = false,
                         bool isFact = false);
 
+    /**
+     * @brief Constructs count Token instances of the same type in one go, e.g. to load an initial state.
+     * Propagation is held off until all are created, and listeners are notified of each token afterwards,
+     * in order of creation.
+     * @param tokenType The name of the predicate for which the tokens are instances.
+     * @param count The number of tokens to create.
+     * @param results The created tokens are appended here.
+     */
+    void createTokens(const char* tokenType,
+                      unsigned int count,
+                      std::vector<TokenId>& results,
+                      bool rejectable = false,
+                      bool isFact = false);
+
     /**
      * @brief Deletes a token instance.  By way of symmetry with createToken().
      */
@@ -371,6 +385,7 @@ namespace EUROPA {
       virtual void deleteObject(PSObject* obj);
 
       virtual PSToken* createToken(const std::string& predicateName, bool rejectable, bool isFact);
+      virtual PSList<PSToken*> createTokens(const std::string& predicateName, unsigned int count, bool rejectable, bool isFact);
       virtual void deleteToken(PSToken* token);
 
       virtual void constrain(PSObject* object, PSToken* predecessor, PSToken* successor);
@@ -15,6 +15,10 @@ namespace EUROPA {
     //    std::cout << "Default Advisor being constructed" << m_id << std::endl;
   }
 
+  TemporalAdvisorId DefaultTemporalAdvisor::copy(const ConstraintEngineId constraintEngine) const {
+    return (new DefaultTemporalAdvisor(constraintEngine))->getId();
+  }
+
   DefaultTemporalAdvisor::~DefaultTemporalAdvisor(){
     //    std::cout << "Default Advisor being destroyed" << m_id << std::endl;
     m_id.remove();
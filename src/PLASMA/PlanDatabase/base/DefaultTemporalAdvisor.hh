@@ -36,6 +36,7 @@ namespace EUROPA{
                                           std::vector<eint>& lbs,
                                           std::vector<eint>& ubs);
     virtual unsigned int mostRecentRepropagation() const;
+    virtual TemporalAdvisorId copy(const ConstraintEngineId constraintEngine) const;
 
     const TemporalAdvisorId getId() const;
   protected:
@@ -4,7 +4,7 @@
 #include "ConstraintType.hh"
 #include "TokenVariable.hh"
 #include "Utils.hh"
-#include <map>
+#include "Domain.hh"
 
 namespace EUROPA{
 
@@ -35,7 +35,7 @@ namespace EUROPA{
 
   MergeMemento::MergeMemento(const TokenId inactiveToken, const TokenId activeToken)
     :m_inactiveToken(inactiveToken), m_activeToken(activeToken),
-     m_deactivatedConstraints(), m_newConstraints(), m_undoing(false){
+     m_migratedConstraints(), m_restrictedVariables(), m_undoing(false){
 
     checkError(inactiveToken.isValid(), inactiveToken);
     checkError(activeToken.isValid(), activeToken);
@@ -47,33 +47,39 @@ namespace EUROPA{
 
     check_error(inactiveVariables.size() == activeVariables.size());
 
-    std::map<eint, ConstrainedVariableId> varMap;
-    std::set<ConstraintId> deactivatedConstraints;
+    ConstraintSet deactivatedConstraints;
 
     //Exclude this for the state variable, which will necessarily conflict with the target active token
     for(unsigned long i=1; i<inactiveVariables.size(); i++){
-      check_error(varMap.find(inactiveVariables[i]->getKey()) == varMap.end());
-      // Add to the map to support lookup and store all constraints on any variables
-      varMap.insert(std::make_pair(inactiveVariables[i]->getKey(), activeVariables[i]));
+      // Store all constraints on any variables, i.e. not a state variable
       inactiveVariables[i]->constraints(deactivatedConstraints);
-      // i.e. not a state variable
 
-      // Post restrictions arising from the base domain
-      activeVariables[i]->handleBase(inactiveVariables[i]->baseDomain());
+      // Post restrictions arising from the base domain. Most merges are between tokens with the same base domains,
+      // in which case there is nothing to post, or to retract on undo.
+      const Domain& activeBase = activeVariables[i]->baseDomain();
+      const Domain& inactiveBase = inactiveVariables[i]->baseDomain();
+      bool restricted = activeBase.isOpen() || activeBase.isEmpty() || inactiveBase.isEmpty() ||
+        !Domain::canBeCompared(activeBase, inactiveBase) || !activeBase.isSubsetOf(inactiveBase);
+      if(restricted)
+        activeVariables[i]->handleBase(inactiveBase);
 
       // if the variable is specified, then post its value to active variable
       if(inactiveVariables[i]->isSpecified()){
 	checkError(inactiveVariables[i]->lastDomain().isSingleton(),
 		   inactiveVariables[i]->toString() << " is specified but not a singleton. Pas possible!");
 	activeVariables[i]->handleSpecified(inactiveVariables[i]->lastDomain().getSingletonValue());
+	restricted = true;
       }
 
+      if(restricted)
+        m_restrictedVariables.push_back(i);
+
       // Deactivate variable
       inactiveVariables[i]->deactivate();
     }
 
     // Iterate over all constraints and deactivate them, as well as create and store new ones where necessary
-    for(std::set<ConstraintId>::const_iterator it = deactivatedConstraints.begin(); it != deactivatedConstraints.end(); ++it){
+    for(ConstraintSet::const_iterator it = deactivatedConstraints.begin(); it != deactivatedConstraints.end(); ++it){
       ConstraintId constraint = *it;
       // Standard constraints will not be migrated as they will be built in to the target already
       if(!m_inactiveToken->isStandardConstraint(constraint))
@@ -94,18 +100,22 @@ namespace EUROPA{
     m_undoing = true;
 
     // If the active token is committed, and the merged token is being terminated, then we leave the new constraints.
-    // othwreiwse we can nuke them
-    discardAll(m_newConstraints);
-
-    // Clear the deactivated ocnstraints
-    m_deactivatedConstraints.clear();
-
+    // othwreiwse we can nuke them. Their removal relaxes the active token variables they were placed on.
+    for(std::map<ConstraintId, ConstraintId, EntityComparator<ConstraintId> >::const_iterator it = m_migratedConstraints.begin();
+        it != m_migratedConstraints.end(); ++it){
+      ConstraintId newConstraint = it->second;
+      if(!newConstraint.isNoId()){
+        check_error(newConstraint.isValid());
+        newConstraint->discard();
+      }
+    }
+    m_migratedConstraints.clear();
 
-    // Iterate over all active token variables and trigger a reset of the domain
+    // Trigger a reset of the domain for the active token variables restricted directly by the merge
     if(!activeTokenDeleted){
       const std::vector<ConstrainedVariableId>& activeVariables = m_activeToken->getVariables();
-      for(unsigned int i=1;i<activeVariables.size();i++) // We skip the State Variable
-	activeVariables[i]->handleReset();
+      for(std::vector<unsigned long>::const_iterator it = m_restrictedVariables.begin(); it != m_restrictedVariables.end(); ++it)
+	activeVariables[*it]->handleReset();
     }
 
     // Iterate over all variables in this token and trigger a reset of the domain to force
@@ -124,38 +134,26 @@ namespace EUROPA{
   }
 
   void MergeMemento::handleRemovalOfInactiveConstraint(const ConstraintId constraint){
-    check_error(m_deactivatedConstraints.size() + m_inactiveToken->getVariables().size() >= m_newConstraints.size());
     checkError(!constraint->isActive(), constraint->toString());
 
     if(m_undoing)
       return;
 
-    // Iterate through the lists and delete when found
-    std::list<ConstraintId>::iterator it_1 = m_deactivatedConstraints.begin();
-    std::list<ConstraintId>::iterator it_2 = m_newConstraints.begin();
-
-    while(it_1 != m_deactivatedConstraints.end()){
-      if((*it_1) == constraint){
-	ConstraintId newConstraint = *it_2;
-
-	// Ensure that if a constraint was migrated, it has the same scope length at least.
-	checkError(newConstraint.isNoId() || (newConstraint->getScope().size() == constraint->getScope().size()),
-		   newConstraint->toString() << " does not match " << constraint->toString());
+    std::map<ConstraintId, ConstraintId, EntityComparator<ConstraintId> >::iterator it = m_migratedConstraints.find(constraint);
+    if(it == m_migratedConstraints.end())
+      return;
 
-	// Remove from both lists at this location.
-	m_deactivatedConstraints.erase(it_1);
-	m_newConstraints.erase(it_2);
+    ConstraintId newConstraint = it->second;
 
-	// Now delete the new constraint which arose from migration, if it was migrated
-	if(!newConstraint.isNoId())
-	  newConstraint->discard();
+    // Ensure that if a constraint was migrated, it has the same scope length at least.
+    checkError(newConstraint.isNoId() || (newConstraint->getScope().size() == constraint->getScope().size()),
+	       newConstraint->toString() << " does not match " << constraint->toString());
 
-	return;
-      }
+    m_migratedConstraints.erase(it);
 
-      it_1++;
-      it_2++;
-    }
+    // Now delete the new constraint which arose from migration, if it was migrated
+    if(!newConstraint.isNoId())
+      newConstraint->discard();
   }
 
   void MergeMemento::migrateConstraint(const ConstraintId constraint){
@@ -164,6 +162,8 @@ namespace EUROPA{
     checkError(m_activeToken->isActive(), m_activeToken->toString());
 
 
+    ConstraintId newConstraint;
+
     // If it is not a standard constraint, then we need to create a surrogate as the target active token
     // may not have it already.
     if(!m_inactiveToken->isStandardConstraint(constraint)){
@@ -195,14 +195,14 @@ namespace EUROPA{
 
 
       debugMsg("europa:merging:migrateConstraint", "Creating replacement for " << constraint->toString());
-      ConstraintId newConstraint;
       newConstraint = m_activeToken->getPlanDatabase()->getConstraintEngine()->createConstraint(constraint->getName(),newScope);
 
       // Now set the source on the new constraint to give opportunity to pass data
       newConstraint->setSource(constraint);
-      m_newConstraints.push_back(newConstraint);
     }
 
-    m_deactivatedConstraints.push_back(constraint);
+    checkError(m_migratedConstraints.find(constraint) == m_migratedConstraints.end(),
+               constraint->toString() << " has already been migrated.");
+    m_migratedConstraints.insert(std::make_pair(constraint, newConstraint));
   }
 }
@@ -3,7 +3,7 @@
 
 #include "ConstraintEngineDefs.hh"
 #include "PlanDatabaseDefs.hh"
-#include <list>
+#include <map>
 #include <vector>
 
 namespace EUROPA{
@@ -37,8 +37,17 @@ namespace EUROPA{
     const TokenId m_inactiveToken;
     const TokenId m_activeToken;
 
-    std::list<ConstraintId> m_deactivatedConstraints;
-    std::list<ConstraintId> m_newConstraints;
+    /**
+     * @brief Deactivated constraints of the inactive token, mapped to their replacement on the active token
+     * (noId if not migrated).
+     */
+    std::map<ConstraintId, ConstraintId, EntityComparator<ConstraintId> > m_migratedConstraints;
+
+    /**
+     * @brief Indices of active token variables whose base domain or specified value was restricted by the merge.
+     * Only these need to be reset on undo; the rest are relaxed by removal of the migrated constraints.
+     */
+    std::vector<unsigned long> m_restrictedVariables;
     bool m_undoing;
   };
 }
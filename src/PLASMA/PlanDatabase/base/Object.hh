@@ -109,6 +109,8 @@ namespace EUROPA {
      * @brief Get all possible active tokens on this object which may be used to order the given token.
      * @param token The Token for which we want to evaluate possible choices
      * @param results Will be populated with the choices for constraining this token.
+     * @param limit The most choices to return. Overrides must return a prefix of the full list, in the same
+     * order, since choices are generated on demand by asking again with a larger limit.
      * @see constrain
      */
     virtual void getOrderingChoices( const TokenId token,
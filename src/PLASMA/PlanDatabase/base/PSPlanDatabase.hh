@@ -26,6 +26,18 @@ class PSPlanDatabaseClient;
       virtual PSList<PSTokenType*>  getPSTokenTypesByAttr( int attrMask ) const = 0;
   };
 
+  /**
+   * @brief A forward view over the tokens matched by a query, which yields them one at a time instead of
+   * copying them into a PSList. Only valid until the plan database is next changed. The caller owns it.
+   */
+  class PSTokenIterator
+  {
+    public:
+      virtual ~PSTokenIterator() {}
+      virtual bool done() const = 0;
+      virtual PSToken* next() = 0;
+  };
+
   class PSPlanDatabase : public EngineComponent
   {
     public:
@@ -39,6 +51,16 @@ class PSPlanDatabaseClient;
       virtual PSList<PSToken*> getAllTokens() const = 0;
       virtual PSToken* getTokenByKey(PSEntityKey id) const = 0;
 
+      /**
+       * @brief Active tokens which may be on the given object and may overlap [lb, ub].
+       */
+      virtual PSTokenIterator* getTokensOverlapping(PSObject* object, double lb, double ub) const = 0;
+
+      /**
+       * @brief Active tokens of the given predicate which may start in [lb, ub].
+       */
+      virtual PSTokenIterator* getActiveTokensStartingIn(const std::string& predicate, double lb, double ub) const = 0;
+
       virtual PSList<PSVariable*> getAllGlobalVariables() const = 0;
   };
 
@@ -127,6 +149,7 @@ class PSPlanDatabaseClient;
       virtual void deleteObject(PSObject* obj) = 0;
 
       virtual PSToken* createToken(const std::string& predicateName, bool rejectable, bool isFact) = 0;
+      virtual PSList<PSToken*> createTokens(const std::string& predicateName, unsigned int count, bool rejectable, bool isFact) = 0;
       virtual void deleteToken(PSToken* token) = 0;
 
       virtual void constrain(PSObject* object, PSToken* predecessor, PSToken* successor) = 0;
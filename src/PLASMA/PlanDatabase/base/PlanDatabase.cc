@@ -311,6 +311,16 @@ namespace EUROPA{
     m_temporalAdvisor = temporalAdvisor;
   }
 
+  PlanDatabaseId PlanDatabase::fork(const ConstraintEngineId constraintEngine) const {
+    check_error(constraintEngine.isValid() && constraintEngine != m_constraintEngine,
+                "A fork must have its own constraint engine.");
+    PlanDatabase* child = new PlanDatabase(constraintEngine, m_schema);
+    if(m_temporalAdvisor.isId())
+      child->setTemporalAdvisor(m_temporalAdvisor->copy(constraintEngine));
+    child->m_engine = m_engine;
+    return child->getId();
+  }
+
   const DbClientId PlanDatabase::getClient() const {
     return m_client;
   }
@@ -400,57 +410,38 @@ namespace EUROPA{
       return false;
   }
 
-  void PlanDatabase::getCompatibleTokens(const TokenId inactiveToken,
-                                         std::vector<TokenId>& results,
-                                         unsigned int limit,
-                                         bool useExactTest) {
-    if(!m_constraintEngine->propagate())
-      return;
-
-    // Draw from list of active tokens of the same predicate
-    const TokenSet& candidates = getActiveTokens(inactiveToken->getPredicateName());
-
-    condDebugMsg(candidates.empty(),
-		 "PlanDatabase:getCompatibleTokens", "No candidates to evaluate for " << inactiveToken->toString());
-
+  bool PlanDatabase::isCompatible(const TokenId inactiveToken, const TokenId candidate, bool useExactTest) {
     const std::vector<ConstrainedVariableId>& inactiveTokenVariables = inactiveToken->getVariables();
     unsigned long variableCount = inactiveTokenVariables.size();
 
-    unsigned int choiceCount = 0; // Used for comparison against given limit
-
-    TemporalAdvisorId temporalAdvisor = getTemporalAdvisor();
-
-    for(TokenSet::const_iterator it = candidates.begin(); it != candidates.end(); ++it){
-      TokenId candidate = *it;
-
-      debugMsg("PlanDatabase:getCompatibleTokens",
-               "Evaluating candidate token (" << candidate->getKey() << ") for token ("
-               << inactiveToken->getKey() << ")");
+    debugMsg("PlanDatabase:getCompatibleTokens",
+             "Evaluating candidate token (" << candidate->getKey() << ") for token ("
+             << inactiveToken->getKey() << ")");
 
-      // Validate expectation about being active and predicate being the same
-      check_error(m_schema->isA(candidate->getPredicateName(), inactiveToken->getPredicateName()),
-                  candidate->getPredicateName().toString() + " is not a " + inactiveToken->getPredicateName().toString());
+    // Validate expectation about being active and predicate being the same
+    check_error(m_schema->isA(candidate->getPredicateName(), inactiveToken->getPredicateName()),
+                candidate->getPredicateName().toString() + " is not a " + inactiveToken->getPredicateName().toString());
 
-      check_error(candidate->isActive(), "Should not be trying to merge an active token.");
+    check_error(candidate->isActive(), "Should not be trying to merge an active token.");
 
-      const std::vector<ConstrainedVariableId>& candidateTokenVariables = candidate->getVariables();
+    const std::vector<ConstrainedVariableId>& candidateTokenVariables = candidate->getVariables();
 
-      // Check assumption that the set of variables is the same
-      checkError(candidateTokenVariables.size() == static_cast<unsigned int>(variableCount),
+    // Check assumption that the set of variables is the same
+    checkError(candidateTokenVariables.size() == static_cast<unsigned int>(variableCount),
 		 "Candidate token (" << candidate->getKey() << ") has " <<
 		 candidateTokenVariables.size() << " variables, while inactive token (" <<
 		 inactiveToken->getKey() << ") has " << variableCount);
 
-      // Iterate and ensure there is an intersection. This could possibly be optmized based on
-      // the cost of comparing domains, or the likelihood of a variable excluding choice. Smaller domains
-      // would seem to offer better options on both counts, in general. Don't yet know if this even needs
-      // optimization
-      bool isCompatible = true;
+    // Iterate and ensure there is an intersection. This could possibly be optmized based on
+    // the cost of comparing domains, or the likelihood of a variable excluding choice. Smaller domains
+    // would seem to offer better options on both counts, in general. Don't yet know if this even needs
+    // optimization
+    bool compatible = true;
 
-      check_error(inactiveTokenVariables[0] == inactiveToken->getState(),
-                  "We expect the first var to be the state var, which we must skip.");
+    check_error(inactiveTokenVariables[0] == inactiveToken->getState(),
+                "We expect the first var to be the state var, which we must skip.");
 
-      for(unsigned int i=1;i<variableCount;i++){
+    for(unsigned int i=1;i<variableCount;i++){
 	const Domain& domA = inactiveTokenVariables[i]->lastDomain();
 	const Domain& domB = candidateTokenVariables[i]->lastDomain();
 
@@ -458,42 +449,63 @@ namespace EUROPA{
 		   domA.toString() << " cannot be compared to " << domB.toString() << ".");
 
 	if(domA.getSize() == 0 && domB.getSize() == 0)
-	  isCompatible = true;
+	  compatible = true;
 	else if(domA.isOpen() && domB.isOpen())
-		isCompatible = true;
+		compatible = true;
 	else if(domA.getSize() < domB.getSize())
-	  isCompatible = domA.intersects(domB);
+	  compatible = domA.intersects(domB);
 	else
-	  isCompatible = domB.intersects(domA);
+	  compatible = domB.intersects(domA);
 
-	if(!isCompatible) {
+	if(!compatible) {
 	  debugMsg("PlanDatabase:getCompatibleTokens",
 		   "EXCLUDING (" << candidate->getKey() << ")" <<
 		   "VAR=" << candidateTokenVariables[i]->getName().toString() <<
 		   "(" << candidateTokenVariables[i]->getKey() << ") " <<
 		   "Cannot intersect " << domA.toString() << " with " << domB.toString());
-	  break;
+	  return false;
 	}
 
 	debugMsg("PlanDatabase:getCompatibleTokens",
 		 "VAR=" << candidateTokenVariables[i]->getName().toString() <<
 		 "(" << candidateTokenVariables[i]->getKey() << ") " <<
 		 "Can intersect " << domA.toString() << " with " << domB.toString());
-      }
+    }
 
-      // If it is still compatible, we may wish to do a double check on the
-      // Temporal Variables, since we could get more pruning from the TemporalNetwork based on
-      // temporal distance. This is because temporal propagation is insufficient to ensure that if 2 timepoints
-      // have an intersection that they can actually co-exist. For example, if a < b, then there may well
-      // be an intersection but t would be immediately inconsistent of they were required to be concurrent.
-      if (isCompatible &&
-          (!useExactTest || temporalAdvisor->canBeConcurrent(inactiveToken, candidate))){
-        results.push_back(candidate);
+    // If it is still compatible, we may wish to do a double check on the
+    // Temporal Variables, since we could get more pruning from the TemporalNetwork based on
+    // temporal distance. This is because temporal propagation is insufficient to ensure that if 2 timepoints
+    // have an intersection that they can actually co-exist. For example, if a < b, then there may well
+    // be an intersection but t would be immediately inconsistent of they were required to be concurrent.
+    if(useExactTest && !getTemporalAdvisor()->canBeConcurrent(inactiveToken, candidate))
+      return false;
+
+    debugMsg("PlanDatabase:getCompatibleTokens",
+             "EXACT=" << useExactTest << ". Adding " << candidate->getKey() <<
+             " for token " << inactiveToken->getKey());
+    return true;
+  }
+
+  void PlanDatabase::getCompatibleTokens(const TokenId inactiveToken,
+                                         std::vector<TokenId>& results,
+                                         unsigned int limit,
+                                         bool useExactTest) {
+    if(!m_constraintEngine->propagate())
+      return;
+
+    // Draw from list of active tokens of the same predicate
+    const TokenSet& candidates = getActiveTokens(inactiveToken->getPredicateName());
+
+    condDebugMsg(candidates.empty(),
+		 "PlanDatabase:getCompatibleTokens", "No candidates to evaluate for " << inactiveToken->toString());
 
-        debugMsg("PlanDatabase:getCompatibleTokens",
-                 "EXACT=" << useExactTest << ". Adding " << candidate->getKey() <<
-                 " for token " << inactiveToken->getKey());
+    unsigned int choiceCount = 0; // Used for comparison against given limit
 
+    for(TokenSet::const_iterator it = candidates.begin(); it != candidates.end(); ++it){
+      TokenId candidate = *it;
+
+      if(isCompatible(inactiveToken, candidate, useExactTest)){
+        results.push_back(candidate);
         choiceCount++;
       }
 
@@ -1052,6 +1064,58 @@ PSList<PSToken*> PlanDatabase::getAllTokens() const {
   return retval;
 }
 
+namespace {
+  /**
+   * @brief Yields the tokens of a set whose possible interval, from the earliest start to the latest start or end,
+   * intersects a window.
+   */
+  class WindowedTokenIterator : public PSTokenIterator {
+  public:
+    WindowedTokenIterator(const TokenSet& tokens, bool byEnd, edouble lb, edouble ub)
+      : m_it(tokens.begin()), m_end(tokens.end()), m_byEnd(byEnd), m_lb(lb), m_ub(ub) {
+      skip();
+    }
+
+    bool done() const {return m_it == m_end;}
+
+    PSToken* next() {
+      checkError(!done(), "Cannot advance an item since the iterator is done.");
+      TokenId token = *m_it;
+      ++m_it;
+      skip();
+      return id_cast<PSToken>(token);
+    }
+
+  private:
+    bool matches(const TokenId token) const {
+      const TimeVarId last = (m_byEnd ? token->end() : token->start());
+      return token->start()->lastDomain().getLowerBound() <= m_ub &&
+        last->lastDomain().getUpperBound() >= m_lb;
+    }
+
+    void skip() {
+      while(m_it != m_end && !matches(*m_it))
+        ++m_it;
+    }
+
+    TokenSet::const_iterator m_it;
+    const TokenSet::const_iterator m_end;
+    const bool m_byEnd;
+    const edouble m_lb;
+    const edouble m_ub;
+  };
+}
+
+PSTokenIterator* PlanDatabase::getTokensOverlapping(PSObject* object, double lb, double ub) const {
+  Object* obj = dynamic_cast<Object*>(object);
+  check_runtime_error(obj != NULL);
+  return new WindowedTokenIterator(obj->tokens(), true, lb, ub);
+}
+
+PSTokenIterator* PlanDatabase::getActiveTokensStartingIn(const std::string& predicate, double lb, double ub) const {
+  return new WindowedTokenIterator(getActiveTokens(LabelStr(predicate)), false, lb, ub);
+}
+
 PSToken* PlanDatabase::getTokenByKey(PSEntityKey id) const {
   Id <Token> psId = Entity::getEntity(id);
   check_runtime_error(psId.isValid());
@@ -1126,6 +1190,34 @@ TokenId PlanDatabase::createToken(const char* tokenType,
       return token;
   }
 
+void PlanDatabase::createTokens(const char* tokenType,
+                                unsigned int count,
+                                bool rejectable,
+                                bool isFact,
+                                std::vector<TokenId>& results) {
+      LabelStr ttype(tokenType);
+
+      debugMsg("PlanDatabase:createTokens", count << " of " << ttype.toString());
+
+      // Look the type up once for the whole batch
+      TokenTypeId factory = getSchema()->getTokenType(ttype);
+      check_error(factory.isValid());
+
+      results.reserve(results.size() + count);
+      for(unsigned int i = 0; i < count; i++) {
+        TokenId token = factory->createInstance(getId(), ttype, rejectable, isFact);
+        check_error(token.isValid());
+
+        token->setName(LabelStr(autoLabel("globalToken")));
+
+        if (!token->isClosed())
+          token->close();
+
+        registerGlobalToken(token);
+        results.push_back(token);
+      }
+  }
+
   TokenId PlanDatabase::createSlaveToken(const TokenId master,
                 const LabelStr& tokenType,
                 const LabelStr& relation)
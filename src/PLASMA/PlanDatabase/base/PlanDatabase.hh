@@ -66,6 +66,13 @@ namespace EUROPA {
 
     void setTemporalAdvisor(const TemporalAdvisorId temporalAdvisor);
 
+    /**
+     * @brief Create an empty database over a forked constraint engine. The child shares this
+     * database's schema and engine registries and gets its own copy of the temporal advisor.
+     * @see ConstraintEngine::fork(), PlanDatabaseFork
+     */
+    PlanDatabaseId fork(const ConstraintEngineId constraintEngine) const;
+
     /**
      * @brief Retrieve a client interface which provides an interception point for all transactions.
      */
@@ -168,6 +175,15 @@ namespace EUROPA {
 // 			     eint limit,
 // 			     bool useExactTest);
 
+    /**
+     * @brief Test a single candidate for getCompatibleTokens. Database must be constraintConsistent.
+     * Allows callers to evaluate candidates one at a time, in their own order.
+     * @param inactiveToken The token to merge. It must be inActive().
+     * @param candidate An active token of the same predicate.
+     * @param useExactTest If true, also test that the timepoints can be concurrent.
+     */
+    bool isCompatible(const TokenId inactiveToken, const TokenId candidate, bool useExactTest);
+
     /**
      * @brief Returns a count of compatible tokens up to the given limit
      * @see getCompatibleTokens
@@ -319,6 +335,16 @@ namespace EUROPA {
     virtual PSList<PSToken*> getAllTokens() const;
     virtual PSToken* getTokenByKey(PSEntityKey id) const;
 
+    /**
+     * @brief Walks the object's token index, matching on current start and end bounds.
+     */
+    virtual PSTokenIterator* getTokensOverlapping(PSObject* object, double lb, double ub) const;
+
+    /**
+     * @brief Walks the index of active tokens by predicate, matching on current start bounds.
+     */
+    virtual PSTokenIterator* getActiveTokensStartingIn(const std::string& predicate, double lb, double ub) const;
+
     virtual PSList<PSVariable*> getAllGlobalVariables() const;
 
     ObjectId createObject(const LabelStr& objectType,
@@ -330,6 +356,16 @@ namespace EUROPA {
                         bool rejectable=false,
                         bool isFact=false);
 
+    /**
+     * @brief Create count global tokens of the same type, with generated names, appending them to results.
+     * @see DbClient::createTokens
+     */
+    void createTokens(const char* tokenType,
+                      unsigned int count,
+                      bool rejectable,
+                      bool isFact,
+                      std::vector<TokenId>& results);
+
     TokenId createSlaveToken(const TokenId master,
                              const LabelStr& tokenType,
                              const LabelStr& relation);
@@ -89,6 +89,12 @@ namespace EUROPA{
      */
     virtual unsigned int mostRecentRepropagation() const = 0;
 
+    /**
+     * @brief Create an equivalent advisor over another constraint engine.
+     * @see PlanDatabase::fork()
+     */
+    virtual TemporalAdvisorId copy(const ConstraintEngineId constraintEngine) const = 0;
+
     virtual ~TemporalAdvisor() {};
   };
 
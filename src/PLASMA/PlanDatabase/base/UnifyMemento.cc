@@ -3,28 +3,32 @@
 #include <string.h>
 
 namespace EUROPA {
-  
+
+namespace {
+  // Read once: merging is frequent enough for the environment lookup to show up
+  bool useStackMethod() {
+    static const char* TRUE_VALUE = "1";
+    static const char* envStr = getenv("EUROPA_USE_STACK_METHOD");
+
+    // If the environment variable has been set, and is 1, return true, else false
+    static const bool result = (envStr != NULL && strcmp(envStr, TRUE_VALUE) == 0);
+    return result;
+  }
+}
+
   UnifyMemento::~UnifyMemento() {
     if (!m_mm.isNoId())
       m_mm.release();
     if (!m_sm.isNoId())
       m_sm.release();
   }
-  
+
 UnifyMemento::UnifyMemento() : m_method(mergeMethod), m_mm(), m_sm() {}
 
 UnifyMemento::UnifyMemento(const TokenId inactiveToken,
                            const TokenId activeToken) : m_method(mergeMethod), m_mm(),
                                                         m_sm() {
-    static const char* TRUE_VALUE = "1";
-
-    const char *envStr = getenv("EUROPA_USE_STACK_METHOD");
-
-    m_method = mergeMethod;
-
-    // If the environment variable has been set, and is 1, return true, else false
-    if (envStr != NULL && strcmp(envStr, TRUE_VALUE) == 0)
-      m_method = stackMethod;
+    m_method = useStackMethod() ? stackMethod : mergeMethod;
 
     if (m_method == mergeMethod) {
       m_mm = MergeMementoId(new MergeMemento(inactiveToken, activeToken));
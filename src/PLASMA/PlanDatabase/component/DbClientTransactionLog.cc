@@ -14,6 +14,16 @@ namespace EUROPA {
     , m_chronologicalBacktracking(chronologicalBacktracking)
     , m_tokensCreated(0)
     , m_client(client)
+    , m_os(NULL)
+  {}
+
+  DbClientTransactionLog::DbClientTransactionLog(const DbClientId client, std::ostream& os)
+    : DbClientListener(client)
+    , m_bufferedTransactions()
+    , m_chronologicalBacktracking(false)
+    , m_tokensCreated(0)
+    , m_client(client)
+    , m_os(&os)
   {}
 
   DbClientTransactionLog::~DbClientTransactionLog(){
@@ -38,6 +48,7 @@ namespace EUROPA {
   }
 
   void DbClientTransactionLog::removeBreakpoint() {
+    checkError(!isStreaming(), "Can't remove a breakpoint that has already been written out.");
     check_error(!m_bufferedTransactions.empty());
     checkError(m_bufferedTransactions.back()->Value() == std::string("breakpoint"),
                "Last transaction is a " << m_bufferedTransactions.back()->Value() <<
@@ -271,6 +282,8 @@ void DbClientTransactionLog::notifyConstraintDeleted(const ConstraintId constrai
       os << **iter << std::endl;
     }
     cleanup(m_bufferedTransactions);
+    if(isStreaming())
+      m_os->flush();
   }
 
   std::string
@@ -410,6 +423,11 @@ DbClientTransactionLog::variableAsXml(const ConstrainedVariableId variable) cons
   }
 
   void DbClientTransactionLog::pushTransaction(TiXmlElement * tx){
+    if(isStreaming()) {
+      *m_os << *tx << '\n';
+      delete tx;
+      return;
+    }
     m_bufferedTransactions.push_back(tx);
   }
 
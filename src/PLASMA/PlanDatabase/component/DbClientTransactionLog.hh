@@ -21,6 +21,14 @@ namespace EUROPA {
   class DbClientTransactionLog: public DbClientListener {
   public:
     DbClientTransactionLog(const DbClientId client, bool chronologicalBacktracking = true);
+
+    /**
+     * @brief Construct a log that writes each transaction to os as it happens rather than
+     *        buffering it in memory.
+     * @note Streamed transactions cannot be popped, so retractions are always logged as
+     *       inverse transactions (i.e. chronological backtracking is not assumed).
+     */
+    DbClientTransactionLog(const DbClientId client, std::ostream& os);
     ~DbClientTransactionLog();
 
     /* Declare DbClient event handlers we will over-ride */
@@ -53,6 +61,11 @@ namespace EUROPA {
      */
     void flush(std::ostream& os);
 
+    /**
+     * @brief True if transactions are written straight to a stream instead of being buffered.
+     */
+    bool isStreaming() const {return m_os != NULL;}
+
   private:
     friend class DbClientTransactionPlayer;
     const std::list<TiXmlElement*>& getBufferedTransactions() const;
@@ -68,6 +81,7 @@ namespace EUROPA {
     bool m_chronologicalBacktracking;
     int m_tokensCreated;
     const DbClientId m_client;
+    std::ostream* m_os; /*!< If not NULL, the stream transactions are written to. */
     
   //! string output functions
 
@@ -109,20 +109,142 @@ CESchemaId DbClientTransactionPlayer::getCESchema() const {
 
   }
 
+  namespace {
+    /**
+     * @brief Kinds of top-level markup pulled off a transaction stream.
+     */
+    enum StreamItem {
+      ITEM_END,        /*!< End of stream. */
+      ITEM_MARKUP,     /*!< Declaration, comment or processing instruction. Ignored. */
+      ITEM_OPEN_DOC,   /*!< Opening tag of an enclosing <nddl> document. */
+      ITEM_CLOSE_DOC,  /*!< A closing tag at document level. */
+      ITEM_TRANSACTION /*!< A complete transaction element. */
+    };
+
+    /**
+     * @brief Read a single tag, up to and including its closing '>'. The leading '<' must
+     *        already be in tag.  Quoted attribute values, comment bodies and CDATA sections
+     *        may contain '>'.
+     */
+    bool readTag(std::istream& is, std::string& tag) {
+      char quote = 0;
+      char c;
+      while(is.get(c)) {
+        tag += c;
+        if(tag.compare(0, 4, "<!--") == 0) {
+          if(c == '>' && tag.size() >= 7 && tag.compare(tag.size() - 3, 3, "-->") == 0)
+            return true;
+        }
+        else if(tag.compare(0, 9, "<![CDATA[") == 0) {
+          if(c == '>' && tag.size() >= 12 && tag.compare(tag.size() - 3, 3, "]]>") == 0)
+            return true;
+        }
+        else if(quote != 0) {
+          if(c == quote)
+            quote = 0;
+        }
+        else if(c == '"' || c == '\'')
+          quote = c;
+        else if(c == '>')
+          return true;
+      }
+      return false;
+    }
+
+    bool isMarkup(const std::string& tag) {
+      return tag.size() > 1 && (tag[1] == '?' || tag[1] == '!');
+    }
+
+    bool isClosing(const std::string& tag) {
+      return tag.size() > 1 && tag[1] == '/';
+    }
+
+    bool isEmptyElement(const std::string& tag) {
+      return tag.size() > 2 && tag[tag.size() - 2] == '/';
+    }
+
+    /**
+     * @brief Pull the next top-level item off the stream.  Transactions are returned as raw text
+     *        in 'text'; enclosing <nddl> documents are entered rather than read whole, so no more than
+     *        one transaction is ever held in memory.
+     */
+    StreamItem nextStreamItem(std::istream& is, std::string& text) {
+      text.clear();
+      char c;
+      while(is.get(c) && c != '<') {} // discard characters up to '<'
+      if(!is)
+        return ITEM_END;
+
+      text += c;
+      checkError(readTag(is, text), "Unterminated tag in transaction stream: " << text);
+      if(isMarkup(text))
+        return ITEM_MARKUP;
+      if(isClosing(text))
+        return ITEM_CLOSE_DOC;
+      if(isEmptyElement(text))
+        return ITEM_TRANSACTION;
+
+      std::string::size_type nameEnd = text.find_first_of(" \t\r\n/>", 1);
+      if(text.compare(1, nameEnd - 1, "nddl") == 0)
+        return ITEM_OPEN_DOC;
+
+      // Accumulate the body of the transaction until its own closing tag.
+      unsigned int depth = 1;
+      std::string tag;
+      while(depth > 0) {
+        while(is.get(c) && c != '<')
+          text += c;
+        checkError(is, "Unterminated transaction in stream: " << text);
+        tag = c;
+        checkError(readTag(is, tag), "Unterminated tag in transaction stream: " << text << tag);
+        if(isClosing(tag))
+          depth--;
+        else if(!isMarkup(tag) && !isEmptyElement(tag))
+          depth++;
+        text += tag;
+      }
+      return ITEM_TRANSACTION;
+    }
+  }
+
   void DbClientTransactionPlayer::play(std::istream& is) {
     int txCounter = 0;
     check_error(is, "Invalid input stream for playing transactions.");
 
-    while (!is.eof()) {
-      if (is.peek() != '<') {
-        is.get(); // discard characters up to '<'
-        continue;
+    // Transactions are pulled off the stream one at a time. An enclosing <nddl> document is
+    // played child by child, stopping at the first inconsistency just as processTransaction does.
+    unsigned int docDepth = 0;
+    bool skipping = false;
+    std::string text;
+    for(StreamItem item = nextStreamItem(is, text); item != ITEM_END;
+        item = nextStreamItem(is, text)) {
+      switch(item) {
+      case ITEM_OPEN_DOC:
+        docDepth++;
+        txCounter++;
+        break;
+      case ITEM_CLOSE_DOC:
+        checkError(docDepth > 0, "Unmatched closing tag " << text);
+        if(--docDepth == 0) {
+          skipping = false;
+          m_client->propagate();
+        }
+        break;
+      case ITEM_TRANSACTION:
+        if(!skipping) {
+          TiXmlElement tx("");
+          std::istringstream iss(text);
+          iss >> tx;
+          processTransaction(tx);
+          if(docDepth > 0 && !m_client->constraintConsistent())
+            skipping = true;
+        }
+        if(docDepth == 0)
+          txCounter++;
+        break;
+      default:
+        break;
       }
-
-      TiXmlElement tx("");
-      is >> tx;
-      processTransaction(tx);
-      txCounter++;
     }
     check_error(txCounter > 0, "Failed to find any transactions in stream.");
   }
@@ -1177,6 +1177,8 @@ public:
     EUROPA_runTest(testMasterSlaveRelationship);
     EUROPA_runTest(testTermination);
     EUROPA_runTest(testBasicMerging);
+    EUROPA_runTest(testRepeatedMergeAndSplit);
+    EUROPA_runTest(testIndexedQueries);
     EUROPA_runTest(testMergingWithEmptyDomains);
     EUROPA_runTest(testConstraintMigrationDuringMerge);
     EUROPA_runTest(testConstraintAdditionAfterMerging);
@@ -1640,6 +1642,102 @@ private:
     return true;
   }
 
+  static void collectTokens(PSTokenIterator* it, std::set<PSToken*>& results){
+    while(!it->done())
+      results.insert(it->next());
+    delete it;
+  }
+
+  static bool testIndexedQueries(){
+    DEFAULT_SETUP(ce, db, false);
+    ObjectId o1 = (new Timeline(db, LabelStr(DEFAULT_OBJECT_TYPE), "o1"))->getId();
+    ObjectId o2 = (new Timeline(db, LabelStr(DEFAULT_OBJECT_TYPE), "o2"))->getId();
+    db->close();
+
+    IntervalToken t0(db, LabelStr(DEFAULT_PREDICATE), true, false,
+                     IntervalIntDomain(0, 5), IntervalIntDomain(10, 15), IntervalIntDomain(1, 1000));
+    IntervalToken t1(db, LabelStr(DEFAULT_PREDICATE), true, false,
+                     IntervalIntDomain(20, 25), IntervalIntDomain(30, 35), IntervalIntDomain(1, 1000));
+    IntervalToken t2(db, LabelStr(DEFAULT_PREDICATE), true, false,
+                     IntervalIntDomain(40, 50), IntervalIntDomain(50, 60), IntervalIntDomain(1, 1000));
+    t0.getObject()->specify(o1->getKey());
+    t1.getObject()->specify(o1->getKey());
+    t2.getObject()->specify(o2->getKey());
+    t0.activate();
+    t1.activate();
+    CPPUNIT_ASSERT(ce->propagate());
+
+    // t2 is inactive, so it is not indexed
+    std::set<PSToken*> found;
+    collectTokens(db->getTokensOverlapping(id_cast<PSObject>(o1), 12, 22), found);
+    CPPUNIT_ASSERT(found.size() == 2);
+    found.clear();
+    collectTokens(db->getTokensOverlapping(id_cast<PSObject>(o1), 16, 19), found);
+    CPPUNIT_ASSERT(found.empty());
+    collectTokens(db->getTokensOverlapping(id_cast<PSObject>(o2), 0, 100), found);
+    CPPUNIT_ASSERT(found.empty());
+
+    t2.activate();
+    CPPUNIT_ASSERT(ce->propagate());
+    collectTokens(db->getTokensOverlapping(id_cast<PSObject>(o2), 0, 100), found);
+    CPPUNIT_ASSERT(found.size() == 1 && found.count(id_cast<PSToken>(t2.getId())) == 1);
+    found.clear();
+
+    collectTokens(db->getActiveTokensStartingIn(DEFAULT_PREDICATE, 4, 45), found);
+    CPPUNIT_ASSERT(found.size() == 3);
+    found.clear();
+    collectTokens(db->getActiveTokensStartingIn(DEFAULT_PREDICATE, 6, 19), found);
+    CPPUNIT_ASSERT(found.empty());
+    collectTokens(db->getActiveTokensStartingIn(DEFAULT_PREDICATE, 21, 21), found);
+    CPPUNIT_ASSERT(found.size() == 1 && found.count(id_cast<PSToken>(t1.getId())) == 1);
+
+    DEFAULT_TEARDOWN();
+    return true;
+  }
+
+  static bool testRepeatedMergeAndSplit(){
+    DEFAULT_SETUP(ce, db, false);
+    unused(ObjectId timeline) = (new Timeline(db, LabelStr(DEFAULT_OBJECT_TYPE), "o2"))->getId();
+    db->close();
+
+    IntervalToken t0(db, LabelStr(DEFAULT_PREDICATE), true, false,
+                     IntervalIntDomain(0, 10), IntervalIntDomain(0, 20), IntervalIntDomain(1, 1000));
+    IntervalToken t1(db, LabelStr(DEFAULT_PREDICATE), true, false,
+                     IntervalIntDomain(0, 10), IntervalIntDomain(0, 20), IntervalIntDomain(1, 1000));
+    IntervalToken t2(db, LabelStr(DEFAULT_PREDICATE), true, false,
+                     IntervalIntDomain(0, 10), IntervalIntDomain(0, 20), IntervalIntDomain(1, 1000));
+
+    // t1 only differs from t0 by a specified start, t2 by a narrower base domain for the end
+    t1.start()->specify(4);
+    t2.end()->restrictBaseDomain(IntervalIntDomain(12, 15));
+
+    // A constraint between t1 and a token which is not involved in the merge, to be migrated
+    IntervalToken t3(db, LabelStr(DEFAULT_PREDICATE), true, false,
+                     IntervalIntDomain(0, 10), IntervalIntDomain(0, 20), IntervalIntDomain(1, 1000));
+    ConstraintId constraint = ce->createConstraint("precedes", makeScope(t3.end(), t1.end()));
+    t3.end()->restrictBaseDomain(IntervalIntDomain(12, 14));
+
+    t0.activate();
+    CPPUNIT_ASSERT(ce->propagate());
+
+    for(int i = 0; i < 3; i++){
+      t1.doMerge(t0.getId());
+      t2.doMerge(t0.getId());
+      CPPUNIT_ASSERT(ce->propagate());
+      CPPUNIT_ASSERT(t0.start()->getDerivedDomain().getSingletonValue() == 4);
+      CPPUNIT_ASSERT_MESSAGE(t0.end()->toString(), t0.end()->getDerivedDomain() == IntervalIntDomain(12, 15));
+      t2.cancel();
+      t1.cancel();
+      CPPUNIT_ASSERT(ce->propagate());
+      CPPUNIT_ASSERT(t0.start()->getDerivedDomain() == IntervalIntDomain(0, 10));
+      CPPUNIT_ASSERT_MESSAGE(t0.end()->toString(), t0.end()->getDerivedDomain() == IntervalIntDomain(1, 20));
+      CPPUNIT_ASSERT(constraint->isActive());
+    }
+
+    DEFAULT_TEARDOWN();
+    return true;
+  }
+
   // This test has been fixed by line 56 in MergeMemento.cc.
   // If we invert the order of the splits at the end of this test, the code
   // will error out.
@@ -3871,6 +3969,8 @@ public:
     EUROPA_runTest(testBasicAllocation);
     EUROPA_runTest(testPathBasedRetrieval);
     EUROPA_runTest(testGlobalVariables);
+    EUROPA_runTest(testStreamedTransactionLog);
+    EUROPA_runTest(testBulkTokenCreation);
     return true;
   }
 private:
@@ -4026,6 +4126,68 @@ private:
     DEFAULT_TEARDOWN();
     return true;
   }
+
+  static bool testStreamedTransactionLog(){
+    DEFAULT_SETUP(ce, db, true);
+
+    DbClientId client = db->getClient();
+    client->enableTransactionLogging();
+    std::ostringstream os;
+    DbClientTransactionLog* txLog = new DbClientTransactionLog(client, os);
+    CPPUNIT_ASSERT(txLog->isStreaming());
+
+    ConstrainedVariableId v1 = client->createVariable(IntDT::NAME().c_str(), "v1");
+    CPPUNIT_ASSERT(os.str().find("<var") != std::string::npos);
+    std::string::size_type written = os.str().size();
+
+    // Retractions can't pop what has been written, so they are logged as inverses
+    client->specify(v1, 3);
+    client->reset(v1);
+    CPPUNIT_ASSERT(os.str().find("<specify", written) != std::string::npos);
+    CPPUNIT_ASSERT(os.str().find("<reset", written) != std::string::npos);
+
+    delete txLog;
+    DEFAULT_TEARDOWN();
+    return true;
+  }
+
+  static bool testBulkTokenCreation(){
+    DEFAULT_SETUP(ce, db, false);
+    new Object(db, LabelStr(DEFAULT_OBJECT_TYPE), "o1");
+    db->close();
+
+    DbClientId client = db->getClient();
+    client->enableTransactionLogging();
+    std::ostringstream os;
+    DbClientTransactionLog* txLog = new DbClientTransactionLog(client, os);
+
+    std::vector<TokenId> tokens;
+    tokens.push_back(client->createToken(DEFAULT_PREDICATE));
+    client->createTokens(DEFAULT_PREDICATE, 50, tokens, false, true);
+    CPPUNIT_ASSERT(tokens.size() == 51);
+    CPPUNIT_ASSERT(db->getTokens().size() == 51);
+    CPPUNIT_ASSERT(ce->getAutoPropagation());
+    CPPUNIT_ASSERT(ce->constraintConsistent());
+
+    // Each token is logged and can be found by path, in order of creation
+    for(unsigned int i = 0; i < tokens.size(); i++){
+      CPPUNIT_ASSERT(tokens[i]->isFact() == (i > 0));
+      CPPUNIT_ASSERT(client->getTokenByPath(client->getPathByToken(tokens[i])) == tokens[i]);
+      CPPUNIT_ASSERT(db->getGlobalToken(tokens[i]->getName()) == tokens[i]);
+    }
+    std::string::size_type count = 0;
+    for(std::string::size_type pos = os.str().find("<fact"); pos != std::string::npos; pos = os.str().find("<fact", pos + 1))
+      count++;
+    CPPUNIT_ASSERT(count == 50);
+
+    PSList<PSToken*> psTokens = db->getPDBClient()->createTokens(DEFAULT_PREDICATE, 3, true, false);
+    CPPUNIT_ASSERT(psTokens.size() == 3);
+    CPPUNIT_ASSERT(db->getTokens().size() == 54);
+
+    delete txLog;
+    DEFAULT_TEARDOWN();
+    return true;
+  }
 };
 
 /**
@@ -4158,6 +4320,7 @@ public:
     testReject();
     testCancel();
     testUncancel();
+    testStreamedDocument();
 
     delete s_dbPlayer;
     DEFAULT_TEARDOWN();
@@ -4321,6 +4484,19 @@ public:
     // Nothing to verify, since the player cannot actually create enumerations.
   }
 
+  /** Test playing transactions enclosed in an nddl document, which is streamed rather than read whole.
+   *  Markup between them, CDATA sections included, is skipped. */
+  static void testStreamedDocument() {
+    std::string xml("<?xml version=\"1.0\"?>\n<!-- a <comment> -->\n<nddl>\n");
+    xml += buildXMLNameTypeStr("var", "g_streamed_int", IntDT::NAME(), __FILE__, __LINE__);
+    xml += "\n<![CDATA[ don't <stop> here ]]>\n";
+    xml += buildXMLNameTypeStr("var", "g_streamed_float", FloatDT::NAME(), __FILE__, __LINE__);
+    xml += "\n</nddl>\n";
+    TEST_PLAYING_XML(xml);
+    CPPUNIT_ASSERT(s_db->getClient()->isGlobalVariable("g_streamed_int"));
+    CPPUNIT_ASSERT(s_db->getClient()->isGlobalVariable("g_streamed_float"));
+  }
+
   /** Test creating variables. */
   static void testCreateVariable() {
     TEST_PLAYING_XML(buildXMLNameTypeStr("var", "g_int", IntDT::NAME(), __FILE__, __LINE__));
@@ -18,7 +18,10 @@
 #include "ResourceThreatManager.hh"
 #include "Reusable.hh"
 #include "BoostFlowProfile.hh"
+#include "PushRelabelFlowProfile.hh"
+#include "SegmentTreeProfile.hh"
 #include "CESchema.hh"
+#include "Utils.hh"
 
 #include <boost/cast.hpp>
 
@@ -45,7 +48,12 @@ namespace EUROPA {
 void ModuleResource::initialize(EngineId engine) {
   ConstraintEngine* ce = boost::polymorphic_cast<ConstraintEngine*>(engine->getComponent("ConstraintEngine"));
   Schema* schema = boost::polymorphic_cast<Schema*>(engine->getComponent("Schema"));
-  new ProfilePropagator(LabelStr("Resource"), ce->getId());
+  ProfilePropagator* profilePropagator = new ProfilePropagator(LabelStr("Resource"), ce->getId());
+  if (engine->getConfig()->getProperty("Resource.lazyProfiles") == "Y")
+    profilePropagator->setLazy(true);
+  unsigned int profileThreads = 1;
+  if (toValue(engine->getConfig()->getProperty("Resource.profileThreads"), profileThreads) && profileThreads > 1)
+    profilePropagator->setThreadCount(profileThreads);
 
   ObjectTypeId objectOT = schema->getObjectType(Schema::rootObject());
   ObjectType* ot;
@@ -108,9 +116,13 @@ void ModuleResource::initialize(EngineId engine) {
   REGISTER_PROFILE(pfm,TimetableProfile, TimetableProfile );
   REGISTER_PROFILE(pfm, BoostFlowProfile, FlowProfile);
   REGISTER_PROFILE(pfm, BoostFlowProfile, IncrementalFlowProfile);
+  REGISTER_PROFILE(pfm, PushRelabelFlowProfile, PushRelabelFlowProfile);
+  REGISTER_PROFILE(pfm, PushRelabelIncrementalFlowProfile, PushRelabelIncrementalFlowProfile);
   // REGISTER_PROFILE(pfm,FlowProfile, FlowProfile);
   // REGISTER_PROFILE(pfm,IncrementalFlowProfile, IncrementalFlowProfile );
   REGISTER_PROFILE(pfm,GroundedProfile, GroundedProfile );
+  REGISTER_PROFILE(pfm, SegmentTreeTimetableProfile, SegmentTreeTimetableProfile);
+  REGISTER_PROFILE(pfm, SegmentTreeGroundedProfile, SegmentTreeGroundedProfile);
 
   // Solver
   FactoryMgr* fvdfm = new FactoryMgr();
@@ -122,7 +134,7 @@ void ModuleResource::initialize(EngineId engine) {
   SOLVERS::ComponentFactoryMgr* cfm =
       boost::polymorphic_cast<SOLVERS::ComponentFactoryMgr*>(engine->getComponent("ComponentFactoryMgr"));
   REGISTER_FLAW_MANAGER(cfm,ResourceThreatManager, ResourceThreatManager);
-  REGISTER_FLAW_HANDLER(cfm,ResourceThreatDecisionPoint, ResourceThreatHandler);
+  REGISTER_COMPONENT_FACTORY(cfm, ResourceThreatHandler, ResourceThreatHandler);
   //      REGISTER_FLAW_HANDLER(cfm,SOLVERS::ResourceThreatDecisionPoint, ResourceThreat);
 
   SOLVERS::MatchFinderMgr* mfm =
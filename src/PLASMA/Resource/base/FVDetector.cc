@@ -1,4 +1,5 @@
 #include "FVDetector.hh"
+#include "Profile.hh"
 #include "PlanDatabase.hh"
 
 namespace EUROPA {
@@ -6,4 +7,59 @@ namespace EUROPA {
     {
     	return m_res->getPlanDatabase()->getConstraintEngine()->getAllowViolations();
     }
+
+    void FVDetector::notify(const NotificationType type, const InstantId inst,
+                            const Resource::ProblemType problem)
+    {
+      if(!m_res.isValid())
+        return;
+      // only a violation that stops propagation is explained, and only now does the profile
+      // still hold the state it was found in
+      if(type == VIOLATED && !allowViolations() && m_res->getProfile().isValid())
+        m_res->getProfile()->explainViolation(inst, problem);
+      Notification notification(type, inst, problem);
+      if(m_deferred)
+        m_notifications.push_back(notification);
+      else
+        deliver(notification);
+    }
+
+    void FVDetector::flushNotifications()
+    {
+      checkError(!m_deferred, "Flushing notifications while they are still being deferred.");
+      for(std::vector<Notification>::const_iterator it = m_notifications.begin();
+          it != m_notifications.end(); ++it)
+        deliver(*it);
+      m_notifications.clear();
+    }
+
+    void FVDetector::discardNotifications()
+    {
+      checkError(!m_deferred, "Discarding notifications while they are still being deferred.");
+      m_notifications.clear();
+    }
+
+    void FVDetector::deliver(const Notification& notification)
+    {
+      switch(notification.type) {
+      case RESET:
+        if(notification.inst.isNoId())
+          m_res->resetViolations();
+        else
+          m_res->resetViolations(notification.inst);
+        break;
+      case VIOLATED:
+        m_res->notifyViolated(notification.inst, notification.problem);
+        break;
+      case NO_LONGER_VIOLATED:
+        m_res->notifyNoLongerViolated(notification.inst);
+        break;
+      case FLAWED:
+        m_res->notifyFlawed(notification.inst);
+        break;
+      case NO_LONGER_FLAWED:
+        m_res->notifyNoLongerFlawed(notification.inst);
+        break;
+      }
+    }
 }
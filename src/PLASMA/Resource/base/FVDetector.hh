@@ -32,7 +32,7 @@ namespace EUROPA {
        * @brief Constructor
        * @param res The Resource to be notified when a flaw or violation is detected.
        */
-      FVDetector(const ResourceId res) : m_id(this), m_res(res) {}
+      FVDetector(const ResourceId res) : m_id(this), m_res(res), m_deferred(false), m_notifications() {}
 
       virtual ~FVDetector() {m_id.remove();}
 
@@ -40,12 +40,12 @@ namespace EUROPA {
        * @brief Initialize a detection run with the given instant data
        * @param inst The source of the level data.
        */
-      virtual void initialize(const InstantId inst) {if(m_res.isValid()) m_res->resetViolations(inst);}
+      virtual void initialize(const InstantId inst) {notify(RESET, inst);}
 
       /**
        * @brief Initialize a detection run with no data.  Used when the first Instant in the recalculation interval is the first Instant.
        */
-      virtual void initialize() {if(m_res.isValid()) m_res->resetViolations();}
+      virtual void initialize() {notify(RESET, InstantId::noId());}
 
       /**
        * @brief Detect flaws and violations at an instant.
@@ -61,33 +61,68 @@ namespace EUROPA {
       virtual PSResourceProfile* getFDLevelProfile() = 0;
       virtual PSResourceProfile* getVDLevelProfile() = 0;
 
+      /**
+       * @brief Hold flaw and violation notifications back from the Resource until they are flushed,
+       * so that detection changes nothing outside the profile.
+       */
+      void deferNotifications(const bool defer) {m_deferred = defer;}
+
+      /**
+       * @brief Pass the notifications held back on to the Resource, in the order they were made.
+       */
+      void flushNotifications();
+
+      /**
+       * @brief Drop the notifications held back, as if they had never been made.
+       */
+      void discardNotifications();
+
     protected:
       friend class Profile;
 
       /**
        * @brief Inform the FVDetector (and, ultimately, the Resource) that an Instant has been removed.
+       * Never deferred, since the Instant goes away.
        */
       void notifyDeleted(const InstantId inst) {if(m_res.isValid()) m_res->notifyDeleted(inst);}
 
       /**
        * @brief Inform the Resource that there is a violation at an Instant.
        */
-      void notifyOfViolation(const InstantId inst, Resource::ProblemType problem) {if(m_res.isValid()) m_res->notifyViolated(inst,problem);}
+      void notifyOfViolation(const InstantId inst, Resource::ProblemType problem) {notify(VIOLATED, inst, problem);}
 
-      void notifyNoLongerViolated(const InstantId inst) {if(m_res.isValid()) m_res->notifyNoLongerViolated(inst);}
+      void notifyNoLongerViolated(const InstantId inst) {notify(NO_LONGER_VIOLATED, inst);}
 
       /**
        * @brief Inform the Resource that there is a flaw at an Instant.
        */
-      void notifyOfFlaw(const InstantId inst) {if(m_res.isValid()) m_res->notifyFlawed(inst);}
+      void notifyOfFlaw(const InstantId inst) {notify(FLAWED, inst);}
 
-      void notifyNoLongerFlawed(const InstantId inst) {if(m_res.isValid()) m_res->notifyNoLongerFlawed(inst);}
+      void notifyNoLongerFlawed(const InstantId inst) {notify(NO_LONGER_FLAWED, inst);}
 
       bool allowViolations() const;
 
     protected:
       FVDetectorId m_id;
       ResourceId m_res;
+
+    private:
+      enum NotificationType {RESET, VIOLATED, NO_LONGER_VIOLATED, FLAWED, NO_LONGER_FLAWED};
+
+      struct Notification {
+        Notification(const NotificationType t, const InstantId i, const Resource::ProblemType p)
+            : type(t), inst(i), problem(p) {}
+        NotificationType type;
+        InstantId inst;
+        Resource::ProblemType problem;
+      };
+
+      void notify(const NotificationType type, const InstantId inst,
+                  const Resource::ProblemType problem = Resource::NoProblem);
+      void deliver(const Notification& notification);
+
+      bool m_deferred;
+      std::vector<Notification> m_notifications;
     };
 
     class FVDetectorArgs : public FactoryArgs
@@ -0,0 +1,98 @@
+#ifndef _H_InstantMap
+#define _H_InstantMap
+
+/**
+ * @file InstantMap.hh
+ * @brief Defines the sorted-vector container a Profile keeps its Instants in.
+ * @ingroup Resource
+ */
+
+#include "ResourceDefs.hh"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace EUROPA {
+
+/**
+ * @class InstantMap
+ * @brief An ordered map from times to Instants stored as a sorted vector.
+ *
+ * Profiles iterate over their instants far more often than they add or remove them, so the
+ * instants are kept contiguously and looked up by binary search.  The interface is the subset
+ * of std::map the profiles use; unlike std::map, insertion and erasure invalidate iterators.
+ */
+class InstantMap {
+ public:
+  typedef eint key_type;
+  typedef InstantId mapped_type;
+  typedef std::pair<eint, InstantId> value_type;
+  typedef std::vector<value_type>::iterator iterator;
+  typedef std::vector<value_type>::const_iterator const_iterator;
+  typedef std::vector<value_type>::size_type size_type;
+
+  InstantMap() : m_entries() {}
+
+  iterator begin() {return m_entries.begin();}
+  iterator end() {return m_entries.end();}
+  const_iterator begin() const {return m_entries.begin();}
+  const_iterator end() const {return m_entries.end();}
+  bool empty() const {return m_entries.empty();}
+  size_type size() const {return m_entries.size();}
+  void clear() {m_entries.clear();}
+
+  iterator lower_bound(const eint time) {
+    return std::lower_bound(m_entries.begin(), m_entries.end(), time, KeyLess());
+  }
+  const_iterator lower_bound(const eint time) const {
+    return std::lower_bound(m_entries.begin(), m_entries.end(), time, KeyLess());
+  }
+  iterator upper_bound(const eint time) {
+    return std::upper_bound(m_entries.begin(), m_entries.end(), time, KeyLess());
+  }
+  const_iterator upper_bound(const eint time) const {
+    return std::upper_bound(m_entries.begin(), m_entries.end(), time, KeyLess());
+  }
+  iterator find(const eint time) {
+    iterator it = lower_bound(time);
+    return (it == end() || time < it->first) ? end() : it;
+  }
+  const_iterator find(const eint time) const {
+    const_iterator it = lower_bound(time);
+    return (it == end() || time < it->first) ? end() : it;
+  }
+
+  /**
+   * @brief Inserts an entry unless one already exists for its time.
+   * @return The entry for the time and whether it was inserted.
+   */
+  std::pair<iterator, bool> insert(const value_type& entry) {
+    iterator it = lower_bound(entry.first);
+    if(it != end() && !(entry.first < it->first))
+      return std::make_pair(it, false);
+    return std::make_pair(m_entries.insert(it, entry), true);
+  }
+
+  void erase(iterator it) {m_entries.erase(it);}
+  size_type erase(const eint time) {
+    iterator it = find(time);
+    if(it == end())
+      return 0;
+    m_entries.erase(it);
+    return 1;
+  }
+
+ private:
+  struct KeyLess {
+    bool operator()(const value_type& entry, const eint time) const {return entry.first < time;}
+    bool operator()(const eint time, const value_type& entry) const {return time < entry.first;}
+    bool operator()(const value_type& a, const value_type& b) const {return a.first < b.first;}
+  };
+
+  std::vector<value_type> m_entries;
+};
+
+}
+
+#endif
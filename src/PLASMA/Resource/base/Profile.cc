@@ -29,6 +29,12 @@ Profile::Profile(const PlanDatabaseId db, const FVDetectorId flawDetector)
     , m_removalListener()
     , m_instants()
     , m_recomputeInterval()
+    , m_violationExplanation()
+    , m_deferred(false)
+    , m_deferredStart(MINUS_INFINITY)
+    , m_deferredEnd(PLUS_INFINITY)
+    , m_deferredFlags()
+    , m_deferredExplanation()
     {
     	m_removalListener = (new ConstraintRemovalListener(db->getConstraintEngine(), m_id))->getId();
     }
@@ -38,7 +44,9 @@ Profile::~Profile() {
   delete static_cast<ConstraintEngineListener*>(m_removalListener);
   debugMsg("Profile:~Profile", "Cleaning up instants...");
       
-  cleanup(m_instants);
+  for(InstantMap::const_iterator it = m_instants.begin(); it != m_instants.end(); ++it)
+    delete static_cast<Instant*>(it->second);
+  m_instants.clear();
   debugMsg("Profile:~Profile", "Cleaning up variable listeners...");
   for(std::multimap<TransactionId, ConstraintId>::iterator it = m_variableListeners.begin();
       it != m_variableListeners.end(); ++it)
@@ -54,7 +62,7 @@ Profile::~Profile() {
 }
 
 InstantId Profile::getInstant(const eint time) const {
-  std::map<eint, InstantId>::const_iterator it = m_instants.find(time);
+  InstantMap::const_iterator it = m_instants.find(time);
   return (it == m_instants.end() ? InstantId::noId() : it->second);
 }
 
@@ -93,12 +101,8 @@ InstantId Profile::getInstant(const eint time) const {
     }
 
 void Profile::handleTransactionAdded(const TransactionId) {
-  //by default, create an iterator over all time
-  if(m_recomputeInterval.isValid())	{
-    debugMsg("Profile:addTransaction", "Deleting profile iterator " << m_recomputeInterval->getId() );
-    delete static_cast<ProfileIterator*>(m_recomputeInterval);
-  }
-  m_recomputeInterval = (new ProfileIterator(getId()))->getId();
+  //by default, iterate over all time
+  resetRecomputeInterval();
 }
 
     bool Profile::containsChange(const InstantId instant) {
@@ -109,6 +113,8 @@ void Profile::removeTransaction(const TransactionId t) {
   if(m_transactions.find(t) == m_transactions.end())
     return;
   //       checkError(m_transactions.find(t) != m_transactions.end(), "Attempted to remove a transaction that isn't present!");
+  m_violationExplanation.erase(std::remove(m_violationExplanation.begin(), m_violationExplanation.end(), t),
+                               m_violationExplanation.end());
 
   debugMsg("Profile:removeTransaction",
            "Removing transaction " << t << " for time " << t->time()->toString() <<
@@ -170,7 +176,7 @@ void Profile::removeTransaction(const TransactionId t) {
   handleTransactionVariableDeletion(t);
 
   for(std::vector<eint>::const_iterator it = emptyInstants.begin(); it != emptyInstants.end(); ++it) {
-    std::map<eint, InstantId>::iterator instIt = m_instants.find(*it);
+    InstantMap::iterator instIt = m_instants.find(*it);
     //this can't be an error because the discard above constitues a relaxation of the variable, which will get handled in-situ
     //and may remove instants in the emptyInstants vector.
     //checkError(instIt != m_instants.end(), "Computed empty instant at " << *it << " but there is no such instant in the profile.");
@@ -190,12 +196,8 @@ void Profile::removeTransaction(const TransactionId t) {
 }
 
 void Profile::handleTransactionRemoved(const TransactionId) {
-  //by default, create an iterator over all time
-  if(m_recomputeInterval.isValid()) {
-    debugMsg("Profile:handleTransactionRemoved", "Deleting profile iterator " << m_recomputeInterval->getId() );
-    delete static_cast<ProfileIterator*>(m_recomputeInterval);
-  }
-  m_recomputeInterval = (new ProfileIterator(getId()))->getId();
+  //by default, iterate over all time
+  resetRecomputeInterval();
 }
 
 void Profile::transactionTimeChanged(const TransactionId e,
@@ -213,10 +215,24 @@ void Profile::transactionTimeChanged(const TransactionId e,
     case DomainListener::SET_TO_SINGLETON: {
       debugMsg("Profile:handleTimeChanged", "Handling restriction of transaction " << e << " at time " << e->time()->toString() << " with quantity " << e->quantity()->toString());
       eint first, last;
-      std::map<eint, InstantId>::iterator it;
-      for(it = m_instants.begin(); it != m_instants.end(); ++it)
-        if(it->second->getTransactions().find(e) != it->second->getTransactions().end())
-          break;
+      //the old bounds contain the new ones, so the instant at or before the new lower bound
+      //still holds e unless the profile is out of step, in which case fall back to a scan
+      InstantMap::iterator it = getGreatestInstant(startTime);
+      if(it != m_instants.end() &&
+         it->second->getTransactions().find(e) != it->second->getTransactions().end()) {
+        while(it != m_instants.begin()) {
+          InstantMap::iterator prev = it;
+          --prev;
+          if(prev->second->getTransactions().find(e) == prev->second->getTransactions().end())
+            break;
+          it = prev;
+        }
+      }
+      else {
+        for(it = m_instants.begin(); it != m_instants.end(); ++it)
+          if(it->second->getTransactions().find(e) != it->second->getTransactions().end())
+            break;
+      }
       checkError(it != m_instants.end(), "No instant containing this transaction.");
       first = it->second->getTime();
       it = m_instants.upper_bound(first);
@@ -247,7 +263,7 @@ void Profile::transactionTimeChanged(const TransactionId e,
 
       for(std::vector<eint>::iterator emptyIt = emptyInstants.begin();
           emptyIt != emptyInstants.end(); ++emptyIt) {
-        std::map<eint, InstantId>::iterator instIt = m_instants.find(*emptyIt);
+        InstantMap::iterator instIt = m_instants.find(*emptyIt);
         checkError(instIt != m_instants.end(),
                    "Computed empty instant at time " << *emptyIt << " but no such instant exists.");
         InstantId inst = instIt->second;
@@ -267,8 +283,9 @@ void Profile::transactionTimeChanged(const TransactionId e,
       debugMsg("Profile:handleTimeChanged",
                "Handling relaxation of transaction " << e << " at time " <<
                e->time()->toString() << " with quantity " << e->quantity()->toString());
-      ProfileIterator it(m_id, startTime, endTime);
+      //add the instants first: inserting into m_instants invalidates iterators
       addInstantsForBounds(e);
+      ProfileIterator it(m_id, startTime, endTime);
       std::vector<eint> emptyInstants;
       while(!it.done()) {
         InstantId inst = it.getInstant();
@@ -282,7 +299,7 @@ void Profile::transactionTimeChanged(const TransactionId e,
       }
       for(std::vector<eint>::iterator emptyIt = emptyInstants.begin();
           emptyIt != emptyInstants.end(); ++emptyIt) {
-        std::map<eint, InstantId>::iterator instIt = m_instants.find(*emptyIt);
+        InstantMap::iterator instIt = m_instants.find(*emptyIt);
         checkError(instIt != m_instants.end(),
                    "Computed empty instant at time " << *emptyIt << " but no such instant exists.");
         InstantId inst = instIt->second;
@@ -310,12 +327,8 @@ void Profile::transactionTimeChanged(const TransactionId e,
 
     void Profile::handleTransactionTimeChanged(const TransactionId,
                                                const DomainListener::ChangeType&) {
-      //by default, create an iterator over all time
-      if(m_recomputeInterval.isValid())	{
-        debugMsg("Profile:handleTimeChanged", "Deleting profile iterator " << m_recomputeInterval->getId() );
-        delete static_cast<ProfileIterator*>(m_recomputeInterval);
-      }
-      m_recomputeInterval = (new ProfileIterator(getId()))->getId();
+      //by default, iterate over all time
+      resetRecomputeInterval();
     }
 
     void Profile::transactionQuantityChanged(const TransactionId e, const DomainListener::ChangeType& change) {
@@ -326,12 +339,8 @@ void Profile::transactionTimeChanged(const TransactionId e,
 
     void Profile::handleTransactionQuantityChanged(const TransactionId,
                                                    const DomainListener::ChangeType&) {
-      //by default, create an iterator over all time
-      if(m_recomputeInterval.isValid()) {
-        debugMsg("Profile:transactionQuantityChanged", "Deleting profile iterator " << m_recomputeInterval->getId() );
-        delete static_cast<ProfileIterator*>(m_recomputeInterval);
-      }
-      m_recomputeInterval = (new ProfileIterator(getId()))->getId();
+      //by default, iterate over all time
+      resetRecomputeInterval();
     }
 
     bool Profile::checkMessageConsistency() {
@@ -441,9 +450,7 @@ void Profile::temporalConstraintAdded(const ConstraintId c,
 
 void Profile::handleTemporalConstraintAdded(const TransactionId, const unsigned int,
                                             const TransactionId, const unsigned int) {
-  if(m_recomputeInterval.isValid())
-    delete static_cast<ProfileIterator*>(m_recomputeInterval);
-  m_recomputeInterval = (new ProfileIterator(getId()))->getId();
+  resetRecomputeInterval();
 }
 
 void Profile::temporalConstraintRemoved(const ConstraintId c,
@@ -454,9 +461,7 @@ void Profile::temporalConstraintRemoved(const ConstraintId c,
 
 void Profile::handleTemporalConstraintRemoved(const TransactionId, const unsigned int,
                                               const TransactionId, const unsigned int) {
-  if(m_recomputeInterval.isValid())
-    delete static_cast<ProfileIterator*>(m_recomputeInterval);
-  m_recomputeInterval = (new ProfileIterator(getId()))->getId();
+  resetRecomputeInterval();
 }
 
     /**
@@ -476,8 +481,8 @@ void Profile::handleTransactionVariableDeletion(const TransactionId t){
 
     void Profile::getLevel(const eint time, IntervalDomain& dest) {
     	if(needsRecompute())
-    		handleRecompute();
-    	std::map<eint, InstantId>::iterator it = getGreatestInstant(time);
+    		handleRecompute(time);
+    	InstantMap::iterator it = getGreatestInstant(time);
     	IntervalDomain result;
 
     	if(it == m_instants.end()) {
@@ -491,13 +496,13 @@ void Profile::handleTransactionVariableDeletion(const TransactionId t){
     }
 
     //i should really re-name these.
-    std::map<eint, InstantId>::iterator Profile::getGreatestInstant(const eint time) {
+    InstantMap::iterator Profile::getGreatestInstant(const eint time) {
     	debugMsg("Profile:getGreatestInstant", "Greatest Instant not greater than " << time);
 
     	if(m_instants.empty())
     		return m_instants.end();
 
-    	std::map<eint, InstantId>::iterator retval = m_instants.lower_bound(time);
+    	InstantMap::iterator retval = m_instants.lower_bound(time);
 
     	//checkError(retval != m_instants.end(), "No instant with time not greater than " << time);
     	if(retval == m_instants.end() ||
@@ -513,12 +518,12 @@ void Profile::handleTransactionVariableDeletion(const TransactionId t){
     	return retval;
     }
     
-    std::map<eint, InstantId>::iterator Profile::getLeastInstant(const eint time) {
+    InstantMap::iterator Profile::getLeastInstant(const eint time) {
       debugMsg("Profile:getLeastInstant", "Least Instant not less than " << time);
       if(m_instants.empty())
         return m_instants.end();
 
-      std::map<eint, InstantId>::iterator retval = m_instants.lower_bound(time);
+      InstantMap::iterator retval = m_instants.lower_bound(time);
       
       if(retval == m_instants.end())
         --retval;
@@ -534,12 +539,88 @@ void Profile::handleTransactionVariableDeletion(const TransactionId t){
         handleRecompute();
     }
 
-void Profile::handleRecompute() {
+    void Profile::recompute(const eint horizon, const unsigned long flawLimit) {
+      if(needsRecompute())
+        handleRecompute(horizon, flawLimit);
+    }
+
+    void Profile::recomputeDeferred(const eint horizon) {
+      checkError(!m_deferred, "Recomputing a profile whose deferred notifications are still held back.");
+      if(!needsRecompute())
+        return;
+
+      // nothing before the recompute interval changes, but levels after it may be shifted
+      m_deferred = true;
+      m_deferredStart = m_recomputeInterval->getStartTime();
+      m_deferredEnd = m_recomputeInterval->getEndTime();
+      m_deferredExplanation = m_violationExplanation;
+      m_deferredFlags.clear();
+      for(InstantMap::const_iterator it = m_instants.lower_bound(m_deferredStart); it != m_instants.end(); ++it) {
+        const InstantId inst = it->second;
+        InstantFlags flags;
+        flags.inst = inst;
+        flags.violated = inst->m_violated;
+        flags.flawed = inst->m_flawed;
+        flags.upperFlaw = inst->m_upperFlaw;
+        flags.lowerFlaw = inst->m_lowerFlaw;
+        flags.upperFlawMagnitude = inst->m_upperFlawMagnitude;
+        flags.lowerFlawMagnitude = inst->m_lowerFlawMagnitude;
+        m_deferredFlags.push_back(flags);
+      }
+
+      m_detector->deferNotifications(true);
+      try {
+        recompute(horizon);
+      }
+      catch(...) {
+        m_detector->deferNotifications(false);
+        throw;
+      }
+      m_detector->deferNotifications(false);
+    }
+
+    void Profile::flushNotifications() {
+      m_deferred = false;
+      m_deferredFlags.clear();
+      m_deferredExplanation.clear();
+      m_detector->flushNotifications();
+    }
+
+    void Profile::discardNotifications() {
+      m_detector->discardNotifications();
+      if(!m_deferred)
+        return;
+
+      for(std::vector<InstantFlags>::const_iterator it = m_deferredFlags.begin(); it != m_deferredFlags.end(); ++it) {
+        const InstantId inst = it->inst;
+        check_error(inst.isValid());
+        inst->m_violated = it->violated;
+        inst->m_flawed = it->flawed;
+        inst->m_upperFlaw = it->upperFlaw;
+        inst->m_lowerFlaw = it->lowerFlaw;
+        inst->m_upperFlawMagnitude = it->upperFlawMagnitude;
+        inst->m_lowerFlawMagnitude = it->lowerFlawMagnitude;
+      }
+      m_violationExplanation.swap(m_deferredExplanation);
+      resetRecomputeInterval(m_deferredStart, m_deferredEnd);
+      m_needsRecompute = true;
+
+      m_deferred = false;
+      m_deferredFlags.clear();
+      m_deferredExplanation.clear();
+    }
+
+void Profile::handleRecompute(const eint horizon, const unsigned long flawLimit) {
   checkError(m_recomputeInterval.isValid(),
              "Attempted to recompute levels over an invalid interval.");
   condDebugMsg(m_recomputeInterval->done(), "Profile:recompute", "No instants over which to recompute.");
-  debugMsg("Profile:handleRecompute","Invoked");
+  debugMsg("Profile:handleRecompute","Invoked up to " << horizon << " with flaw limit " << flawLimit);
+
+  //nothing before the horizon is out of date
+  if(!m_recomputeInterval->done() && m_recomputeInterval->getInstant()->getTime() > horizon)
+    return;
   debugMsg("Profile:recompute:prePrint", std::endl << toString());
+  m_violationExplanation.clear();
 
   eint endTime = MINUS_INFINITY;
   std::pair<edouble,edouble> endDiff(0.0,0.0);
@@ -547,6 +628,7 @@ void Profile::handleRecompute() {
   if(!m_recomputeInterval->done()) {
     InstantId prev = InstantId::noId();
     bool violation = false;
+    unsigned long flaws = 0;
     endTime = m_recomputeInterval->getEndTime();
 
     //if there is no preceding instant, do a clean init
@@ -570,7 +652,7 @@ void Profile::handleRecompute() {
         endDiff.second = inst->getUpperLevel() - endDiff.second;
       }
 
-      std::map<eint, InstantId>::iterator it = getGreatestInstant(inst->getTime() - 1);
+      InstantMap::iterator it = getGreatestInstant(inst->getTime() - 1);
       if(it != m_instants.end()) {
         prev = it->second;
       }
@@ -588,6 +670,14 @@ void Profile::handleRecompute() {
           !violation ) {
       InstantId inst = m_recomputeInterval->getInstant();
 
+      //leave the rest of the interval for later.  Subclasses carry state from one instant to the
+      //next, so the whole interval is recomputed when more of it is needed.
+      if(inst->getTime() > horizon || (flawLimit != 0 && flaws >= flawLimit)) {
+        debugMsg("Profile:handleRecompute", "Stopping at " << inst->getTime() << " after " << flaws << " flaws");
+        resetRecomputeInterval(m_recomputeInterval->getStartTime(), endTime);
+        return;
+      }
+
       if (inst->getTime() == endTime) {
         endDiff.first = inst->getLowerLevel();
         endDiff.second = inst->getUpperLevel();
@@ -603,6 +693,8 @@ void Profile::handleRecompute() {
       }
 
       violation = m_detector->detect(inst);
+      if(inst->isFlawed())
+        flaws++;
 
       prev = inst;
       m_recomputeInterval->next();
@@ -628,7 +720,7 @@ void Profile::postHandleRecompute(const eint& endTime,
 
   // Apply endDiff to (endTime,PLUS_INFINITY)
   bool violation = false;
-  std::map<eint, InstantId>::iterator it = m_instants.upper_bound(endTime);
+  InstantMap::iterator it = m_instants.upper_bound(endTime);
   for (;(it != m_instants.end()) && !violation;++it) {
     InstantId inst = it->second;
     inst->applyBoundsDelta(endDiff.first,endDiff.second);
@@ -640,11 +732,18 @@ void Profile::addInstantsForBounds(const TransactionId t) {
   eint first = static_cast<eint>(t->time()->lastDomain().getLowerBound());
   eint last =  static_cast<eint>(t->time()->lastDomain().getUpperBound());
 
+  //addInstant() only looks at the neighbouring instants, which a restricted transaction may
+  //already have been removed from
+  const bool known = m_transactions.find(t) != m_transactions.end();
+
   {
-    std::map<eint, InstantId>::iterator ite = m_instants.find( first );
+    InstantMap::iterator ite = m_instants.find( first );
 
     if( ite == m_instants.end() ) {
       addInstant(first);
+      InstantId inst = getInstant(first);
+      if(known && inst->getTransactions().find(t) == inst->getTransactions().end())
+        inst->addTransaction(t);
     }
     else {
       InstantId inst = (*ite).second;
@@ -653,9 +752,12 @@ void Profile::addInstantsForBounds(const TransactionId t) {
   }
 
   {
-    std::map<eint, InstantId>::iterator ite = m_instants.find( last );
+    InstantMap::iterator ite = m_instants.find( last );
     if( ite == m_instants.end() ) {
       addInstant(last);
+      InstantId inst = getInstant(last);
+      if(known && inst->getTransactions().find(t) == inst->getTransactions().end())
+        inst->addTransaction(t);
     }
     else {
       InstantId inst = (*ite).second;
@@ -668,21 +770,44 @@ void Profile::addInstantsForBounds(const TransactionId t) {
       checkError(m_instants.find(time) == m_instants.end(), "Attempted to add a redundant instant for time " << time);
       debugMsg("Profile:addInstant", "Adding instant for time " << time);
       InstantId inst = (new Instant(time, m_id))->getId();
-      m_instants.insert(std::pair<eint, InstantId>(time, inst));
-
-      for(std::set<TransactionId>::const_iterator it = m_transactions.begin(); it != m_transactions.end(); ++it) {
-        TransactionId trans = *it;
-        check_error(trans.isValid());
-        check_error(trans->time().isValid());
-        if(trans->time()->lastDomain().isMember(time)) {
-          debugMsg("Profile:addInstant", "Adding transaction " << trans << " spanning " << trans->time()->toString() << " to instant at time " << time);
-          inst->addTransaction(trans);
-        }
+      InstantMap::iterator pos = m_instants.insert(std::pair<eint, InstantId>(time, inst)).first;
+
+      //every other transaction spanning the time is already in the instant before it (if it
+      //starts earlier) or in the one after it (if it ends later), so only those are examined
+      //instead of all of m_transactions.
+      if(pos != m_instants.begin()) {
+        InstantMap::iterator prev = pos;
+        --prev;
+        addSpanningTransactions(inst, prev->second->getTransactions());
       }
+      InstantMap::iterator next = pos;
+      ++next;
+      if(next != m_instants.end())
+        addSpanningTransactions(inst, next->second->getTransactions());
     }
 
+void Profile::addSpanningTransactions(const InstantId inst, const std::set<TransactionId>& transactions) {
+  for(std::set<TransactionId>::const_iterator it = transactions.begin(); it != transactions.end(); ++it) {
+    TransactionId trans = *it;
+    check_error(trans.isValid());
+    check_error(trans->time().isValid());
+    if(trans->time()->lastDomain().isMember(inst->getTime()) &&
+       inst->getTransactions().find(trans) == inst->getTransactions().end()) {
+      debugMsg("Profile:addInstant", "Adding transaction " << trans << " spanning " << trans->time()->toString() << " to instant at time " << inst->getTime());
+      inst->addTransaction(trans);
+    }
+  }
+}
+
+void Profile::resetRecomputeInterval(const eint startTime, const eint endTime) {
+  if(m_recomputeInterval.isValid())
+    m_recomputeInterval->reset(startTime, endTime);
+  else
+    m_recomputeInterval = (new ProfileIterator(getId(), startTime, endTime))->getId();
+}
+
 void Profile::removeInstant(const eint time) {
-  std::map<eint, InstantId>::iterator pit = m_instants.find(time);
+  InstantMap::iterator pit = m_instants.find(time);
   check_error(pit != m_instants.end());
   if (!containsChange(pit->second)) {
     InstantId inst = pit->second;
@@ -701,6 +826,21 @@ void Profile::removeInstant(const eint time) {
       results.insert(results.end(), inst->getTransactions().begin(), inst->getTransactions().end());
     }
 
+void Profile::explainViolation(const InstantId inst, const Resource::ProblemType problem) {
+  check_error(inst.isValid());
+  m_violationExplanation.clear();
+  getViolationExplanation(inst, problem, m_violationExplanation);
+  debugMsg("Profile:explainViolation", "Explained the violation at " << inst->getTime() << " with " <<
+           m_violationExplanation.size() << " of " << m_transactions.size() << " transactions");
+}
+
+void Profile::getViolationExplanation(const InstantId inst, const Resource::ProblemType,
+                                      std::vector<TransactionId>& results) {
+  for(std::set<TransactionId>::const_iterator it = m_transactions.begin(); it != m_transactions.end(); ++it)
+    if((*it)->time()->baseDomain().getLowerBound() <= inst->getTime())
+      results.push_back(*it);
+}
+
     Profile::VariableListener::VariableListener(const ConstraintEngineId constraintEngine,
                                                 const ProfileId profile,
                                                 const TransactionId trans,
@@ -763,7 +903,7 @@ void Profile::ConstraintAdditionListener::notifyConstraintRemoved(const Constrai
     std::string Profile::toString() const {
       std::stringstream sstr;
       sstr << "Profile " << m_id << std::endl;
-      for(std::map<eint, InstantId>::const_iterator it = m_instants.begin(); it != m_instants.end(); ++it)
+      for(InstantMap::const_iterator it = m_instants.begin(); it != m_instants.end(); ++it)
         sstr << it->second->toString() << std::endl;
       return sstr.str();
     }
@@ -783,6 +923,11 @@ void Profile::ConstraintAdditionListener::notifyConstraintRemoved(const Constrai
           m_startTime(), m_endTime(), m_start(), m_end(), m_realEnd() {
       //if(m_profile->m_needsRecompute)
       //m_profile->handleRecompute();
+      reset(startTime, endTime);
+    }
+
+    void ProfileIterator::reset(const eint startTime, const eint endTime) {
+      m_changeCount = m_profile->m_changeCount;
       debugMsg("ProfileIterator:ProfileIterator", "Creating iterator over interval [" << startTime << " " << endTime << "] with change count " <<
                m_changeCount);
       m_realEnd = m_profile->m_instants.end();
@@ -825,14 +970,14 @@ void Profile::ConstraintAdditionListener::notifyConstraintRemoved(const Constrai
     edouble ProfileIterator::getLowerBound() const {
       checkError(!isStale(), "Stale profile iterator.");
       checkError(!done(), "Attempted to get bound of a done iterator.");
-      m_profile->recompute();
+      m_profile->recompute(m_endTime);
       return m_start->second->getLowerLevel();
     }
 
     edouble ProfileIterator::getUpperBound() const {
       checkError(!isStale(), "Stale profile iterator.");
       checkError(!done(), "Attempted to get bound of a done iterator.");
-      m_profile->recompute();
+      m_profile->recompute(m_endTime);
       return m_start->second->getUpperLevel();
     }
 
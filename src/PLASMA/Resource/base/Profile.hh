@@ -21,6 +21,7 @@
 #include "Debug.hh"
 #include "Engine.hh"
 #include "Factory.hh"
+#include "InstantMap.hh"
 
 #include <map>
 #include <utility>
@@ -87,32 +88,65 @@ class Profile : public FactoryObj {
    */
   void recompute();
 
+  /**
+   * @brief Recomputes the profile up to the given time.  Later instants stay out of date until
+   * they are asked for.
+   * @param flawLimit Also stop once this many flawed instants have been found (0 for no limit).
+   */
+  void recompute(const eint horizon, const unsigned long flawLimit = 0);
+
+  /**
+   * @brief Recomputes the profile up to the given time, holding notifications to the Resource back
+   * until flushNotifications().  Profiles of different resources may be recomputed this way on
+   * different threads, so long as the plan database doesn't change meanwhile.
+   */
+  void recomputeDeferred(const eint horizon);
+
+  /**
+   * @brief Passes the notifications held back by recomputeDeferred() on to the Resource.
+   */
+  void flushNotifications();
+
+  /**
+   * @brief Drops the notifications held back by recomputeDeferred() instead, as if the profile had
+   * not been recomputed: the flaw and violation flags of its instants are put back and it needs
+   * recomputing again.
+   */
+  void discardNotifications();
+
   const PlanDatabaseId getPlanDatabase() const {return m_planDatabase;}
 
 
   virtual void getTransactionsToOrder(const InstantId inst, std::vector<TransactionId>& results);
 
+  /**
+   * @brief The transactions explaining the violation that stopped the last recomputation: the
+   * violation stays so long as these keep their current domains.  Empty if there was none.
+   */
+  const std::vector<TransactionId>& getViolationExplanation() const {return m_violationExplanation;}
+
   const ResourceId getResource() const {return m_detector->getResource();}
 
   /**
    * @brief Gets the Instant with the greatest time that is not greater than the given time.
    * @return An iterator pointing to the instant.
    */
-  std::map<eint, InstantId>::iterator getGreatestInstant(const eint time);
+  InstantMap::iterator getGreatestInstant(const eint time);
 
   /**
    * @brief Gets the Instant with the least time not less than the given time.
    * @return An iterator pointing to the instant.
    */
-  std::map<eint, InstantId>::iterator getLeastInstant(const eint time);
+  InstantMap::iterator getLeastInstant(const eint time);
 
-  const std::map<eint, InstantId>& getInstants() {return m_instants;}
+  const InstantMap& getInstants() {return m_instants;}
       
   InstantId getInstant(const eint time) const;
 
  private:
   friend class ProfilePropagator;
   friend class ProfileIterator;
+  friend class FVDetector;
   friend class Instant;
 
   /**
@@ -195,8 +229,9 @@ class Profile : public FactoryObj {
   std::map<ConstrainedVariableId, TransactionId> m_transactionsByTime;
   ConstraintSet m_temporalConstraints;
   ConstraintEngineListenerId m_removalListener;
-  std::map<eint, InstantId> m_instants; /**< A map from times to Instants. */
+  InstantMap m_instants; /**< A map from times to Instants. */
   ProfileIteratorId m_recomputeInterval; /**< The stored interval of recomputation.*/
+  std::vector<TransactionId> m_violationExplanation; /**< See getViolationExplanation(). */
 
   bool hasTransactions() {return !m_transactions.empty();}
 
@@ -213,12 +248,25 @@ class Profile : public FactoryObj {
    * @brief Recompute the profile.  Iterates over a stored interval of time.
    * It is expected that the first Instant in the interval actually precede the first change
    * so that the flaw and violation detector can be initialized.
+   * @param horizon Instants after this time are left for a later call.
+   * @param flawLimit Instants after the flawLimit-th flawed one are left for a later call (0 for no limit).
    */
-  void handleRecompute();
+  void handleRecompute(const eint horizon = PLUS_INFINITY, const unsigned long flawLimit = 0);
   /**
    * @brief Hanlde invoked at the end of handleRecompute
    */
   virtual void postHandleRecompute(const eint& endTime, const std::pair<edouble,edouble>& endDiff);
+  /**
+   * @brief Records the explanation of a violation just found at an Instant, while the profile
+   * still holds the state it was found in.
+   */
+  void explainViolation(const InstantId inst, const Resource::ProblemType problem);
+  /**
+   * @brief Adds to results the transactions explaining a violation at the given Instant.  By
+   * default every transaction that could have happened by then.
+   */
+  virtual void getViolationExplanation(const InstantId inst, const Resource::ProblemType problem,
+                                       std::vector<TransactionId>& results);
   /**
    * @brief Initialize a recomputation with level data from the given Instant.
    * This function is expected to re-compute the levels for the given instant!
@@ -314,12 +362,22 @@ class Profile : public FactoryObj {
    * @param time The time
    */
   void addInstant(const eint time);
+  /**
+   * @brief Adds to an Instant those of the given transactions which span its time.
+   */
+  void addSpanningTransactions(const InstantId inst, const std::set<TransactionId>& transactions);
   /**
    * @brief Eliminate an instant for a time.
    * @param time The time
    */
   void removeInstant(const eint time);
 
+  /**
+   * @brief Sets the recompute interval to [startTime, endTime], reusing the current iterator if
+   * there is one.
+   */
+  void resetRecomputeInterval(const eint startTime = MINUS_INFINITY, const eint endTime = PLUS_INFINITY);
+
   edouble getInitCapacityLb() const;
 
   edouble getInitCapacityUb() const;
@@ -343,6 +401,20 @@ class Profile : public FactoryObj {
    * @return true if the map is consistent.  False otherwise.
    */
   bool checkMessageConsistency();
+
+  /**
+   * @brief The flaw and violation flags of an Instant, as they were before a deferred recompute.
+   */
+  struct InstantFlags {
+    InstantId inst;
+    bool violated, flawed, upperFlaw, lowerFlaw;
+    edouble upperFlawMagnitude, lowerFlawMagnitude;
+  };
+
+  bool m_deferred; /**< True from recomputeDeferred() until its notifications are flushed or discarded. */
+  eint m_deferredStart, m_deferredEnd; /**< The recompute interval before the deferred recompute. */
+  std::vector<InstantFlags> m_deferredFlags; /**< Flags of the instants the deferred recompute may change. */
+  std::vector<TransactionId> m_deferredExplanation; /**< The violation explanation before the deferred recompute. */
 };
 
 /**
@@ -397,6 +469,11 @@ class ProfileIterator {
    */
   bool next();
 
+  /**
+   * @brief Repositions this ProfileIterator over [startTime, endTime] of the current profile.
+   */
+  void reset(const eint startTime = MINUS_INFINITY, const eint endTime = PLUS_INFINITY);
+
   ProfileIteratorId getId(){return m_id;}
 
   /**
@@ -412,7 +489,7 @@ class ProfileIterator {
   ProfileId m_profile;
   unsigned int m_changeCount; /**< A copy of the similar variable in Profile when this iterator was instantiated.  Used to detect staleness. */
   eint m_startTime, m_endTime;
-  std::map<eint, InstantId>::const_iterator m_start, m_end, m_realEnd; /**< The start and end times over which this iterator goes*/
+  InstantMap::const_iterator m_start, m_end, m_realEnd; /**< The start and end times over which this iterator goes*/
 };
 
     class ProfileArgs : public FactoryArgs
@@ -4,9 +4,74 @@
 #include "ConstraintEngine.hh"
 #include "Debug.hh"
 #include "ResourceTokenRelation.hh"
+#include "Mutex.hh"
+#include "Error.hh"
+
+#include <pthread.h>
 
 namespace EUROPA {
 
+namespace {
+/**
+ * @brief Hands profiles out to the threads recomputing them.
+ */
+class RecomputeQueue {
+ public:
+  RecomputeQueue(const std::vector<ProfileId>& profiles, const eint horizon)
+      : m_profiles(profiles), m_horizon(horizon), m_next(0), m_error(NULL) {
+    pthread_mutex_init(&m_mutex, NULL);
+  }
+  ~RecomputeQueue() {
+    delete m_error;
+    pthread_mutex_destroy(&m_mutex);
+  }
+
+  static void* run(void* arg) {
+    static_cast<RecomputeQueue*>(arg)->work();
+    return NULL;
+  }
+
+  void work() {
+    for(ProfileId profile = next(); profile.isValid(); profile = next()) {
+      try {
+        profile->recomputeDeferred(m_horizon);
+      }
+      catch(const Error& e) {
+        fail(e);
+      }
+    }
+  }
+
+  /**
+   * @brief The first error raised by a recompute, if any.  No more profiles are handed out after one.
+   */
+  const Error* getError() const {return m_error;}
+
+ private:
+  RecomputeQueue(const RecomputeQueue&);
+  RecomputeQueue& operator=(const RecomputeQueue&);
+
+  ProfileId next() {
+    MutexGrabber grabber(m_mutex);
+    if(m_error != NULL || m_next == m_profiles.size())
+      return ProfileId::noId();
+    return m_profiles[m_next++];
+  }
+
+  void fail(const Error& e) {
+    MutexGrabber grabber(m_mutex);
+    if(m_error == NULL)
+      m_error = new Error(e);
+  }
+
+  const std::vector<ProfileId>& m_profiles;
+  const eint m_horizon;
+  unsigned long m_next; /**< Guarded by m_mutex */
+  Error* m_error; /**< Guarded by m_mutex */
+  pthread_mutex_t m_mutex;
+};
+}
+
     ProfilePropagator::ProfilePropagator(const LabelStr& name,
 					 const ConstraintEngineId constraintEngine)
     : DefaultPropagator(name, constraintEngine)
@@ -14,6 +79,9 @@ namespace EUROPA {
     , m_newConstraints()
     , m_updateRequired(false)
     , m_inBatchMode(false)
+    , m_lazy(false)
+    , m_horizon(MINUS_INFINITY)
+    , m_threadCount(1)
     , m_batchListener(NULL)
     {
     }
@@ -22,6 +90,13 @@ namespace EUROPA {
     {
     }
 
+    PropagatorId ProfilePropagator::copy(const ConstraintEngineId constraintEngine) const {
+      ProfilePropagator* propagator = new ProfilePropagator(getName(), constraintEngine);
+      propagator->setLazy(m_lazy, m_horizon);
+      propagator->setThreadCount(m_threadCount);
+      return propagator->getId();
+    }
+
     void ProfilePropagator::handleConstraintAdded(const ConstraintId constraint) {
     	check_error(constraint.isValid());
     	if(constraint->getName() == Profile::VariableListener::CONSTRAINT_NAME()) {
@@ -81,21 +156,7 @@ namespace EUROPA {
     	  m_profiles.insert(listener->getProfile());
       }
 
-      for(std::set<ProfileId>::iterator it = m_profiles.begin(); it != m_profiles.end(); ++it) {
-    	  ProfileId profile = *it;
-    	  check_error(profile.isValid());
-    	  if( !getConstraintEngine()->provenInconsistent()
-    			  &&
-    			  profile->needsRecompute()) {
-            condDebugMsg(profile->getResource() != ResourceId::noId(),
-                         "ProfilePropagator:execute", 
-                         "Recomputing profile " << profile->getResource()->getName().toString());
-            condDebugMsg(profile->getResource() == ResourceId::noId(),
-                         "ProfilePropagator:execute", 
-                         "Recomputing profile " << profile);
-            profile->recompute();
-    	  }
-      }
+      recomputeProfiles(m_lazy ? m_horizon : PLUS_INFINITY);
 
       m_updateRequired = false;
       debugMsg("ProfilePropagator:execute", "Executed ProfilePropagator");
@@ -110,6 +171,88 @@ void ProfilePropagator::execute(const ConstraintId constraint) {
   }
 }
 
+void ProfilePropagator::executeDeferred() {
+  if(m_lazy)
+    recomputeProfiles(PLUS_INFINITY);
+}
+
+void ProfilePropagator::recomputeProfiles(const eint horizon) {
+  if(m_threadCount > 1) {
+    recomputeConcurrently(horizon);
+    return;
+  }
+
+  for(std::set<ProfileId>::iterator it = m_profiles.begin(); it != m_profiles.end(); ++it) {
+    ProfileId profile = *it;
+    check_error(profile.isValid());
+    if(!getConstraintEngine()->provenInconsistent() && profile->needsRecompute()) {
+      condDebugMsg(profile->getResource() != ResourceId::noId(),
+                   "ProfilePropagator:execute",
+                   "Recomputing profile " << profile->getResource()->getName().toString());
+      condDebugMsg(profile->getResource() == ResourceId::noId(),
+                   "ProfilePropagator:execute",
+                   "Recomputing profile " << profile);
+      profile->recompute(horizon);
+    }
+  }
+}
+
+/**
+ * Profiles share nothing but the plan database, which isn't changed until every thread has
+ * finished: flaws and violations are held back by each profile's detector and passed on here
+ * afterwards, in the order the profiles would have been recomputed one after another.
+ */
+void ProfilePropagator::recomputeConcurrently(const eint horizon) {
+  if(getConstraintEngine()->provenInconsistent())
+    return;
+
+  std::vector<ProfileId> profiles;
+  for(std::set<ProfileId>::const_iterator it = m_profiles.begin(); it != m_profiles.end(); ++it) {
+    check_error(it->isValid());
+    if((*it)->needsRecompute())
+      profiles.push_back(*it);
+  }
+  if(profiles.size() < 2) {
+    for(std::vector<ProfileId>::const_iterator it = profiles.begin(); it != profiles.end(); ++it)
+      (*it)->recompute(horizon);
+    return;
+  }
+
+  RecomputeQueue queue(profiles, horizon);
+  std::vector<pthread_t> threads(std::min<std::size_t>(m_threadCount, profiles.size()) - 1);
+  debugMsg("ProfilePropagator:recomputeConcurrently",
+           "Recomputing " << profiles.size() << " profiles on " << threads.size() + 1 << " threads");
+  for(std::vector<pthread_t>::iterator it = threads.begin(); it != threads.end(); ++it) {
+    int rc = pthread_create(&(*it), NULL, &RecomputeQueue::run, &queue);
+    checkRuntimeError(rc == 0, "Failed to start a profile thread: " << rc);
+  }
+  queue.work();
+  for(std::vector<pthread_t>::iterator it = threads.begin(); it != threads.end(); ++it)
+    pthread_join(*it, NULL);
+
+  // stop where recomputing one after another would have stopped.  The profiles after that are
+  // left as if they had not been recomputed, so they are recomputed again later.
+  std::vector<ProfileId>::const_iterator it = profiles.begin();
+  for(; it != profiles.end() && !getConstraintEngine()->provenInconsistent(); ++it)
+    (*it)->flushNotifications();
+  for(; it != profiles.end(); ++it)
+    (*it)->discardNotifications();
+
+  if(queue.getError() != NULL)
+    throw Error(*queue.getError());
+}
+
+void ProfilePropagator::setThreadCount(const unsigned int count) {
+  checkError(count > 0, "Profiles need at least one thread to be recomputed on.");
+  m_threadCount = count;
+}
+
+void ProfilePropagator::setLazy(const bool lazy, const eint horizon) {
+  debugMsg("ProfilePropagator:setLazy", std::boolalpha << lazy << " up to " << horizon);
+  m_lazy = lazy;
+  m_horizon = horizon;
+}
+
     bool ProfilePropagator::updateRequired() const {
       return DefaultPropagator::updateRequired() || m_updateRequired;
     }
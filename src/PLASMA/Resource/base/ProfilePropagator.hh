@@ -17,11 +17,31 @@ private:
 
   virtual ~ProfilePropagator();
 
+  virtual PropagatorId copy(const ConstraintEngineId constraintEngine) const;
+
   // Batch mode delays all propagation until Batch mode is exited
   virtual void enterBatchMode();
   virtual void exitBatchMode();
   virtual bool inBatchMode() const { return m_inBatchMode; }
 
+  /**
+   * @brief In lazy mode propagation only recomputes profiles up to the horizon.  The rest of a
+   * profile is recomputed when its levels or flaws are asked for, or by
+   * ConstraintEngine::propagateDeferred().
+   */
+  void setLazy(const bool lazy, const eint horizon = MINUS_INFINITY);
+  bool isLazy() const {return m_lazy;}
+  eint getHorizon() const {return m_horizon;}
+
+  /**
+   * @brief Recompute the profiles that need it on up to this many threads at once.  Profiles are
+   * recomputed against the temporal network as it stands, and the flaws and violations they find
+   * are passed on to their resources afterwards on the propagating thread.  With one thread (the
+   * default) profiles are recomputed one after another.
+   */
+  void setThreadCount(const unsigned int count);
+  unsigned int getThreadCount() const {return m_threadCount;}
+
  protected:
   friend class Profile;
   void setUpdateRequired(const bool update) {m_updateRequired = update;}
@@ -31,11 +51,17 @@ private:
   bool updateRequired() const;
   void handleConstraintAdded(const ConstraintId constraint);
   void handleConstraintRemoved(const ConstraintId constraint);
+  void executeDeferred();
+  void recomputeProfiles(const eint horizon);
+  void recomputeConcurrently(const eint horizon);
 
   std::set<ProfileId> m_profiles;
   std::set<ConstraintId> m_newConstraints;
   bool m_updateRequired;
   bool m_inBatchMode;
+  bool m_lazy;
+  eint m_horizon;
+  unsigned int m_threadCount;
   ConstraintEngineListener* m_batchListener;
 };
 }
@@ -124,8 +124,8 @@ void Resource::init(const edouble initCapacityLb, const edouble initCapacityUb,
 
 	void Resource::detectFV(const eint& time)
 	{
-		const std::map<eint, InstantId>& usages = m_profile->getInstants();
-		std::map<eint, InstantId>::iterator nextUsage = m_profile->getLeastInstant(time);
+		const InstantMap& usages = m_profile->getInstants();
+		InstantMap::iterator nextUsage = m_profile->getLeastInstant(time);
 		if (nextUsage != usages.end())
 			m_detector->detect(nextUsage->second);
 	}
@@ -182,6 +182,7 @@ void Resource::init(const edouble initCapacityLb, const edouble initCapacityUb,
 
 
   bool Resource::hasTokensToOrder() const {
+    m_profile->recompute();
     return !m_flawedTokens.empty();
   }
 
@@ -199,7 +200,8 @@ void Resource::init(const edouble initCapacityLb, const edouble initCapacityUb,
       return;
     }
 
-    std::multimap<TokenId, TokenId> pairs;
+    // Pairs are returned in the order they are found, so a limited call gives a prefix of the full list
+    std::set<std::pair<TokenId, TokenId> > seen;
     std::map<eint, InstantId>::iterator first = m_flawedInstants.lower_bound(token->start()->lastDomain().getLowerBound());
     if(first == m_flawedInstants.end()) {
       debugMsg("Resource:getOrderingChoices", "No ordering choices:  no flawed instants after token start: " << token->start()->lastDomain().getLowerBound());
@@ -256,36 +258,17 @@ void Resource::init(const edouble initCapacityLb, const edouble initCapacityUb,
                    "Considering order <" << predecessorToken->getPredicateName().toString() << "(" << predecessorToken->getKey() << "), " <<
                    successorToken->getPredicateName().toString() << "(" << successorToken->getKey() << ")>");
 
-          std::multimap<TokenId, TokenId>::iterator checkFirst = pairs.lower_bound(predecessorToken);
-          //if we have an entry for the predecessor
-          if(checkFirst != pairs.end() && checkFirst->first == predecessorToken) {
-            bool foundPair = false;
-            //look for the successor
-            while(checkFirst != pairs.end() && checkFirst->first == predecessorToken) {
-              if(checkFirst->second == successorToken) {
-                debugMsg("Resource:getOrderingChoices", "Order already exists.");
-                foundPair = true;
-                break;
-              }
-              ++checkFirst;
-            }
-            //if we haven't found one
-            if(!foundPair) {
-              debugMsg("Resource:getOrderingChoices", "Adding order.");
-              pairs.insert(std::pair<TokenId, TokenId>(predecessorToken, successorToken));
-              ++count;
-            }
-          }
-          else {
-            debugMsg("Resource:getOrderingChoices", "Adding order.");
-            pairs.insert(std::make_pair(predecessorToken, successorToken));
-            ++count;
+          if(!seen.insert(std::make_pair(predecessorToken, successorToken)).second) {
+            debugMsg("Resource:getOrderingChoices", "Order already exists.");
+            continue;
           }
+
+          debugMsg("Resource:getOrderingChoices", "Adding order.");
+          results.push_back(std::make_pair(predecessorToken, successorToken));
+          ++count;
         }
       }
     }
-    for(std::multimap<TokenId, TokenId>::iterator it = pairs.begin(); it != pairs.end(); ++it)
-      results.push_back(*it);
     debugMsg("Resource:getOrderingChoices", "Ultimately found " << results.size() << " orderings.");
   }
 
@@ -294,6 +277,10 @@ void Resource::init(const edouble initCapacityLb, const edouble initCapacityUb,
     getPlanDatabase()->getConstraintEngine()->propagate();
     checkError(getPlanDatabase()->getConstraintEngine()->constraintConsistent(),
                "Should be consistent to continue here. Should have checked before you called the method in the first place.");
+    //a profile left out of date by lazy propagation may turn out to be violated
+    m_profile->recompute();
+    if(!getPlanDatabase()->getConstraintEngine()->constraintConsistent())
+      return;
     for(ResourceFlaws::const_iterator it = m_flawedTokens.begin(); it != m_flawedTokens.end(); ++it)
       results.push_back(it->first);
   }
@@ -392,8 +379,26 @@ void Resource::resetViolations(InstantId ) {
       }
     }
     else {
-      const_cast<Domain&>(txn->quantity()->lastDomain()).empty();
+      emptyForViolation(inst);
+    }
+  }
+
+  void Resource::emptyForViolation(const InstantId inst)
+  {
+    TransactionId txn = *(inst->getTransactions().begin());
+    ConstraintEngineId ce = txn->quantity()->getConstraintEngine();
+
+    // the emptied variable is arbitrary, so name what the violation actually depends on:
+    // when and how much each transaction uses, and that its token is active on this resource
+    const std::vector<TransactionId>& explanation = m_profile->getViolationExplanation();
+    for(std::vector<TransactionId>::const_iterator it = explanation.begin(); it != explanation.end(); ++it) {
+      TokenId tok = getTokenForTransaction(*it);
+      ce->addConflictVariable((*it)->time());
+      ce->addConflictVariable((*it)->quantity());
+      ce->addConflictVariable(tok->getState());
+      ce->addConflictVariable(tok->getObject());
     }
+    const_cast<Domain&>(txn->quantity()->lastDomain()).empty();
   }
 
   void Resource::notifyNoLongerViolated(const InstantId inst)
@@ -535,6 +540,7 @@ void Resource::notifyDeleted(const TokenId token) {Object::notifyDeleted(token);
   }
 
   void Resource::getFlawedInstants(std::vector<InstantId>& results) {
+    m_profile->recompute();
     std::transform(m_flawedInstants.begin(), 
 		   m_flawedInstants.end(), 
 		   std::back_inserter(results), 
@@ -542,6 +548,17 @@ void Resource::notifyDeleted(const TokenId token) {Object::notifyDeleted(token);
     debugMsg("Resource:getFlawedInstants", "Have " << m_flawedInstants.size() << " flawed instants.  Returning " << results.size() << ".");
   }
 
+  void Resource::getFlawedInstants(std::vector<InstantId>& results, const eint horizon, const unsigned long flawLimit) {
+    m_profile->recompute(horizon, flawLimit);
+    //the first flawLimit flaws are all up to date: any flaws found by the recompute come before where it stopped
+    unsigned long count = 0;
+    for(std::map<eint, InstantId>::const_iterator it = m_flawedInstants.begin();
+        it != m_flawedInstants.end() && it->first <= horizon && (flawLimit == 0 || count < flawLimit); ++it, ++count)
+      results.push_back(it->second);
+    debugMsg("Resource:getFlawedInstants", "Have " << m_flawedInstants.size() << " flawed instants.  Returning " << count <<
+             " up to " << horizon << ".");
+  }
+
 void Resource::getOrderingChoices(const InstantId inst,
                                   std::vector<std::pair<TransactionId, TransactionId> >& results,
                                   unsigned long limit) {
@@ -566,36 +583,38 @@ void Resource::getOrderingChoices(const InstantId inst,
   for(std::set<TransactionId>::const_iterator preIt = transactions.begin(); preIt != transactions.end() && count < limit; ++preIt) {
     TransactionId predecessor = *preIt;
     check_error(predecessor.isValid());
-    //for(std::set<TransactionId>::const_iterator sucIt = transactions.begin(); sucIt != transactions.end() && count < limit; ++sucIt) {
+    //only transactions which overlap the predecessor can be ordered with it, so leave the rest
+    //out of the temporal distance query
+    std::vector<TransactionId> successors;
     std::vector<ConstrainedVariableId> sucTimevars;
-    for(std::map<TransactionId, TokenId>::const_iterator sucIt = m_transactionsToTokens.begin(); sucIt != m_transactionsToTokens.end() && count < limit; ++sucIt) {
+    for(std::map<TransactionId, TokenId>::const_iterator sucIt = m_transactionsToTokens.begin(); sucIt != m_transactionsToTokens.end(); ++sucIt) {
       TransactionId successor = sucIt->first;
       check_error(successor.isValid());
+      debugMsg("Resource:getOrderingChoices", "Considering pair <" << predecessor->toString() << ", " << successor->toString());
+      if(predecessor == successor || !predecessor->time()->lastDomain().intersects(successor->time()->lastDomain())) {
+        condDebugMsg(predecessor == successor, "Resource:getOrderingChoices", "Rejected pair because they are the same transaction.");
+        condDebugMsg(!predecessor->time()->lastDomain().intersects(successor->time()->lastDomain()), "Resource:getOrderingChoices",
+                     "Rejected pair because successor does not overlap predecessor.");
+        continue;
+      }
+      successors.push_back(successor);
       sucTimevars.push_back(TimeVarId(successor->time()));
     }
+    if(successors.empty())
+      continue;
     std::vector<eint> presucLbs;
     std::vector<eint> presucUbs;
     temporalAdvisor->getTemporalDistanceSigns(TimeVarId(predecessor->time()),
                                               sucTimevars, presucLbs, presucUbs);
-    unsigned int i = 0;
 
-    for(std::map<TransactionId, TokenId>::const_iterator sucIt = m_transactionsToTokens.begin(); sucIt != m_transactionsToTokens.end() && count < limit; ++sucIt) {
-      TransactionId successor = sucIt->first;
-      check_error(successor.isValid());
+    for(unsigned int i = 0; i < successors.size() && count < limit; ++i) {
+      TransactionId successor = successors[i];
 
       bool canPrecede = (presucUbs[i] >= 0);//temporalAdvisor->canPrecede(TimeVarId(predecessor->time()), TimeVarId(successor->time()));
       bool mustPrecede = (presucLbs[i] >= 0);
       bool canFollow = (presucLbs[i] <= 0);
       bool mustFollow = (presucUbs[i] <= 0);
-      i++;
 
-      debugMsg("Resource:getOrderingChoices", "Considering pair <" << predecessor->toString() << ", " << successor->toString());
-      if(predecessor == successor || !predecessor->time()->lastDomain().intersects(successor->time()->lastDomain())) {
-        condDebugMsg(predecessor == successor, "Resource:getOrderingChoices", "Rejected pair because they are the same transaction.");
-        condDebugMsg(!predecessor->time()->lastDomain().intersects(successor->time()->lastDomain()), "Resource:getOrderingChoices",
-                     "Rejected pair because successor does not overlap predecessor.");
-        continue;
-      }
       //if(temporalAdvisor->canPrecede(TimeVarId(predecessor->time()), TimeVarId(successor->time())) &&
       //!transConstrainedToPrecede(predecessor, successor)) {
       // //results.push_back(std::make_pair(predecessor, successor));
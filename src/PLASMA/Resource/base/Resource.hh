@@ -169,6 +169,14 @@ namespace EUROPA {
 
       virtual void getFlawedInstants(std::vector<InstantId>& results);
 
+      /**
+       * @brief Gets the flawed instants up to a time, in time order.  The profile is only recomputed as
+       * far as needed, so instants after the horizon or after the last flaw returned may be out of date.
+       * @param horizon The latest time of interest.
+       * @param flawLimit The most instants to return (0 for no limit).
+       */
+      void getFlawedInstants(std::vector<InstantId>& results, const eint horizon, const unsigned long flawLimit);
+
       bool hasTokensToOrder() const;
       //ResourceId getId() {return m_id;}
       //subclasses will need to override getOrderingChoices, getTokensToOrder
@@ -260,6 +268,13 @@ namespace EUROPA {
       TokenId getTokenForTransaction(TransactionId t);
       ResourceTokenRelationId getRTRConstraint(TokenId tok);
 
+      /**
+       * @brief Fails propagation over a violated instant by emptying a variable of one of its
+       * transactions, naming the variables of the profile's explanation, along with the state and
+       * object variables of their tokens, as the rest of the conflict.
+       */
+      void emptyForViolation(const InstantId inst);
+
       void detectFV(const eint& time);
 
     private:
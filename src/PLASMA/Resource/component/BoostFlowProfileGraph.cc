@@ -240,6 +240,32 @@ edouble BoostFlowProfileGraph::getResidualFromSource() {
   return residual;
 }
 
+bool BoostFlowProfileGraph::getReachableTransactions(std::set<TransactionId>& results) const {
+  using namespace boost;
+  if(m_recalculate)
+    return false;
+  property_map<Graph, edge_residual_capacity_t>::const_type
+      residualCapacity = get(edge_residual_capacity, m_graph);
+  std::vector<bool> visited(num_vertices(m_graph), false);
+  visited[m_source] = true;
+  visited[m_sink] = true;
+  std::vector<Vertex> agenda(1, m_source);
+  while(!agenda.empty()) {
+    Vertex v = agenda.back();
+    agenda.pop_back();
+    Graph::out_edge_iterator outIt, outEnd;
+    for(tie(outIt, outEnd) = out_edges(v, m_graph); outIt != outEnd; ++outIt) {
+      Vertex other = target(*outIt, m_graph);
+      if(!visited[other] && residualCapacity[*outIt] > 0) {
+        visited[other] = true;
+        results.insert(getTransaction(other));
+        agenda.push_back(other);
+      }
+    }
+  }
+  return true;
+}
+
 void BoostFlowProfileGraph::removeTransaction(const TransactionId id) {
   using namespace boost;
   debugMsg("BoostFlowProfileGraph:removeTransaction", 
@@ -101,6 +101,11 @@ class BoostFlowProfileGraph : public FlowProfileGraph {
    * node to \a instant.
    */
   edouble disableReachableResidualGraph( TransactionId2InstantId, const InstantId  ) {return 0.0;}
+  /**
+   * @brief Adds to \a results the transaction of every node reachable from the source in the residual
+   * network. Returns false if the maximum flow is out of date.
+   */
+  bool getReachableTransactions(std::set<TransactionId>& results) const;
   /**
    * @brief Removes transaction \a id from the network.
    */
@@ -27,10 +27,20 @@
 #include "TokenVariable.hh"
 #include "Utils.hh"
 #include "Variable.hh"
+#include "Mutex.hh"
+
+#include <vector>
 
 namespace EUROPA {
     //-------------------------------
 
+// The temporal network keeps the state of a search in its nodes, so profiles recomputed on
+// different threads (see ProfilePropagator::setThreadCount) take turns asking it for distances.
+static pthread_mutex_t& temporalDistanceMutex() {
+  static pthread_mutex_t sl_mutex = PTHREAD_MUTEX_INITIALIZER;
+  return sl_mutex;
+}
+
 FlowProfile::FlowProfile( const PlanDatabaseId db, const FVDetectorId flawDetector):
     Profile( db, flawDetector),
     m_previousTimeBounds(),
@@ -45,9 +55,10 @@ FlowProfile::FlowProfile( const PlanDatabaseId db, const FVDetectorId flawDetect
     m_orderings(),
     m_orderedAt(),
     m_lowerLevelContribution(),
-    m_upperLevelContribution()
+    m_upperLevelContribution(),
+    m_pendingTransactions()
 {
-  m_recomputeInterval = (new ProfileIterator(getId()))->getId();
+  resetRecomputeInterval();
 
   // every node in the maximum flow graph is identified by the id of the associated Transaction
   // we make a dummy transaction for the source and sink nodes of the graphs
@@ -68,6 +79,11 @@ FlowProfile::FlowProfile( const PlanDatabaseId db, const FVDetectorId flawDetect
   initializeGraphs<FlowProfileGraphImpl>();
 }
 
+    void FlowProfile::resetGraphs()
+    {
+      initializeGraphs<FlowProfileGraphImpl>();
+    }
+
     FlowProfile::~FlowProfile()
     {
       delete m_lowerLevelGraph;
@@ -88,9 +104,9 @@ bool FlowProfile::getEarliestLowerLevelInstant(const TransactionId t, InstantId&
     return true;
   }
   else {
-    std::map<eint, InstantId>::const_iterator end = 
+    InstantMap::const_iterator end = 
         m_instants.upper_bound(t->time()->lastDomain().getUpperBound());
-    for(std::map<eint, InstantId>::const_iterator start = 
+    for(InstantMap::const_iterator start = 
             m_instants.lower_bound(t->time()->lastDomain().getLowerBound());
         start != end; ++start) {
       InstantId inst = start->second;
@@ -124,9 +140,9 @@ bool FlowProfile::getEarliestUpperLevelInstant(const TransactionId t, InstantId&
     return true;
   }
   else {
-    std::map<eint, InstantId>::const_iterator end = 
+    InstantMap::const_iterator end = 
         m_instants.upper_bound(t->time()->lastDomain().getUpperBound());
-    for(std::map<eint, InstantId>::const_iterator start = 
+    for(InstantMap::const_iterator start = 
             m_instants.lower_bound(t->time()->lastDomain().getLowerBound());
         start != end; ++start) {
       InstantId inst = start->second;
@@ -160,6 +176,7 @@ void FlowProfile::initRecompute(InstantId inst) {
            << inst->getTime() );
   m_lowerClosedLevel = getInitCapacityLb();
   m_upperClosedLevel = getInitCapacityUb();
+  m_pendingTransactions.clear();
   
   for(std::set<TransactionId>::const_iterator it = m_transactions.begin(); 
       it != m_transactions.end(); ++it) {
@@ -192,6 +209,7 @@ void FlowProfile::initRecompute(InstantId inst) {
     	// initial level
     	m_lowerClosedLevel = getInitCapacityLb();
     	m_upperClosedLevel = getInitCapacityUb();
+    	m_pendingTransactions.clear();
     }
 
     void FlowProfile::postHandleRecompute(const eint& endTime, const std::pair<edouble,edouble>& endDiff)
@@ -216,6 +234,8 @@ void FlowProfile::recomputeLevels(InstantId prev, InstantId inst) {
   std::set<TransactionId>::const_iterator iter = transactions.begin();
   std::set<TransactionId>::const_iterator end = transactions.end();
 
+  std::vector<TransactionId> entering;
+
   for( ; iter != end; ++iter )
   {
     const TransactionId transaction1 = (*iter);
@@ -229,6 +249,8 @@ void FlowProfile::recomputeLevels(InstantId prev, InstantId inst) {
                << transaction1->time()->toString() << " "
                << transaction1->quantity()->toString() << " enters closed set.");
 
+      m_pendingTransactions.erase( transaction1 );
+
       if( m_recalculateLowerLevel )
         m_lowerLevelGraph->removeTransaction( transaction1 );
 
@@ -253,53 +275,29 @@ void FlowProfile::recomputeLevels(InstantId prev, InstantId inst) {
           m_lowerClosedLevel += transaction1->quantity()->lastDomain().getLowerBound();
       }
     }
-    else
+    else if( m_pendingTransactions.find( transaction1 ) == m_pendingTransactions.end() )
     {
-      // if( transaction1->time()->lastDomain().getLowerBound() == inst->getTime() )
-      // {
-        enableTransaction( transaction1, inst );
+      entering.push_back( transaction1 );
+    }
+  }
+
+  // transactions stay in the pending set until they close, so only the ones
+  // entering it change the graphs; the flow is repaired rather than recomputed
+  for( std::vector<TransactionId>::const_iterator enteringIter = entering.begin();
+       enteringIter != entering.end(); ++enteringIter )
+  {
+    const TransactionId transaction1 = (*enteringIter);
 
-        std::set<TransactionId>::const_iterator secondIter = transactions.begin();
+    enableTransaction( transaction1, inst );
 
-        for( ; secondIter != end; ++secondIter )
-        {
-          const TransactionId transaction2 = (*secondIter);
-
-          if( transaction1 != transaction2  )
-          {
-            if( transaction2->time()->lastDomain().getUpperBound() != inst->getTime() )
-            {
-              enableTransaction( transaction2, inst );
-
-              debugMsg("FlowProfile:recomputeLevels",
-                       "Determining ordering of pending transaction ("
-                       << transaction1->getId() << ") "
-                       << transaction1->time()->toString() << 
-                       " and pending transaction ("
-                       << transaction2->getId() << ") "
-                       << transaction2->time()->toString() );
-
-              Order order = getOrdering( transaction1, transaction2 );
-
-              if( STRICTLY_AT == order )
-              {
-                handleOrderedAt( transaction1, transaction2 );
-              }
-              else if( BEFORE_OR_AT == order )
-              {
-                handleOrderedAtOrBefore( transaction1, transaction2 );
-              }
-              else
-              {
-                debugMsg("FlowProfile::recomputeLevels","Transaction ("
-                         << transaction1->getId() << ") and Transaction ("
-                         << transaction2->getId() << ") not constrained");
-              }
-            }
-          }
-        }
-      // }
+    for( std::set<TransactionId>::const_iterator pendingIter = m_pendingTransactions.begin();
+         pendingIter != m_pendingTransactions.end(); ++pendingIter )
+    {
+      enableOrdering( transaction1, *pendingIter );
+      enableOrdering( *pendingIter, transaction1 );
     }
+
+    m_pendingTransactions.insert( transaction1 );
   }
 
 
@@ -324,6 +322,45 @@ void FlowProfile::recomputeLevels(InstantId prev, InstantId inst) {
                 0, 0, 0, 0 );
 }
 
+void FlowProfile::getViolationExplanation(const InstantId inst, const Resource::ProblemType problem,
+                                          std::vector<TransactionId>& results) {
+  if(problem != Resource::LevelTooLow && problem != Resource::LevelTooHigh) {
+    Profile::getViolationExplanation(inst, problem, results);
+    return;
+  }
+
+  // a level too low is one the upper envelope can't reach, and producers are what raise it
+  const bool lowerLevel = (problem == Resource::LevelTooHigh);
+  std::set<TransactionId> counted;
+  const bool cut = getCountedTransactions(lowerLevel, counted);
+
+  for(std::set<TransactionId>::const_iterator it = m_transactions.begin(); it != m_transactions.end(); ++it) {
+    const TransactionId t = *it;
+    const IntervalIntDomain& time = t->time()->lastDomain();
+    const bool towardsLimit = (t->isConsumer() == lowerLevel);
+
+    if(time.getUpperBound() <= inst->getTime())
+      results.push_back(t);
+    else if(time.getLowerBound() <= inst->getTime()) {
+      if(towardsLimit || !cut || counted.find(t) != counted.end())
+        results.push_back(t);
+    }
+    else if(towardsLimit && t->time()->baseDomain().getLowerBound() <= inst->getTime())
+      results.push_back(t);
+  }
+
+  debugMsg("FlowProfile:getViolationExplanation",
+           (lowerLevel ? "Lower" : "Upper") << " level at " << inst->getTime() << " explained by " <<
+           results.size() << " transactions" << (cut ? "" : ", the pending ones all included"));
+}
+
+bool FlowProfile::getCountedTransactions(const bool lowerLevel, std::set<TransactionId>& results) const {
+  // a level that wasn't recalculated was left as it was, and the graph with it
+  if(lowerLevel)
+    return m_recalculateLowerLevel && m_lowerLevelGraph->getReachableTransactions(results);
+  return m_recalculateUpperLevel && m_upperLevelGraph->getReachableTransactions(results);
+}
+
 Order FlowProfile::getOrdering( const TransactionId t1, const TransactionId t2 )
     {
       // in case constraint added and already constrained to be before or after we no longer have to
@@ -386,7 +423,9 @@ Order FlowProfile::getOrdering( const TransactionId t1, const TransactionId t2 )
 	}
       else
 	{
+	  MutexGrabber grabber(temporalDistanceMutex());
 	  const IntervalIntDomain distance = m_planDatabase->getTemporalAdvisor()->getTemporalDistanceDomain( t1->time(), t2->time(), true );
+	  grabber.release();
 
 	  if( distance.getLowerBound() == 0 && distance.getUpperBound() == 0 )
 	    {
@@ -414,6 +453,33 @@ Order FlowProfile::getOrdering( const TransactionId t1, const TransactionId t2 )
       return returnValue;
     }
 
+void FlowProfile::enableOrdering( const TransactionId t1, const TransactionId t2 ) {
+  debugMsg("FlowProfile:enableOrdering",
+           "Determining ordering of pending transaction ("
+           << t1->getId() << ") "
+           << t1->time()->toString() <<
+           " and pending transaction ("
+           << t2->getId() << ") "
+           << t2->time()->toString() );
+
+  Order order = getOrdering( t1, t2 );
+
+  if( STRICTLY_AT == order )
+  {
+    handleOrderedAt( t1, t2 );
+  }
+  else if( BEFORE_OR_AT == order )
+  {
+    handleOrderedAtOrBefore( t1, t2 );
+  }
+  else
+  {
+    debugMsg("FlowProfile:enableOrdering","Transaction ("
+             << t1->getId() << ") and Transaction ("
+             << t2->getId() << ") not constrained");
+  }
+}
+
     void FlowProfile::handleOrderedAt( const TransactionId t1, const TransactionId t2 )
     {
       check_error(t1.isValid());
@@ -474,10 +540,7 @@ void FlowProfile::handleTransactionAdded(const TransactionId t) {
   // startRecalculation = MINUS_INFINITY;
   endRecalculation = PLUS_INFINITY;
 
-  if( ProfileIteratorId::noId() != m_recomputeInterval )
-    delete static_cast<ProfileIterator*>(m_recomputeInterval);
-
-  m_recomputeInterval = (new ProfileIterator( getId(), startRecalculation, endRecalculation ))->getId();
+  resetRecomputeInterval(startRecalculation, endRecalculation);
 
   m_previousTimeBounds[ t ] =
       std::make_pair(static_cast<eint>(t->time()->lastDomain().getLowerBound()),
@@ -507,6 +570,7 @@ void FlowProfile::handleTransactionRemoved( const TransactionId t ) {
 
   m_lowerLevelContribution.erase( t );
   m_upperLevelContribution.erase( t );
+  m_pendingTransactions.erase( t );
 
   eint startRecalculation = PLUS_INFINITY;
   eint endRecalculation = MINUS_INFINITY;
@@ -523,10 +587,7 @@ void FlowProfile::handleTransactionRemoved( const TransactionId t ) {
 
   endRecalculation = PLUS_INFINITY;
 
-  if(m_recomputeInterval.isValid())
-    delete static_cast<ProfileIterator*>(m_recomputeInterval);
-
-  m_recomputeInterval = (new ProfileIterator( getId(), startRecalculation, endRecalculation ))->getId();
+  resetRecomputeInterval(startRecalculation, endRecalculation);
 
   m_previousTimeBounds.erase( t );
 }
@@ -592,10 +653,7 @@ void FlowProfile::handleTransactionTimeChanged(const TransactionId t,
       break;
   };
 
-  if(m_recomputeInterval.isValid())
-    delete static_cast<ProfileIterator*>(m_recomputeInterval);
-
-  m_recomputeInterval = (new ProfileIterator( getId(), startRecalculation, endRecalculation ))->getId();
+  resetRecomputeInterval(startRecalculation, endRecalculation);
 
   debugMsg("FlowProfile:handleTransactionTimeChanged","TransactionId (" << t->getId() << ") change " << type );
 }
@@ -672,10 +730,7 @@ void FlowProfile::handleTransactionQuantityChanged(const TransactionId t,
     endRecalculation = static_cast<eint>(t->time()->lastDomain().getUpperBound());
   }
 
-  if(m_recomputeInterval.isValid())
-    delete static_cast<ProfileIterator*>(m_recomputeInterval);
-
-  m_recomputeInterval = (new ProfileIterator( getId(), startRecalculation, endRecalculation ))->getId();
+  resetRecomputeInterval(startRecalculation, endRecalculation);
 
   debugMsg("FlowProfile:handleTransactionQuantityChanged","TransactionId (" << t->getId() << ") change " << type << " to " << t->quantity()->toString() );
 }
@@ -713,10 +768,7 @@ void FlowProfile::handleTemporalConstraintAdded(const TransactionId predecessor,
                      static_cast<eint>(successor->time()->lastDomain().getUpperBound()));
       }
 
-      if(m_recomputeInterval.isValid())
-        delete static_cast<ProfileIterator*>(m_recomputeInterval);
-
-      m_recomputeInterval = (new ProfileIterator( getId(), startRecalculation, endRecalculation ))->getId();
+      resetRecomputeInterval(startRecalculation, endRecalculation);
 
       m_recalculateLowerLevel = true;
       m_recalculateUpperLevel = true;
@@ -763,11 +815,7 @@ void FlowProfile::handleTemporalConstraintRemoved(const TransactionId predecesso
   }
 
 
-  if(m_recomputeInterval.isValid())
-    delete static_cast<ProfileIterator*>(m_recomputeInterval);
-
-  m_recomputeInterval = 
-      (new ProfileIterator( getId(), startRecalculation, endRecalculation ))->getId();
+  resetRecomputeInterval(startRecalculation, endRecalculation);
 
   m_recalculateLowerLevel = true;
   m_recalculateUpperLevel = true;
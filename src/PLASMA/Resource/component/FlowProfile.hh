@@ -110,6 +110,11 @@ private:
 
  protected:
   virtual void postHandleRecompute(const eint& endTime, const std::pair<edouble,edouble>& endDiff);
+  /**
+   * @brief Replaces the graphs for the lower and upper level by empty ones of the type this profile
+   * solves the maximum flow problems with.
+   */
+  virtual void resetGraphs();
   /**
    * @brief Enables a transaction t. A transaction is enabled a time T to calculate the
    * envelopes for instant at time T if the lower bound of the time equals T (this is assuming
@@ -141,6 +146,10 @@ private:
    * @brief Updates the maximum flow graphs in case transactions t1 and t2 are now weakly ordered.
    */
   void handleOrderedAtOrBefore( const TransactionId t1, const TransactionId t2 );
+  /**
+   * @brief Adds the edges for the ordering of \a t1 relative to \a t2 to the maximum flow graphs.
+   */
+  void enableOrdering( const TransactionId t1, const TransactionId t2 );
 
   void handleTransactionAdded( const TransactionId t);
   void handleTransactionRemoved( const TransactionId t);
@@ -152,6 +161,20 @@ private:
   void initRecompute();
   Order getOrdering( const TransactionId t1, const TransactionId t2 );
   void recomputeLevels(InstantId prev, InstantId inst);
+  /**
+   * @brief Explains a level out of its limits with what the envelope on the far side of it is made
+   * of: the closed transactions, the pending ones it counts (the source side of the minimum cut),
+   * the pending ones that would move it towards the limit, and those of the latter restricted to
+   * happen later.  A pending transaction it leaves out can only matter through an ordering with one
+   * of these.
+   */
+  void getViolationExplanation(const InstantId inst, const Resource::ProblemType problem,
+                               std::vector<TransactionId>& results);
+  /**
+   * @brief Adds to \a results the pending transactions counted by the lower or upper level of the
+   * instant just recomputed. Returns false if they are not known.
+   */
+  virtual bool getCountedTransactions(const bool lowerLevel, std::set<TransactionId>& results) const;
 
   typedef std::pair< eint, eint > IntIntPair;
 #ifdef _MSC_VER
@@ -180,6 +203,12 @@ private:
 
   TransactionId2InstantId m_lowerLevelContribution;
   TransactionId2InstantId m_upperLevelContribution;
+
+  /*!
+   * @brief The pending set of the last instant recomputed. These transactions and their orderings
+   * are in the graphs already, so the next instant only adds the transactions entering the pending set.
+   */
+  std::set<TransactionId> m_pendingTransactions;
 };
 }
 
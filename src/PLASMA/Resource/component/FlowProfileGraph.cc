@@ -17,7 +17,7 @@ FlowProfileGraph::FlowProfileGraph(const TransactionId ,
 
 FlowProfileGraphImpl::FlowProfileGraphImpl(const TransactionId source, 
                                            const TransactionId sink, bool lowerLevel)
-    : FlowProfileGraph(source, sink, lowerLevel), m_maxflow(NULL), m_graph( 0 ),
+    : FlowProfileGraph(source, sink, lowerLevel), m_maxflow(NULL), m_reinitialize(true), m_graph( 0 ),
       m_source( 0 ), m_sink( 0 ) {
   m_graph = new Graph();
   m_source = m_graph->createNode( source );
@@ -144,12 +144,19 @@ void FlowProfileGraphImpl::removeTransaction( const TransactionId id )
 
   m_recalculate = true;
 
+  Node* node = m_graph->getNode( id );
+
+  // keep the flow through the remaining nodes so it can be repaired
+  if( 0 != node && !m_reinitialize )
+    m_maxflow->removeNode( node );
+
   m_graph->removeNode( id );
 }
 
 void FlowProfileGraphImpl::reset()
 {
   m_recalculate = true;
+  m_reinitialize = true;
 
   m_graph->setDisabled();
 
@@ -164,9 +171,13 @@ edouble FlowProfileGraphImpl::getResidualFromSource()
 
   if( m_recalculate )
   {
-    m_maxflow->execute();
+    if( m_reinitialize )
+      m_maxflow->execute();
+    else
+      m_maxflow->repair();
 
     m_recalculate = false;
+    m_reinitialize = false;
   }
 
   EdgeOutIterator ite( *m_source );
@@ -192,6 +203,8 @@ void FlowProfileGraphImpl::disable(  const TransactionId id )
   check_error( 0 != node );
   check_error( node->isEnabled() );
 
+  m_reinitialize = true;
+
   node->setDisabled();
 }
 
@@ -208,6 +221,8 @@ void FlowProfileGraphImpl::pushFlow( const TransactionId id )
              << id->getId() << ") lower level: "
              << std::boolalpha << m_lowerLevel );
 
+    m_reinitialize = true;
+
     m_maxflow->pushFlowBack( node );
   }
   else
@@ -240,6 +255,9 @@ edouble FlowProfileGraphImpl::disableReachableResidualGraph( TransactionId2Insta
 
     m_maxflow->execute();
 
+    // the nodes disabled below keep their flow
+    m_reinitialize = true;
+
     Node2Bool visited;
 
     visited[ m_source ] = true;
@@ -250,6 +268,44 @@ edouble FlowProfileGraphImpl::disableReachableResidualGraph( TransactionId2Insta
   return residual;
 }
 
+bool FlowProfileGraphImpl::getReachableTransactions( std::set<TransactionId>& results ) const
+{
+  if( m_recalculate )
+    return false;
+
+  Node2Bool visited;
+
+  visited[ m_source ] = true;
+  visited[ m_sink ] = true;
+
+  std::vector<Node*> agenda( 1, m_source );
+
+  while( !agenda.empty() )
+  {
+    Node* node = agenda.back();
+
+    agenda.pop_back();
+
+    for( EdgeOutIterator ite( *node ); ite.ok(); ++ite )
+    {
+      Edge* edge = *ite;
+
+      Node* target = edge->getTarget();
+
+      if( false == visited[ target ] && 0 != m_maxflow->getResidual( edge ) )
+      {
+        visited[ target ] = true;
+
+        results.insert( target->getIdentity() );
+
+        agenda.push_back( target );
+      }
+    }
+  }
+
+  return true;
+}
+
 void FlowProfileGraphImpl::visitNeighbors(const Node* node, edouble& residual,
                                       Node2Bool& visited, 
                                       TransactionId2InstantId contributions,
@@ -4,6 +4,8 @@
 
 #include "Types.hh"
 
+#include <set>
+
 namespace EUROPA {
 
 class Graph;
@@ -80,7 +82,8 @@ class FlowProfileGraph
    * @brief Returns the cummulative residual capacity originating from the source.
    *
    * Iterates over all outgoing edges from the source and sums the residual capicity of each
-   * edge. Might trigger a maximum flow (re) calculation if required.
+   * edge. Might trigger a maximum flow (re) calculation if required, which starts from the
+   * previous solution unless the invoking instance was reset.
    */
   virtual edouble getResidualFromSource() = 0;
   virtual edouble getResidualFromSource(const TransactionIdTransactionIdPair2Order& at,
@@ -102,6 +105,12 @@ class FlowProfileGraph
    * node to \a instant.
    */
   virtual edouble disableReachableResidualGraph( TransactionId2InstantId contributions, const InstantId instant  ) = 0;
+  /**
+   * @brief Adds to \a results the transaction of every node reachable from the source in the residual
+   * network: the source side of the minimum cut, the pending transactions the envelope counts as having
+   * happened. Returns false, adding nothing, if the maximum flow is out of date.
+   */
+  virtual bool getReachableTransactions( std::set<TransactionId>& results ) const = 0;
   /**
    * @brief Returns true if the invoking instance calculates the lower level, otherwise returns false which indicates
    * the invoking instance is calculating the upper level.
@@ -159,6 +168,7 @@ private:
   }
 
   edouble disableReachableResidualGraph(TransactionId2InstantId contributions, const InstantId instant);
+  bool getReachableTransactions(std::set<TransactionId>& results) const;
   void removeTransaction(const TransactionId id);
   void reset();
   void restoreFlow();
@@ -169,6 +179,11 @@ private:
   void visitNeighbors( const Node* node, edouble& residual, Node2Bool& visited, TransactionId2InstantId contributions, const InstantId instant  );
 
   MaximumFlowAlgorithm* m_maxflow;
+  /*!
+   * @brief Boolean indicating the maximum flow has to be calculated from scratch rather than
+   * repaired from the previous solution, set after a reset or after flow was pushed back
+   */
+  bool m_reinitialize;
   /*!
    * @brief Bi directional graph datastructure
    */
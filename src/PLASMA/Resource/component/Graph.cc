@@ -91,8 +91,15 @@ Graph::Graph() : m_Nodes() {}
 
     void Graph::createEdge( const NodeIdentity& source, const NodeIdentity& target, edouble capacity, bool enabled )
     {
-      Node* sourceNode = createNode( source );
-      Node* targetNode = createNode( target );
+      // nodes which already exist keep their state, an edge never enables them
+      Node* sourceNode = getNode( source );
+      Node* targetNode = getNode( target );
+
+      if( 0 == sourceNode )
+	sourceNode = createNode( source );
+
+      if( 0 == targetNode )
+	targetNode = createNode( target );
 
       if( 0 != sourceNode && 0 != targetNode )
 	{
@@ -43,7 +43,7 @@ namespace EUROPA
     {
       debugMsg("IncrementalFlowProfile::initRecompute","For instant (" << inst->getId() << ")");
 
-      std::map<eint, InstantId>::iterator it = getGreatestInstant( inst->getTime() - 1 );
+      InstantMap::iterator it = getGreatestInstant( inst->getTime() - 1 );
 
       if( m_instants.end() != it  )
         {
@@ -65,7 +65,7 @@ namespace EUROPA
           m_upperClosedLevel = getInitCapacityUb();
         }
 
-      initializeGraphs<FlowProfileGraphImpl>();
+      resetGraphs();
 
       std::set<TransactionId> enabledLower;
       std::set<TransactionId> enabledUpper;
@@ -205,7 +205,7 @@ namespace EUROPA
 
       debugMsg("IncrementalFlowProfile::initRecompute","");
 
-      initializeGraphs<FlowProfileGraphImpl>();
+      resetGraphs();
 
       // initial level
       m_lowerClosedLevel = getInitCapacityLb();
@@ -23,6 +23,12 @@ namespace EUROPA
       void initRecompute();
       void recomputeLevels( InstantId prev, InstantId inst );
       bool enableOrderings(  const InstantId inst  );
+    protected:
+      /**
+       * @brief Returns false: transactions are taken out of the graphs once they start contributing,
+       * so the graphs no longer tell which ones are counted.
+       */
+      bool getCountedTransactions(const bool, std::set<TransactionId>&) const {return false;}
     private:
       void recomputeLevels( InstantId inst, edouble lowerLevel, edouble upperLevel );
 
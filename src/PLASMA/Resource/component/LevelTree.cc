@@ -0,0 +1,114 @@
+#include "LevelTree.hh"
+
+#include <algorithm>
+
+namespace EUROPA {
+
+LevelTree::LevelTree() : m_nodes(1) {}
+
+void LevelTree::clear() {
+  m_nodes.assign(1, Node());
+}
+
+// computed in unsigned arithmetic so the full range of times doesn't overflow
+LevelTree::Time LevelTree::middle(const Time lo, const Time hi) {
+  typedef unsigned long Unsigned;
+  return static_cast<Time>(static_cast<Unsigned>(lo) +
+                           (static_cast<Unsigned>(hi) - static_cast<Unsigned>(lo)) / 2);
+}
+
+int LevelTree::getChild(const int node, const bool right) {
+  int child = (right ? m_nodes[node].right : m_nodes[node].left);
+  if(child < 0) {
+    child = static_cast<int>(m_nodes.size());
+    m_nodes.push_back(Node());
+    if(right)
+      m_nodes[node].right = child;
+    else
+      m_nodes[node].left = child;
+  }
+  return child;
+}
+
+void LevelTree::add(const eint time, const edouble delta) {
+  check_error(time >= MINUS_INFINITY && time <= PLUS_INFINITY);
+  add(0, cast_basis(MINUS_INFINITY), cast_basis(PLUS_INFINITY), cast_basis(time), delta);
+}
+
+void LevelTree::add(const int node, const Time lo, const Time hi, const Time time,
+                    const edouble delta) {
+  if(time <= lo) {
+    Node& n = m_nodes[node];
+    n.delta += delta;
+    n.min += delta;
+    n.max += delta;
+    return;
+  }
+  const Time mid = middle(lo, hi);
+  if(time <= mid) {
+    // everything right of the middle is covered
+    const int right = getChild(node, true);
+    add(right, mid + 1, hi, mid + 1, delta);
+    add(getChild(node, false), lo, mid, time, delta);
+  }
+  else
+    add(getChild(node, true), mid + 1, hi, time, delta);
+  update(node);
+}
+
+void LevelTree::update(const int node) {
+  Node& n = m_nodes[node];
+  // a missing child has not changed from zero
+  const edouble leftMin = (n.left < 0 ? edouble(0) : m_nodes[n.left].min);
+  const edouble leftMax = (n.left < 0 ? edouble(0) : m_nodes[n.left].max);
+  const edouble rightMin = (n.right < 0 ? edouble(0) : m_nodes[n.right].min);
+  const edouble rightMax = (n.right < 0 ? edouble(0) : m_nodes[n.right].max);
+  n.min = n.delta + std::min(leftMin, rightMin);
+  n.max = n.delta + std::max(leftMax, rightMax);
+}
+
+edouble LevelTree::getMin(const eint start, const eint end) const {
+  checkError(start <= end, "Empty interval [" << start << ", " << end << "]");
+  return getMin(0, cast_basis(MINUS_INFINITY), cast_basis(PLUS_INFINITY),
+                cast_basis(start), cast_basis(end));
+}
+
+edouble LevelTree::getMax(const eint start, const eint end) const {
+  checkError(start <= end, "Empty interval [" << start << ", " << end << "]");
+  return getMax(0, cast_basis(MINUS_INFINITY), cast_basis(PLUS_INFINITY),
+                cast_basis(start), cast_basis(end));
+}
+
+edouble LevelTree::getMin(const int node, const Time lo, const Time hi, const Time start,
+                          const Time end) const {
+  if(node < 0)
+    return 0;
+  const Node& n = m_nodes[node];
+  if(start <= lo && hi <= end)
+    return n.min;
+  const Time mid = middle(lo, hi);
+  if(end <= mid)
+    return n.delta + getMin(n.left, lo, mid, start, end);
+  if(start > mid)
+    return n.delta + getMin(n.right, mid + 1, hi, start, end);
+  return n.delta + std::min(getMin(n.left, lo, mid, start, end),
+                            getMin(n.right, mid + 1, hi, start, end));
+}
+
+edouble LevelTree::getMax(const int node, const Time lo, const Time hi, const Time start,
+                          const Time end) const {
+  if(node < 0)
+    return 0;
+  const Node& n = m_nodes[node];
+  if(start <= lo && hi <= end)
+    return n.max;
+  const Time mid = middle(lo, hi);
+  if(end <= mid)
+    return n.delta + getMax(n.left, lo, mid, start, end);
+  if(start > mid)
+    return n.delta + getMax(n.right, mid + 1, hi, start, end);
+  return n.delta + std::max(getMax(n.left, lo, mid, start, end),
+                            getMax(n.right, mid + 1, hi, start, end));
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef _H_LevelTree
+#define _H_LevelTree
+
+/**
+ * @file LevelTree.hh
+ * @brief Defines a segment tree over time for step functions built from level changes
+ * @ingroup Resource
+ */
+
+#include "ResourceDefs.hh"
+
+#include <vector>
+
+namespace EUROPA {
+
+/**
+ * @brief A segment tree over every time from MINUS_INFINITY to PLUS_INFINITY holding a step
+ * function which starts at zero.
+ *
+ * Adding a change at a time and getting the least or greatest value over an interval both take
+ * O(log T), T being the width of the time range.  Nodes are only allocated along the paths the
+ * changes take, and a change is kept at the highest node it covers completely rather than being
+ * pushed down, so queries add up the changes on the way down.
+ */
+class LevelTree {
+ public:
+  LevelTree();
+
+  /**
+   * @brief Adds \a delta to the value at \a time and at every later time.
+   */
+  void add(const eint time, const edouble delta);
+
+  /**
+   * @brief Returns the least value over [\a start, \a end].
+   */
+  edouble getMin(const eint start, const eint end) const;
+
+  /**
+   * @brief Returns the greatest value over [\a start, \a end].
+   */
+  edouble getMax(const eint start, const eint end) const;
+
+  edouble getValue(const eint time) const { return getMin(time, time); }
+
+  void clear();
+
+  unsigned int getNodeCount() const { return m_nodes.size(); }
+
+ private:
+  typedef eint::basis_type Time;
+
+  struct Node {
+    Node() : delta(0), min(0), max(0), left(-1), right(-1) {}
+    edouble delta; /**< The change applied to every time under the node */
+    edouble min, max; /**< The bounds under the node, including delta */
+    int left, right;
+  };
+
+  static Time middle(const Time lo, const Time hi);
+
+  int getChild(const int node, const bool right);
+  void add(const int node, const Time lo, const Time hi, const Time time, const edouble delta);
+  void update(const int node);
+  edouble getMin(const int node, const Time lo, const Time hi, const Time start, const Time end) const;
+  edouble getMax(const int node, const Time lo, const Time hi, const Time start, const Time end) const;
+
+  std::vector<Node> m_nodes; /**< The root is the first node */
+};
+
+}
+
+#endif
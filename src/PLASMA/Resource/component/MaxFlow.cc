@@ -13,6 +13,8 @@
 
 #include "MaxFlow.hh"
 
+#include <vector>
+
 namespace EUROPA
 {
 MaximumFlowAlgorithm::MaximumFlowAlgorithm( Graph* g, Node* source, Node* sink  ):
@@ -72,4 +74,208 @@ EdgeList::const_iterator MaximumFlowAlgorithm::endOutEdgeOnNode(Node* n) const {
   return it->second;
 }
 
+void MaximumFlowAlgorithm::removeNode( Node* node )
+{
+  checkError( 0 != node, "Null not allowed as input for node" );
+
+  // a node that was never part of a flow has no state to clean up
+  if( m_DistanceOnNode.find( node ) == m_DistanceOnNode.end() )
+    return;
+
+  graphDebug("Removing node " << *node << " from the flow");
+
+  // take all flow off the node before cancelling what it sent on, so that cancelling can never
+  // lead back into it. Edges come in pairs, so erasing the entries of the in-edges and their
+  // reverses also erases those of the out-edges; the outgoing flow must be read before that.
+  std::vector< std::pair< Node*, edouble > > outflows;
+
+  EdgeOutIterator outIte( *node, false );
+
+  for( ; outIte.ok(); ++outIte )
+  {
+    Edge* edge = *outIte;
+    Edge2DoubleMap::iterator it = m_OnEdge.find( edge );
+
+    if( it == m_OnEdge.end() )
+      continue;
+
+    if( it->second > 0 )
+    {
+      outflows.push_back( std::make_pair( edge->getTarget(), it->second ) );
+      it->second = 0.0;
+      m_OnEdge[ m_Graph->getEdge( edge->getTarget(), node ) ] = 0.0;
+    }
+  }
+
+  EdgeInIterator inIte( *node, false );
+
+  for( ; inIte.ok(); ++inIte )
+  {
+    Edge* edge = *inIte;
+    Edge2DoubleMap::iterator it = m_OnEdge.find( edge );
+
+    if( it == m_OnEdge.end() )
+      continue;
+
+    if( it->second > 0 )
+      m_ExcessOnNode[ edge->getSource() ] += it->second;
+
+    m_OnEdge.erase( it );
+    m_OnEdge.erase( m_Graph->getEdge( node, edge->getSource() ) );
+  }
+
+  for( std::vector< std::pair< Node*, edouble > >::const_iterator ite = outflows.begin();
+       ite != outflows.end(); ++ite )
+    cancelFlow( ite->first, ite->second );
+
+  m_CurrentOutEdgeOnNode.erase( node );
+  m_EndOutEdgeOnNode.erase( node );
+  m_DistanceOnNode.erase( node );
+  m_ExcessOnNode.erase( node );
+  m_Nodes.remove( node );
+  m_NodeListIterator = m_Nodes.end();
+}
+
+void MaximumFlowAlgorithm::cancelFlow( Node* node, edouble amount )
+{
+  std::vector< std::pair< Node*, edouble > > deficits;
+  deficits.push_back( std::make_pair( node, amount ) );
+
+  while( !deficits.empty() )
+  {
+    Node* n = deficits.back().first;
+    edouble deficit = deficits.back().second;
+    deficits.pop_back();
+
+    edouble excess = getExcess( n );
+
+    if( n == m_Sink || excess >= deficit )
+    {
+      m_ExcessOnNode[ n ] = excess - deficit;
+      continue;
+    }
+
+    // the node now sends on more than it receives, reduce what it
+    // sends on and pass the shortage downstream
+    m_ExcessOnNode[ n ] = 0.0;
+    deficit -= excess;
+
+    EdgeOutIterator ite( *n );
+
+    for( ; ite.ok() && deficit > 0; ++ite )
+    {
+      Edge* edge = *ite;
+      Edge2DoubleMap::const_iterator it = m_OnEdge.find( edge );
+
+      if( it == m_OnEdge.end() )
+        continue;
+
+      edouble flow = it->second;
+
+      if( flow > 0 )
+      {
+        edouble delta = flow < deficit ? flow : deficit;
+
+        m_OnEdge[ edge ] = flow - delta;
+        m_OnEdge[ m_Graph->getEdge( edge->getTarget(), n ) ] = delta - flow;
+
+        deficit -= delta;
+
+        deficits.push_back( std::make_pair( edge->getTarget(), delta ) );
+      }
+    }
+
+    checkError( deficit == 0, "Failed to cancel " << deficit << " flow at node " << *n );
+  }
+}
+
+void MaximumFlowAlgorithm::repair()
+{
+  graphDebug("Start repair " << this);
+
+  checkError( m_Source->isEnabled(),"Source '" << *m_Source << "' is not enabled.");
+  checkError( m_Sink->isEnabled(),"Sink '" << *m_Sink << "' is not enabled." );
+
+  const NodeIdentity2Node& nodes = m_Graph->getNodes();
+
+  NodeIdentity2Node::const_iterator nIte = nodes.begin();
+  NodeIdentity2Node::const_iterator nEnd = nodes.end();
+
+  // the existing flow stays, the distances start over; all internal nodes at distance 1 is a
+  // valid labeling for any preflow which saturates the edges out of the source
+  for( ; nIte != nEnd; ++nIte )
+  {
+    Node* node = (*nIte).second;
+
+    if( !node->isEnabled() )
+      continue;
+
+    if( m_ExcessOnNode.find( node ) == m_ExcessOnNode.end() )
+    {
+      if( node != m_Source && node != m_Sink )
+        m_Nodes.push_back( node );
+
+      m_ExcessOnNode[ node ] = 0.0;
+    }
+
+    m_DistanceOnNode[ node ] = 1;
+
+    m_CurrentOutEdgeOnNode[ node ] = node->getOutEdges().begin();
+    m_EndOutEdgeOnNode[ node ] = node->getOutEdges().end();
+
+    while( m_CurrentOutEdgeOnNode[ node ] != m_EndOutEdgeOnNode[ node ] &&
+           !(*m_CurrentOutEdgeOnNode[ node ])->getTarget()->isEnabled() )
+      ++m_CurrentOutEdgeOnNode[ node ];
+  }
+
+  for( nIte = nodes.begin(); nIte != nEnd; ++nIte )
+  {
+    Node* node = (*nIte).second;
+
+    if( !node->isEnabled() )
+      continue;
+
+    EdgeOutIterator ite( *node );
+
+    for( ; ite.ok(); ++ite )
+    {
+      Edge* edge = *ite;
+      Edge* reverse = m_Graph->getEdge( edge->getTarget(), node );
+
+      checkError( 0 != reverse && reverse->isEnabled(),
+                  "No (enabled) reverse edge for edge '" << *edge << "'");
+
+      Edge2DoubleMap::iterator it = m_OnEdge.find( edge );
+
+      if( it == m_OnEdge.end() )
+      {
+        Edge2DoubleMap::const_iterator reverseIt = m_OnEdge.find( reverse );
+
+        it = m_OnEdge.insert( std::make_pair( edge, reverseIt == m_OnEdge.end() ?
+                                              edouble(0.0) : -reverseIt->second ) ).first;
+        m_OnEdge[ reverse ] = - it->second;
+      }
+
+      // a capacity may have been lowered below the flow on the edge
+      if( it->second > edge->getCapacity() )
+      {
+        edouble surplus = it->second - edge->getCapacity();
+
+        it->second = edge->getCapacity();
+        m_OnEdge[ reverse ] = - edge->getCapacity();
+        m_ExcessOnNode[ node ] += surplus;
+
+        cancelFlow( edge->getTarget(), surplus );
+      }
+    }
+  }
+
+  initializeSource();
+
+  dischargeAll();
+
+  graphDebug("End repair, max flow: "
+             << getMaxFlow() );
+}
+
 }
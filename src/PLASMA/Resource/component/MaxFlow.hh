@@ -42,6 +42,19 @@ private:
   inline edouble getFlow( Edge* edge ) const;
   inline void pushFlowBack( Node* node );
   inline edouble getResidual( Edge* edge ) const;
+  /**
+   * @brief Takes the flow through \a node out of the current solution and forgets about the node
+   * and its edges. Must be invoked before the node is removed from the graph.
+   *
+   * Flow coming in to the node is returned to where it came from as excess, flow leaving the node
+   * is cancelled along its path to the sink. Call repair() to restore a maximum flow.
+   */
+  void removeNode( Node* node );
+  /**
+   * @brief Restores a maximum flow after nodes and edges were added, capacities were changed or
+   * nodes were removed through removeNode(), starting from the current flow rather than from zero.
+   */
+  void repair();
  private:
 
   eint distanceOnNode(Node* n) const;
@@ -52,6 +65,9 @@ private:
 
    inline void disCharge( Node* node );
    inline void initializePre( bool reset = true );
+   inline void initializeSource();
+   inline void dischargeAll();
+   void cancelFlow( Node* node, edouble amount );
    inline bool isAdmissible( Edge* edge ) const;
    inline void push( Edge* edge );
    inline void reLabel( Node* n );
@@ -146,6 +162,14 @@ private:
 
    initializePre( reset );
 
+   dischargeAll();
+
+   graphDebug("End execute, max flow: "
+              << getMaxFlow() );
+ }
+
+ void MaximumFlowAlgorithm::dischargeAll()
+ {
    Node* n = getNextInList();
 
    while( n != NULL )
@@ -161,9 +185,6 @@ private:
 
      n = getNextInList();
    }
-
-   graphDebug("End execute, max flow: "
-              << getMaxFlow() );
  }
 
  void MaximumFlowAlgorithm::initializePre( bool reset )
@@ -245,6 +266,13 @@ private:
     }
   }
 
+  initializeSource();
+
+  graphDebug("End initializePre");
+}
+
+void MaximumFlowAlgorithm::initializeSource()
+{
   m_DistanceOnNode[ m_Sink ] = 0;
   m_DistanceOnNode[ m_Source ] = static_cast<long>(m_Nodes.size());
 
@@ -289,8 +317,6 @@ private:
 
     }
   }
-
-  graphDebug("End initializePre");
 }
 
 void MaximumFlowAlgorithm::disCharge( Node* node )
@@ -323,13 +349,17 @@ void MaximumFlowAlgorithm::disCharge( Node* node )
 
       ++ite;
 
+      while(ite != endOutEdgeOnNode(node) && !(*ite)->getTarget()->isEnabled())
+        ++ite;
+
+      // edges to disabled nodes may be anywhere in the list, so skip them again after wrapping
       if( ite == endOutEdgeOnNode(node) )
       {
         ite = node->getOutEdges().begin();
-      }
 
-      while(ite != endOutEdgeOnNode(node) && !(*ite)->getTarget()->isEnabled())
-        ++ite;
+        while(ite != endOutEdgeOnNode(node) && !(*ite)->getTarget()->isEnabled())
+          ++ite;
+      }
 
       m_CurrentOutEdgeOnNode[node] = ite;
     }
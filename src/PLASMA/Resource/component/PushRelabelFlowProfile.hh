@@ -0,0 +1,29 @@
+#ifndef _H_PUSH_RELABEL_FLOW_PROFILE
+#define _H_PUSH_RELABEL_FLOW_PROFILE
+#include "FlowProfile.hh"
+#include "IncrementalFlowProfile.hh"
+#include "PushRelabelFlowProfileGraph.hh"
+namespace EUROPA {
+
+/**
+ * @brief A FlowProfile or IncrementalFlowProfile which computes the envelopes with
+ * PushRelabelFlowProfileGraph.
+ */
+template<typename ProfileType>
+class PushRelabelProfile : public ProfileType {
+ public:
+  PushRelabelProfile(const PlanDatabaseId db, const FVDetectorId flawDetector)
+      : ProfileType(db, flawDetector) {
+    resetGraphs();
+  }
+ protected:
+  void resetGraphs() {
+    this->template initializeGraphs<EUROPA::PushRelabelFlowProfileGraph>();
+  }
+};
+
+typedef PushRelabelProfile<FlowProfile> PushRelabelFlowProfile;
+typedef PushRelabelProfile<IncrementalFlowProfile> PushRelabelIncrementalFlowProfile;
+}
+
+#endif
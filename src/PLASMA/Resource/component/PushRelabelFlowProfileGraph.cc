@@ -0,0 +1,207 @@
+#include "PushRelabelFlowProfileGraph.hh"
+
+#include "ConstrainedVariable.hh"
+#include "Debug.hh"
+#include "Domain.hh"
+#include "Edge.hh"
+#include "Instant.hh"
+#include "Transaction.hh"
+
+namespace EUROPA {
+
+PushRelabelFlowProfileGraph::PushRelabelFlowProfileGraph(const TransactionId source,
+                                                         const TransactionId sink,
+                                                         bool lowerLevel)
+    : FlowProfileGraph(source, sink, lowerLevel), m_maxflow(), m_nodes(), m_transactions(2) {
+  m_transactions[PushRelabelMaxFlow::getSource()] = source;
+  m_transactions[PushRelabelMaxFlow::getSink()] = sink;
+}
+
+unsigned int PushRelabelFlowProfileGraph::addNode(const TransactionId t) {
+  std::map<TransactionId, unsigned int>::const_iterator it = m_nodes.find(t);
+
+  if(it != m_nodes.end()) {
+    m_maxflow.enableNode(it->second);
+    return it->second;
+  }
+
+  const unsigned int node = m_maxflow.addNode();
+
+  if(node >= m_transactions.size())
+    m_transactions.resize(node + 1);
+
+  m_transactions[node] = t;
+  m_nodes.insert(std::make_pair(t, node));
+  return node;
+}
+
+unsigned int PushRelabelFlowProfileGraph::getNode(const TransactionId t) const {
+  std::map<TransactionId, unsigned int>::const_iterator it = m_nodes.find(t);
+  return it == m_nodes.end() ? PushRelabelMaxFlow::getSource() : it->second;
+}
+
+void PushRelabelFlowProfileGraph::enableAt(const TransactionId t1, const TransactionId t2) {
+  debugMsg("PushRelabelFlowProfileGraph:enableAt", "Transaction " << t1 << " and transaction "
+           << t2 << " lower level: " << std::boolalpha << m_lowerLevel);
+
+  if(m_nodes.find(t1) == m_nodes.end() || m_nodes.find(t2) == m_nodes.end())
+    return;
+
+  m_recalculate = true;
+
+  m_maxflow.setCapacity(getNode(t1), getNode(t2), Edge::getMaxCapacity(), Edge::getMaxCapacity());
+}
+
+void PushRelabelFlowProfileGraph::enableAtOrBefore(const TransactionId t1, const TransactionId t2) {
+  debugMsg("PushRelabelFlowProfileGraph:enableAtOrBefore", "Transaction " << t1 << " and transaction "
+           << t2 << " lower level: " << std::boolalpha << m_lowerLevel);
+
+  if(m_nodes.find(t1) == m_nodes.end() || m_nodes.find(t2) == m_nodes.end())
+    return;
+
+  m_recalculate = true;
+
+  m_maxflow.setCapacity(getNode(t1), getNode(t2), 0.0, Edge::getMaxCapacity());
+}
+
+void PushRelabelFlowProfileGraph::enableTransaction(const TransactionId t, const InstantId i,
+                                                    TransactionId2InstantId contributions) {
+  debugMsg("PushRelabelFlowProfileGraph:enableTransaction", "Transaction (" << t->getId() << ") "
+           << t->time()->toString() << " lower level: " << std::boolalpha << m_lowerLevel);
+
+  const bool fromSource = (m_lowerLevel && t->isConsumer()) || (!m_lowerLevel && !t->isConsumer());
+
+  const edouble capacity = fromSource ? t->quantity()->lastDomain().getUpperBound() :
+      t->quantity()->lastDomain().getLowerBound();
+
+  if(0 == capacity) {
+    debugMsg("PushRelabelFlowProfileGraph:enableTransaction", "Transaction " << t
+             << " starts contributing at " << i->getTime() << " lower level "
+             << std::boolalpha << m_lowerLevel);
+
+    contributions[t] = i;
+
+    return;
+  }
+
+  m_recalculate = true;
+
+  const unsigned int node = addNode(t);
+
+  if(fromSource)
+    m_maxflow.setCapacity(PushRelabelMaxFlow::getSource(), node, capacity, 0.0);
+  else
+    m_maxflow.setCapacity(node, PushRelabelMaxFlow::getSink(), capacity, 0.0);
+}
+
+bool PushRelabelFlowProfileGraph::isEnabled(const TransactionId t) const {
+  const unsigned int node = getNode(t);
+  return node != PushRelabelMaxFlow::getSource() && m_maxflow.isEnabled(node);
+}
+
+void PushRelabelFlowProfileGraph::disable(const TransactionId t) {
+  debugMsg("PushRelabelFlowProfileGraph:disable", "Transaction (" << t->getId()
+           << ") lower level: " << std::boolalpha << m_lowerLevel);
+
+  check_error(isEnabled(t));
+
+  m_maxflow.disableNode(getNode(t));
+}
+
+void PushRelabelFlowProfileGraph::pushFlow(const TransactionId t) {
+  check_error(isEnabled(t));
+
+  if(!m_recalculate) {
+    debugMsg("PushRelabelFlowProfileGraph:pushFlow", "Transaction (" << t->getId()
+             << ") lower level: " << std::boolalpha << m_lowerLevel);
+
+    m_maxflow.returnFlow(getNode(t));
+  }
+}
+
+void PushRelabelFlowProfileGraph::restoreFlow() {
+  m_maxflow.solve();
+}
+
+edouble PushRelabelFlowProfileGraph::getResidualFromSource() {
+  if(m_recalculate) {
+    m_maxflow.solve();
+    m_recalculate = false;
+  }
+
+  return m_maxflow.getResidualFromSource();
+}
+
+edouble PushRelabelFlowProfileGraph::disableReachableResidualGraph(TransactionId2InstantId contributions,
+                                                                   const InstantId instant) {
+  debugMsg("PushRelabelFlowProfileGraph:disableReachableResidualGraph", "Lower level: "
+           << std::boolalpha << m_lowerLevel);
+
+  edouble residual = 0.0;
+
+  if(!m_recalculate)
+    return residual;
+
+  m_maxflow.solve();
+
+  std::vector<unsigned int> reachable;
+  m_maxflow.getReachableFromSource(reachable);
+
+  for(std::vector<unsigned int>::const_iterator it = reachable.begin(); it != reachable.end(); ++it) {
+    const TransactionId t = m_transactions[*it];
+
+    debugMsg("PushRelabelFlowProfileGraph:disableReachableResidualGraph", "Transaction " << t
+             << " starts contributing at " << instant->getTime() << " lower level "
+             << std::boolalpha << m_lowerLevel);
+
+    m_maxflow.disableNode(*it);
+    contributions[t] = instant;
+
+    const int sign = t->isConsumer() ? -1 : +1;
+
+    if((m_lowerLevel && t->isConsumer()) || (!m_lowerLevel && !t->isConsumer()))
+      residual += sign * t->quantity()->lastDomain().getUpperBound();
+    else
+      residual += sign * t->quantity()->lastDomain().getLowerBound();
+  }
+
+  return residual;
+}
+
+bool PushRelabelFlowProfileGraph::getReachableTransactions(std::set<TransactionId>& results) const {
+  if(m_recalculate)
+    return false;
+
+  std::vector<unsigned int> reachable;
+  m_maxflow.getReachableFromSource(reachable);
+
+  for(std::vector<unsigned int>::const_iterator it = reachable.begin(); it != reachable.end(); ++it)
+    results.insert(m_transactions[*it]);
+
+  return true;
+}
+
+void PushRelabelFlowProfileGraph::removeTransaction(const TransactionId id) {
+  debugMsg("PushRelabelFlowProfileGraph:removeTransaction", "Transaction (" << id->getId()
+           << ") lower level: " << std::boolalpha << m_lowerLevel);
+
+  m_recalculate = true;
+
+  std::map<TransactionId, unsigned int>::iterator it = m_nodes.find(id);
+
+  if(it == m_nodes.end())
+    return;
+
+  m_maxflow.removeNode(it->second);
+  m_transactions[it->second] = TransactionId::noId();
+  m_nodes.erase(it);
+}
+
+void PushRelabelFlowProfileGraph::reset() {
+  m_recalculate = true;
+  m_maxflow.reset();
+  m_nodes.clear();
+  m_transactions.resize(2);
+}
+
+}
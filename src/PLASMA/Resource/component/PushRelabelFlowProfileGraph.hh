@@ -0,0 +1,58 @@
+#ifndef _H_PushRelabelFlowProfileGraph
+#define _H_PushRelabelFlowProfileGraph
+
+#include "FlowProfileGraph.hh"
+#include "PushRelabelMaxFlow.hh"
+#include "Types.hh"
+
+#include <map>
+#include <vector>
+
+namespace EUROPA {
+
+/**
+ * @brief FlowProfileGraph which numbers the transactions densely and solves the maximum flow
+ * problem with PushRelabelMaxFlow. See FlowProfileGraph for the semantics of each operation.
+ */
+class PushRelabelFlowProfileGraph : public FlowProfileGraph {
+ private:
+  PushRelabelFlowProfileGraph(const PushRelabelFlowProfileGraph&);
+  PushRelabelFlowProfileGraph& operator=(const PushRelabelFlowProfileGraph&);
+ public:
+  PushRelabelFlowProfileGraph(const TransactionId source, const TransactionId sink, bool lowerLevel);
+  ~PushRelabelFlowProfileGraph() {}
+  void enableAt(const TransactionId t1, const TransactionId t2);
+  void enableAtOrBefore(const TransactionId t1, const TransactionId t2);
+  void enableTransaction(const TransactionId transaction, const InstantId inst,
+                         TransactionId2InstantId contributions);
+  bool isEnabled(const TransactionId transaction) const;
+  void disable(const TransactionId transaction);
+  void pushFlow(const TransactionId transaction);
+  edouble getResidualFromSource();
+  edouble getResidualFromSource(const TransactionIdTransactionIdPair2Order&,
+                                const TransactionIdTransactionIdPair2Order&) {
+    return getResidualFromSource();
+  }
+  edouble disableReachableResidualGraph(TransactionId2InstantId contributions, const InstantId instant);
+  bool getReachableTransactions(std::set<TransactionId>& results) const;
+  void removeTransaction(const TransactionId id);
+  void reset();
+  void restoreFlow();
+ private:
+  /**
+   * @brief Returns the node for \a t, creating it if needed, and enables it.
+   */
+  unsigned int addNode(const TransactionId t);
+  /**
+   * @brief Returns the node for \a t, or PushRelabelMaxFlow::getSource() if there is none.
+   */
+  unsigned int getNode(const TransactionId t) const;
+
+  PushRelabelMaxFlow m_maxflow;
+  std::map<TransactionId, unsigned int> m_nodes;
+  std::vector<TransactionId> m_transactions; /*!< Transaction of each node */
+};
+
+}
+
+#endif
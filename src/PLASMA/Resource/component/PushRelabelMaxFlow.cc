@@ -0,0 +1,449 @@
+#include "PushRelabelMaxFlow.hh"
+
+#include "Debug.hh"
+#include "Error.hh"
+
+#include <algorithm>
+
+namespace EUROPA {
+
+const unsigned int PushRelabelMaxFlow::NONE;
+
+PushRelabelMaxFlow::PushRelabelMaxFlow()
+    : m_enabled(), m_excess(), m_label(), m_current(), m_first(), m_nextActive(),
+      m_outArcs(), m_freeNodes(), m_head(), m_capacity(), m_flow(), m_freeArcs(),
+      m_arcIndex(), m_active(), m_labelCount(), m_adjacent(), m_deficits(),
+      m_highest(0), m_relabels(0), m_adjacencyChanged(true) {
+  addNode();
+  addNode();
+}
+
+unsigned int PushRelabelMaxFlow::addNode() {
+  unsigned int node;
+
+  if(!m_freeNodes.empty()) {
+    node = m_freeNodes.back();
+    m_freeNodes.pop_back();
+  }
+  else {
+    node = static_cast<unsigned int>(m_enabled.size());
+    m_enabled.push_back(false);
+    m_excess.push_back(0.0);
+    m_label.push_back(0);
+    m_current.push_back(0);
+    m_nextActive.push_back(NONE);
+    m_outArcs.push_back(std::vector<unsigned int>());
+  }
+
+  m_enabled[node] = true;
+  m_excess[node] = 0.0;
+  m_adjacencyChanged = true;
+  return node;
+}
+
+void PushRelabelMaxFlow::removeNode(unsigned int node) {
+  checkError(isInternal(node), "Cannot remove the source or the sink");
+
+  if(m_enabled[node])
+    returnFlow(node);
+
+  freeArcs(node);
+  m_enabled[node] = false;
+  m_freeNodes.push_back(node);
+  m_adjacencyChanged = true;
+}
+
+void PushRelabelMaxFlow::enableNode(unsigned int node) {
+  if(m_enabled[node])
+    return;
+
+  m_enabled[node] = true;
+  m_excess[node] = 0.0;
+  m_adjacencyChanged = true;
+}
+
+void PushRelabelMaxFlow::disableNode(unsigned int node) {
+  checkError(isInternal(node), "Cannot disable the source or the sink");
+
+  if(!m_enabled[node])
+    return;
+
+  returnFlow(node);
+  m_enabled[node] = false;
+  m_adjacencyChanged = true;
+}
+
+void PushRelabelMaxFlow::addFlow(unsigned int arc, edouble delta) {
+  m_flow[arc] += delta;
+  m_flow[arc ^ 1] -= delta;
+  m_excess[m_head[arc ^ 1]] -= delta;
+  m_excess[m_head[arc]] += delta;
+}
+
+void PushRelabelMaxFlow::returnFlow(unsigned int node) {
+  const std::vector<unsigned int>& arcs = m_outArcs[node];
+
+  for(std::vector<unsigned int>::const_iterator it = arcs.begin(); it != arcs.end(); ++it) {
+    const unsigned int arc = *it;
+    const edouble flow = m_flow[arc];
+
+    if(flow == 0)
+      continue;
+
+    addFlow(arc, -flow);
+
+    if(flow > 0 && isInternal(m_head[arc]))
+      m_deficits.push_back(m_head[arc]);
+  }
+
+  m_excess[node] = 0.0;
+  cancelDeficits();
+}
+
+void PushRelabelMaxFlow::cancelDeficits() {
+  while(!m_deficits.empty()) {
+    const unsigned int node = m_deficits.back();
+    m_deficits.pop_back();
+
+    const std::vector<unsigned int>& arcs = m_outArcs[node];
+
+    for(std::vector<unsigned int>::const_iterator it = arcs.begin();
+        it != arcs.end() && m_excess[node] < 0; ++it) {
+      const unsigned int arc = *it;
+
+      if(m_flow[arc] > 0) {
+        const edouble delta = m_flow[arc] < -m_excess[node] ? m_flow[arc] : -m_excess[node];
+
+        addFlow(arc, -delta);
+
+        if(isInternal(m_head[arc]) && m_excess[m_head[arc]] < 0)
+          m_deficits.push_back(m_head[arc]);
+      }
+    }
+
+    checkError(!(m_excess[node] < 0), "Failed to cancel the flow leaving node " << node);
+  }
+}
+
+void PushRelabelMaxFlow::freeArcs(unsigned int node) {
+  std::vector<unsigned int>& arcs = m_outArcs[node];
+
+  for(std::vector<unsigned int>::const_iterator it = arcs.begin(); it != arcs.end(); ++it) {
+    const unsigned int arc = *it;
+    const unsigned int other = m_head[arc];
+
+    std::vector<unsigned int>& otherArcs = m_outArcs[other];
+    std::vector<unsigned int>::iterator reverse =
+        std::find(otherArcs.begin(), otherArcs.end(), arc ^ 1);
+    check_error(reverse != otherArcs.end());
+    *reverse = otherArcs.back();
+    otherArcs.pop_back();
+
+    m_arcIndex.erase(std::make_pair(std::min(node, other), std::max(node, other)));
+
+    m_head[arc] = m_head[arc ^ 1] = NONE;
+    m_capacity[arc] = m_capacity[arc ^ 1] = 0.0;
+    m_flow[arc] = m_flow[arc ^ 1] = 0.0;
+    m_freeArcs.push_back(arc & ~1u);
+  }
+
+  arcs.clear();
+}
+
+void PushRelabelMaxFlow::setCapacity(unsigned int from, unsigned int to,
+                                     edouble capacity, edouble reverseCapacity) {
+  checkError(from != to, "No arc from node " << from << " to itself");
+
+  const std::pair<unsigned int, unsigned int> key(std::min(from, to), std::max(from, to));
+  std::map<std::pair<unsigned int, unsigned int>, unsigned int>::const_iterator it =
+      m_arcIndex.find(key);
+
+  unsigned int arc;
+
+  if(it != m_arcIndex.end()) {
+    arc = it->second;
+  }
+  else {
+    if(!m_freeArcs.empty()) {
+      arc = m_freeArcs.back();
+      m_freeArcs.pop_back();
+    }
+    else {
+      arc = static_cast<unsigned int>(m_head.size());
+      m_head.resize(arc + 2);
+      m_capacity.resize(arc + 2, 0.0);
+      m_flow.resize(arc + 2, 0.0);
+    }
+
+    m_head[arc] = key.second;
+    m_head[arc ^ 1] = key.first;
+    m_outArcs[key.first].push_back(arc);
+    m_outArcs[key.second].push_back(arc ^ 1);
+    m_arcIndex.insert(std::make_pair(key, arc));
+    m_adjacencyChanged = true;
+  }
+
+  if(from != key.first)
+    arc ^= 1;
+
+  m_capacity[arc] = capacity;
+  m_capacity[arc ^ 1] = reverseCapacity;
+
+  // flow over the capacity goes back to the tail and is cancelled beyond the head
+  for(unsigned int i = 0; i < 2; ++i, arc ^= 1) {
+    if(m_flow[arc] > m_capacity[arc]) {
+      addFlow(arc, m_capacity[arc] - m_flow[arc]);
+
+      if(isInternal(m_head[arc]))
+        m_deficits.push_back(m_head[arc]);
+    }
+  }
+}
+
+void PushRelabelMaxFlow::reset() {
+  const unsigned int nodeCount = static_cast<unsigned int>(m_enabled.size());
+
+  m_freeNodes.clear();
+
+  // free from the back so that addNode() hands out the lowest indices first
+  for(unsigned int node = nodeCount; node-- > 0;) {
+    m_enabled[node] = !isInternal(node);
+    m_excess[node] = 0.0;
+    m_outArcs[node].clear();
+
+    if(isInternal(node))
+      m_freeNodes.push_back(node);
+  }
+
+  m_head.clear();
+  m_capacity.clear();
+  m_flow.clear();
+  m_freeArcs.clear();
+  m_arcIndex.clear();
+  m_deficits.clear();
+  m_adjacencyChanged = true;
+}
+
+void PushRelabelMaxFlow::buildAdjacency() {
+  const unsigned int nodeCount = static_cast<unsigned int>(m_enabled.size());
+
+  m_first.resize(nodeCount + 1);
+  m_adjacent.clear();
+
+  for(unsigned int node = 0; node < nodeCount; ++node) {
+    m_first[node] = static_cast<unsigned int>(m_adjacent.size());
+
+    if(!m_enabled[node])
+      continue;
+
+    const std::vector<unsigned int>& arcs = m_outArcs[node];
+
+    for(std::vector<unsigned int>::const_iterator it = arcs.begin(); it != arcs.end(); ++it)
+      if(m_enabled[m_head[*it]])
+        m_adjacent.push_back(*it);
+  }
+
+  m_first[nodeCount] = static_cast<unsigned int>(m_adjacent.size());
+  m_adjacencyChanged = false;
+}
+
+void PushRelabelMaxFlow::globalRelabel() {
+  const unsigned int nodeCount = static_cast<unsigned int>(m_enabled.size());
+  const unsigned int unreachable = 2 * nodeCount;
+
+  m_label.assign(nodeCount, unreachable);
+  m_labelCount.assign(nodeCount, 0);
+  m_active.assign(unreachable + 1, NONE);
+  m_highest = 0;
+  m_relabels = 0;
+
+  // breadth first over the reversed residual network, first from the sink, then the
+  // nodes which cannot reach the sink anymore from the source
+  std::vector<unsigned int> queue;
+  queue.reserve(nodeCount);
+
+  m_label[getSink()] = 0;
+  queue.push_back(getSink());
+
+  for(unsigned int i = 0; i < queue.size(); ++i) {
+    const unsigned int node = queue[i];
+
+    for(unsigned int k = m_first[node]; k < m_first[node + 1]; ++k) {
+      const unsigned int arc = m_adjacent[k];
+      const unsigned int other = m_head[arc];
+
+      if(m_label[other] == unreachable && other != getSource() && residual(arc ^ 1) > 0) {
+        m_label[other] = m_label[node] + 1;
+        queue.push_back(other);
+      }
+    }
+
+    if(i + 1 == queue.size() && m_label[getSource()] == unreachable) {
+      m_label[getSource()] = nodeCount;
+      queue.push_back(getSource());
+    }
+  }
+
+  for(unsigned int node = 0; node < nodeCount; ++node) {
+    if(!m_enabled[node])
+      continue;
+
+    m_current[node] = m_first[node];
+
+    if(m_label[node] < nodeCount)
+      m_labelCount[m_label[node]]++;
+
+    if(isInternal(node) && m_excess[node] > 0)
+      activate(node);
+  }
+}
+
+void PushRelabelMaxFlow::activate(unsigned int node) {
+  const unsigned int label = m_label[node];
+
+  m_nextActive[node] = m_active[label];
+  m_active[label] = node;
+
+  if(label > m_highest)
+    m_highest = label;
+}
+
+void PushRelabelMaxFlow::solve() {
+  debugMsg("PushRelabelMaxFlow:solve", "Solving over " << m_enabled.size() << " nodes");
+
+  cancelDeficits();
+
+  if(m_adjacencyChanged)
+    buildAdjacency();
+
+  for(unsigned int k = m_first[getSource()]; k < m_first[getSource() + 1]; ++k) {
+    const unsigned int arc = m_adjacent[k];
+    const edouble delta = residual(arc);
+
+    if(delta > 0)
+      addFlow(arc, delta);
+  }
+
+  globalRelabel();
+
+  const unsigned int nodeCount = static_cast<unsigned int>(m_enabled.size());
+
+  for(;;) {
+    while(m_highest > 0 && m_active[m_highest] == NONE)
+      --m_highest;
+
+    const unsigned int node = m_active[m_highest];
+
+    if(node == NONE)
+      break;
+
+    m_active[m_highest] = m_nextActive[node];
+
+    discharge(node);
+
+    if(m_relabels > nodeCount)
+      globalRelabel();
+  }
+
+  debugMsg("PushRelabelMaxFlow:solve", "Maximum flow " << getMaxFlow());
+}
+
+void PushRelabelMaxFlow::discharge(unsigned int node) {
+  while(m_excess[node] > 0) {
+    if(m_current[node] == m_first[node + 1]) {
+      relabel(node);
+      continue;
+    }
+
+    const unsigned int arc = m_adjacent[m_current[node]];
+    const unsigned int other = m_head[arc];
+    const edouble available = residual(arc);
+
+    if(available > 0 && m_label[node] == m_label[other] + 1) {
+      const bool wasActive = m_excess[other] > 0;
+
+      addFlow(arc, m_excess[node] < available ? m_excess[node] : available);
+
+      if(!wasActive && isInternal(other))
+        activate(other);
+    }
+    else {
+      ++m_current[node];
+    }
+  }
+}
+
+void PushRelabelMaxFlow::relabel(unsigned int node) {
+  const unsigned int nodeCount = static_cast<unsigned int>(m_enabled.size());
+  const unsigned int label = m_label[node];
+
+  unsigned int minLabel = 2 * nodeCount;
+
+  for(unsigned int k = m_first[node]; k < m_first[node + 1]; ++k) {
+    const unsigned int arc = m_adjacent[k];
+
+    if(residual(arc) > 0 && m_label[m_head[arc]] + 1 < minLabel)
+      minLabel = m_label[m_head[arc]] + 1;
+  }
+
+  checkError(minLabel < 2 * nodeCount, "No residual capacity leaving active node " << node);
+
+  m_label[node] = minLabel;
+  m_current[node] = m_first[node];
+  ++m_relabels;
+
+  if(minLabel < nodeCount)
+    m_labelCount[minLabel]++;
+
+  if(label < nodeCount && --m_labelCount[label] == 0)
+    gap(label);
+}
+
+void PushRelabelMaxFlow::gap(unsigned int label) {
+  const unsigned int nodeCount = static_cast<unsigned int>(m_enabled.size());
+
+  // nothing above an empty label can reach the sink, so flow there can only go back to the source
+  for(unsigned int node = 0; node < nodeCount; ++node) {
+    if(m_enabled[node] && isInternal(node) && m_label[node] > label && m_label[node] < nodeCount) {
+      m_labelCount[m_label[node]]--;
+      m_label[node] = nodeCount + 1;
+      m_current[node] = m_first[node];
+    }
+  }
+}
+
+edouble PushRelabelMaxFlow::getResidualFromSource() const {
+  edouble result = 0.0;
+
+  const std::vector<unsigned int>& arcs = m_outArcs[getSource()];
+
+  for(std::vector<unsigned int>::const_iterator it = arcs.begin(); it != arcs.end(); ++it)
+    if(m_enabled[m_head[*it]])
+      result += residual(*it);
+
+  return result;
+}
+
+void PushRelabelMaxFlow::getReachableFromSource(std::vector<unsigned int>& nodes) const {
+  std::vector<bool> visited(m_enabled.size(), false);
+  std::vector<unsigned int> queue(1, getSource());
+
+  visited[getSource()] = true;
+  visited[getSink()] = true;
+
+  for(unsigned int i = 0; i < queue.size(); ++i) {
+    const std::vector<unsigned int>& arcs = m_outArcs[queue[i]];
+
+    for(std::vector<unsigned int>::const_iterator it = arcs.begin(); it != arcs.end(); ++it) {
+      const unsigned int other = m_head[*it];
+
+      if(!visited[other] && m_enabled[other] && residual(*it) > 0) {
+        visited[other] = true;
+        queue.push_back(other);
+        nodes.push_back(other);
+      }
+    }
+  }
+}
+
+}
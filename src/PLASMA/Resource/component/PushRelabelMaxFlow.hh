@@ -0,0 +1,127 @@
+#ifndef _H_PushRelabelMaxFlow
+#define _H_PushRelabelMaxFlow
+
+/**
+ * @file PushRelabelMaxFlow.hh
+ * @brief Defines a maximum flow algorithm over dense node and arc indices
+ * @ingroup Resource
+ */
+
+#include "Types.hh"
+
+#include <map>
+#include <vector>
+
+namespace EUROPA {
+
+/**
+ * @brief Highest-label push-relabel maximum flow over contiguous arrays, with global relabelling
+ * and the gap heuristic.
+ *
+ * Nodes and arcs are identified by dense indices which are reused after removal. Arcs come in
+ * pairs, arc a and arc a^1 being each other's reverse, and the flow on an arc is the negation
+ * of the flow on its reverse. The flow is kept between invocations of solve(), so after nodes
+ * or arcs are added only the difference is computed. Flow through a node which is disabled or
+ * removed, or over an arc whose capacity drops below its flow, is cancelled along its path to
+ * the sink before the next solve().
+ *
+ * Node 0 is the source and node 1 is the sink, both are always enabled.
+ */
+class PushRelabelMaxFlow {
+ public:
+  PushRelabelMaxFlow();
+
+  static unsigned int getSource() { return 0; }
+  static unsigned int getSink() { return 1; }
+
+  /**
+   * @brief Returns the index of a new, enabled node.
+   */
+  unsigned int addNode();
+  /**
+   * @brief Cancels the flow through \a node and removes it together with its arcs. The index
+   * may be returned by a later addNode().
+   */
+  void removeNode(unsigned int node);
+  void enableNode(unsigned int node);
+  /**
+   * @brief Cancels the flow through \a node and ignores it and its arcs until it is enabled again.
+   */
+  void disableNode(unsigned int node);
+  bool isEnabled(unsigned int node) const { return m_enabled[node]; }
+  /**
+   * @brief Returns the flow through \a node back where it came from: flow coming in becomes
+   * excess of the nodes it came from, flow going out is cancelled along its path to the sink.
+   */
+  void returnFlow(unsigned int node);
+  /**
+   * @brief Sets the capacity from \a from to \a to and back, creating the pair of arcs if needed.
+   */
+  void setCapacity(unsigned int from, unsigned int to, edouble capacity, edouble reverseCapacity);
+  /**
+   * @brief Removes all arcs and flow and all nodes except for the source and the sink. Their
+   * indices may be returned by later calls to addNode().
+   */
+  void reset();
+  /**
+   * @brief Turns the current flow into a maximum flow.
+   */
+  void solve();
+  edouble getMaxFlow() const { return m_excess[getSink()]; }
+  /**
+   * @brief Returns the sum of the residual capacities of the arcs leaving the source.
+   */
+  edouble getResidualFromSource() const;
+  /**
+   * @brief Appends every node other than the source and the sink which can be reached from the
+   * source in the residual network to \a nodes.
+   */
+  void getReachableFromSource(std::vector<unsigned int>& nodes) const;
+
+ private:
+  static const unsigned int NONE = static_cast<unsigned int>(-1);
+
+  edouble residual(unsigned int arc) const { return m_capacity[arc] - m_flow[arc]; }
+  bool isInternal(unsigned int node) const { return node != getSource() && node != getSink(); }
+
+  void addFlow(unsigned int arc, edouble delta);
+  void freeArcs(unsigned int node);
+  void cancelDeficits();
+  void buildAdjacency();
+  void globalRelabel();
+  void activate(unsigned int node);
+  void discharge(unsigned int node);
+  void relabel(unsigned int node);
+  void gap(unsigned int label);
+
+  // per node
+  std::vector<bool> m_enabled;
+  std::vector<edouble> m_excess;
+  std::vector<unsigned int> m_label;
+  std::vector<unsigned int> m_current; /*!< Position in m_adjacent of the next arc to try */
+  std::vector<unsigned int> m_first; /*!< Arcs of node n are m_adjacent[m_first[n]] up to m_adjacent[m_first[n+1]] */
+  std::vector<unsigned int> m_nextActive;
+  std::vector<std::vector<unsigned int> > m_outArcs; /*!< Arcs by tail, the adjacency is compiled from these */
+  std::vector<unsigned int> m_freeNodes;
+
+  // per arc
+  std::vector<unsigned int> m_head;
+  std::vector<edouble> m_capacity;
+  std::vector<edouble> m_flow;
+  std::vector<unsigned int> m_freeArcs; /*!< Even index of every free pair of arcs */
+  std::map<std::pair<unsigned int, unsigned int>, unsigned int> m_arcIndex; /*!< Arc from the lower to the higher node of each pair */
+
+  // per label
+  std::vector<unsigned int> m_active; /*!< Head of the list of active nodes with each label */
+  std::vector<unsigned int> m_labelCount; /*!< Number of nodes with each label below the node count */
+
+  std::vector<unsigned int> m_adjacent;
+  std::vector<unsigned int> m_deficits; /*!< Nodes which may have negative excess */
+  unsigned int m_highest;
+  unsigned int m_relabels; /*!< Relabels since the last global relabel */
+  bool m_adjacencyChanged;
+};
+
+}
+
+#endif
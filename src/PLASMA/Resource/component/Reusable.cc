@@ -9,6 +9,8 @@
 #include "Token.hh"
 #include "TokenVariable.hh"
 
+#include <algorithm>
+
 namespace EUROPA {
 
 Reusable::Reusable(const PlanDatabaseId planDatabase, const LabelStr& type,
@@ -157,19 +159,19 @@ CBReusable::CBReusable(const PlanDatabaseId planDatabase,
                maxInstConsumption,
                maxConsumption,
                maxConsumption),
-                           m_constraintsToTransactions()
+      m_uses(), m_violations()
 {
 }
 
 CBReusable::CBReusable(const PlanDatabaseId planDatabase, const LabelStr& type,
                        const LabelStr& name, bool open)
-    : Resource(planDatabase, type, name, open), m_constraintsToTransactions()
+    : Resource(planDatabase, type, name, open), m_uses(), m_violations()
 {
 }
 
 CBReusable::CBReusable(const ObjectId parent, const LabelStr& type,
                        const LabelStr& localName, bool open)
-    : Resource(parent, type, localName, open), m_constraintsToTransactions()
+    : Resource(parent, type, localName, open), m_uses(), m_violations()
 {
 }
 
@@ -180,7 +182,7 @@ CBReusable::CBReusable(const ObjectId parent, const LabelStr& type,
   void CBReusable::addToProfile(const ConstraintId gc)
   {
     UsesId c = gc;
-    if(m_constraintsToTransactions.find(c) != m_constraintsToTransactions.end()) {
+    if(inProfile(c)) {
       debugMsg("CBReusable:constraints",
                "Constraint " << c->toString() << " is already in the profile. Ignoring addToProfile().");
       return;
@@ -189,11 +191,10 @@ CBReusable::CBReusable(const ObjectId parent, const LabelStr& type,
     debugMsg("CBReusable:constraints", "Resource :" << toString() << " adding constraint:" << c->toString());
 
     // here's the major difference between Reusable and Reservoir:  always consume the quantity at the start and produce it again at the end
-    TransactionId t1 = c->getTransaction(Uses::START_VAR);
-    TransactionId t2 = c->getTransaction(Uses::END_VAR);
-    addToProfile(t1);
-    addToProfile(t2);
-    m_constraintsToTransactions.insert(std::make_pair(c, std::make_pair(t1, t2)));
+    addToProfile(c->getTransaction(Uses::START_VAR));
+    addToProfile(c->getTransaction(Uses::END_VAR));
+    c->m_index = m_uses.size();
+    m_uses.push_back(c);
 
     debugMsg("CBReusable:constraints","Resource :" << toString() << " added constraint:" << c->toString());
   }
@@ -202,21 +203,42 @@ CBReusable::CBReusable(const ObjectId parent, const LabelStr& type,
   {
     UsesId c = gc;
 
-    if(m_constraintsToTransactions.find(c) == m_constraintsToTransactions.end()) {
+    if(!inProfile(c)) {
       debugMsg("CBReusable:constraints","No Transactions found for :" << c->toString() << " . Ignoring removeFromProfile()");
       return;
     }
 
     debugMsg("CBReusable:constraints","Resource :" << toString() << " removing constraint:" << c->toString());
 
-    std::pair<TransactionId, TransactionId> trans = m_constraintsToTransactions.find(c)->second;
-    removeFromProfile(trans.first);
-    removeFromProfile(trans.second);
-    m_constraintsToTransactions.erase(c);
+    removeFromProfile(c->getTransaction(Uses::START_VAR));
+    removeFromProfile(c->getTransaction(Uses::END_VAR));
+
+    // the last constraint takes the place of the removed one, along with its violations
+    const unsigned int index = c->m_index;
+    const unsigned int last = m_uses.size() - 1;
+    m_uses[index] = m_uses[last];
+    m_uses[index]->m_index = index;
+    m_uses.pop_back();
+    c->m_index = 0;
+    for(ViolationMap::iterator it = m_violations.begin(); it != m_violations.end(); ++it) {
+      std::vector<unsigned int>& uses = it->second.uses;
+      std::vector<unsigned int>::iterator pos = std::lower_bound(uses.begin(), uses.end(), index);
+      if(pos != uses.end() && *pos == index)
+        uses.erase(pos);
+      if(index != last && !uses.empty() && uses.back() == last) {
+        uses.pop_back();
+        uses.insert(std::lower_bound(uses.begin(), uses.end(), index), index);
+      }
+    }
 
     debugMsg("CBReusable:constraints","Resource :" << toString() << " removed constraint:" << c->toString());
   }
 
+  bool CBReusable::inProfile(const UsesId c) const
+  {
+    return c->m_index < m_uses.size() && m_uses[c->m_index] == c;
+  }
+
   void CBReusable::addToProfile(TransactionId t)
   {
     m_profile->addTransaction(t);
@@ -258,24 +280,33 @@ edouble getUb(ConstrainedVariableId v) {
 }
 }
 
-  std::set<UsesId> CBReusable::getConstraintsForInstant(const InstantId instant)
+  std::vector<UsesId> CBReusable::getConstraintsForInstant(const InstantId instant) const
   {
-    std::set<UsesId> retval;
-
-    std::map<UsesId, std::pair<TransactionId, TransactionId> >::const_iterator it = m_constraintsToTransactions.begin();
+    std::vector<UsesId> retval;
 
-    for (;it != m_constraintsToTransactions.end(); ++it) {
-      UsesId c = it->first;
+    for (std::vector<UsesId>::const_iterator it = m_uses.begin(); it != m_uses.end(); ++it) {
+      UsesId c = *it;
       edouble lb = getLb(c->getScope()[Uses::START_VAR]);
       edouble ub = getUb(c->getScope()[Uses::END_VAR]);
       eint t = instant->getTime();
       if ((lb <= t) && (t <= ub))
-        retval.insert(c->getId());
+        retval.push_back(c);
     }
 
     return retval;
   }
 
+  void CBReusable::clearViolations(const UsesId c)
+  {
+    check_error(inProfile(c));
+    for(ViolationMap::iterator it = m_violations.begin(); it != m_violations.end(); ++it) {
+      std::vector<unsigned int>& uses = it->second.uses;
+      std::vector<unsigned int>::iterator pos = std::lower_bound(uses.begin(), uses.end(), c->m_index);
+      if(pos != uses.end() && *pos == c->m_index)
+        uses.erase(pos);
+    }
+  }
+
   void CBReusable::notifyViolated(const InstantId inst, Resource::ProblemType problem)
   {
     check_error(inst.isValid());
@@ -287,28 +318,39 @@ edouble getUb(ConstrainedVariableId v) {
     TransactionId txn = *(inst->getTransactions().begin());
     ConstraintEngineId ce = txn->quantity()->getConstraintEngine(); // TODO: keep track of constraint engine more cleanly?
     if (ce->getAllowViolations()) { // TODO: move this test to the constraint?
-      std::set<UsesId> constraints = getConstraintsForInstant(inst);
-      std::set<UsesId>::const_iterator it = constraints.begin();
+      Violation& violation = m_violations.insert(std::make_pair(inst, Violation(problem))).first->second;
+      violation.problem = problem;
+      std::vector<UsesId> constraints = getConstraintsForInstant(inst);
+      std::vector<UsesId>::const_iterator it = constraints.begin();
       for(;it != constraints.end(); ++it) {
         UsesId c = *it;
-        c->notifyViolated(problem,inst);
+        std::vector<unsigned int>::iterator pos =
+            std::lower_bound(violation.uses.begin(), violation.uses.end(), c->m_index);
+        if (pos == violation.uses.end() || *pos != c->m_index) {
+          violation.uses.insert(pos, c->m_index);
+          c->notifyViolated(problem,inst);
+        }
       }
     }
     else {
-      const_cast<Domain&>(txn->quantity()->lastDomain()).empty();
+      emptyForViolation(inst);
     }
   }
 
   void CBReusable::notifyNoLongerViolated(const InstantId inst)
   {
+    ViolationMap::iterator it = m_violations.find(inst);
+    if (it == m_violations.end())
+      return;
+
     debugMsg("CBReusable:violations", "Received notification of violation removed at time " << inst->getTime());
 
-    std::set<UsesId> constraints = getConstraintsForInstant(inst);
-    std::set<UsesId>::const_iterator it = constraints.begin();
-    for(;it != constraints.end(); ++it) {
-      UsesId c = *it;
-      c->notifyNoLongerViolated(inst);
-    }
+    // only the constraints violated at the time, even if others overlap the instant by now
+    std::vector<unsigned int> uses;
+    uses.swap(it->second.uses);
+    m_violations.erase(it);
+    for(std::vector<unsigned int>::const_iterator index = uses.begin(); index != uses.end(); ++index)
+      m_uses[*index]->notifyNoLongerViolated(inst);
   }
 
   void CBReusable::notifyFlawed(const InstantId inst)
@@ -344,12 +386,12 @@ Uses::Uses(const LabelStr& name,
            const LabelStr& propagatorName,
            const ConstraintEngineId ce,
            const std::vector<ConstrainedVariableId>& scope)
-    : Constraint(name, propagatorName, ce, scope), m_resource(), m_txns(), 
-      m_violationProblems() {
+    : Constraint(name, propagatorName, ce, scope), m_resource(), m_index(0),
+      m_violationCount(0) {
   checkError(scope.size() == 4, "Uses constraint requires resource,qty,start,end");
 
-  m_txns.push_back((new Transaction(scope[Uses::START_VAR], scope[Uses::QTY_VAR], true, getId()))->getId());
-  m_txns.push_back((new Transaction(scope[Uses::END_VAR],   scope[Uses::QTY_VAR], false, getId()))->getId());
+  m_txns[0] = (new Transaction(scope[Uses::START_VAR], scope[Uses::QTY_VAR], true, getId()))->getId();
+  m_txns[1] = (new Transaction(scope[Uses::END_VAR],   scope[Uses::QTY_VAR], false, getId()))->getId();
 
   if(scope[RESOURCE_VAR]->lastDomain().isSingleton()) {
     m_resource = Entity::getTypedEntity<CBReusable>(scope[RESOURCE_VAR]->lastDomain().getSingletonValue());
@@ -379,11 +421,11 @@ Uses::Uses(const LabelStr& name,
     }
 
     // TODO: make sure Resource destructor doesn't get to these first
-    for (unsigned int i=0;i<m_txns.size();i++) {
+    for (unsigned int i=0;i<2;i++) {
       TransactionId txn = m_txns[i];
       delete static_cast<Transaction*>(txn);
+      m_txns[i] = TransactionId::noId();
     }
-    m_txns.clear();
 
     Constraint::handleDiscard();
   }
@@ -429,8 +471,9 @@ bool Uses::canIgnore(const ConstrainedVariableId variable,
   {
     std::ostringstream os;
 
-    std::map<InstantId,Resource::ProblemType>::const_iterator it = m_violationProblems.begin();
-    for(;it != m_violationProblems.end();++it) {
+    std::map<InstantId,Resource::ProblemType> problems = getViolationProblems();
+    std::map<InstantId,Resource::ProblemType>::const_iterator it = problems.begin();
+    for(;it != problems.end();++it) {
       os << Resource::getProblemString(it->second)
          << " for resource " << m_resource->getName().toString()
          << " at instant " << (it->first->getTime());
@@ -439,10 +482,10 @@ bool Uses::canIgnore(const ConstrainedVariableId variable,
     return os.str();
   }
 
-  void Uses::notifyViolated(Resource::ProblemType problem, const InstantId inst)
+  // the instants and problems themselves are kept by the resource
+  void Uses::notifyViolated(Resource::ProblemType, const InstantId)
   {
-    m_violationProblems[inst] = problem;
-    if (m_violationProblems.size() == 1) {
+    if (++m_violationCount == 1) {
       Constraint::notifyViolated();
       debugMsg("Uses:violations", "Marked constraint as violated : " << toString());
     }
@@ -450,14 +493,12 @@ bool Uses::canIgnore(const ConstrainedVariableId variable,
 
   void Uses::notifyNoLongerViolated(const InstantId inst)
   {
-    if (m_violationProblems.find(inst) == m_violationProblems.end()) {
+    if (m_violationCount == 0) {
       debugMsg("Uses:violations", "Unrecognized instant " << inst << " ignoring notifyNoLongerViolated");
       return;
     }
 
-    bool wasViolated = (m_violationProblems.size() > 0);
-    m_violationProblems.erase(inst);
-    if (wasViolated && m_violationProblems.size() == 0) {
+    if (--m_violationCount == 0) {
       Constraint::notifyNoLongerViolated();
       debugMsg("Uses:violations", "Marked constraint as NoLongerViolated : " << toString());
     }
@@ -471,7 +512,9 @@ bool Uses::canIgnore(const ConstrainedVariableId variable,
   // This can be called when variables attached to the constraint are relaxed
   void Uses::notifyNoLongerViolated()
   {
-    m_violationProblems.clear();
+    if (m_resource.isId())
+      m_resource->clearViolations(getId());
+    m_violationCount = 0;
     Constraint::notifyNoLongerViolated();
   }
 
@@ -490,8 +533,16 @@ bool Uses::canIgnore(const ConstrainedVariableId variable,
 	  return m_resource;
   }
 
-  const std::map<InstantId,Resource::ProblemType>& Uses::getViolationProblems() const
+  std::map<InstantId,Resource::ProblemType> Uses::getViolationProblems() const
   {
-	  return m_violationProblems;
+    std::map<InstantId,Resource::ProblemType> problems;
+    if (m_resource.isId()) {
+      CBReusable::ViolationMap::const_iterator it = m_resource->m_violations.begin();
+      for(;it != m_resource->m_violations.end();++it) {
+        if (std::binary_search(it->second.uses.begin(), it->second.uses.end(), m_index))
+          problems.insert(std::make_pair(it->first, it->second.problem));
+      }
+    }
+    return problems;
   }
 }
@@ -65,7 +65,9 @@ namespace EUROPA {
     protected:
       void addToProfile(const ConstraintId c);
       void removeFromProfile(const ConstraintId c);
-      std::set<UsesId> getConstraintsForInstant(const InstantId instant);
+      bool inProfile(const UsesId c) const;
+      std::vector<UsesId> getConstraintsForInstant(const InstantId instant) const;
+      void clearViolations(const UsesId c);
 
       void addToProfile(TransactionId t);
       void removeFromProfile(TransactionId t);
@@ -76,7 +78,19 @@ namespace EUROPA {
       void createTransactions(const TokenId) {}
       void removeTransactions(const TokenId) {}
 
-      std::map<UsesId, std::pair<TransactionId, TransactionId> > m_constraintsToTransactions;
+      /**
+       * @brief The problem at a violated instant, and the sorted indices in m_uses of the Uses
+       * constraints it violates.
+       */
+      struct Violation {
+        Violation(const Resource::ProblemType p) : problem(p), uses() {}
+        Resource::ProblemType problem;
+        std::vector<unsigned int> uses;
+      };
+      typedef std::map<InstantId, Violation> ViolationMap;
+
+      std::vector<UsesId> m_uses; /**< The constraints in the profile, each at its Uses::m_index */
+      ViolationMap m_violations; /**< Only holds violated instants */
 
       friend class Uses;
     };
@@ -103,7 +117,7 @@ namespace EUROPA {
 
       CBReusableId getResource() const;
 
-      const std::map<InstantId,Resource::ProblemType>& getViolationProblems() const;
+      std::map<InstantId,Resource::ProblemType> getViolationProblems() const;
 
     protected:
       virtual void handleDiscard();
@@ -115,8 +129,9 @@ namespace EUROPA {
       virtual void notifyNoLongerViolated(const InstantId inst);
 
       CBReusableId m_resource;
-      std::vector<TransactionId> m_txns;
-      std::map<InstantId,Resource::ProblemType> m_violationProblems; // instant->problem map
+      TransactionId m_txns[2];
+      unsigned int m_index; /**< Position in the m_uses of m_resource, while in its profile */
+      unsigned int m_violationCount; /**< Number of instants of m_resource violated by this constraint */
 
     private:
       virtual bool canIgnore(const ConstrainedVariableId variable,
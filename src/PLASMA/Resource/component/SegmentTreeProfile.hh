@@ -0,0 +1,153 @@
+#ifndef _H_SegmentTreeProfile
+#define _H_SegmentTreeProfile
+
+/**
+ * @file SegmentTreeProfile.hh
+ * @brief Defines timetable profiles which answer level queries from segment trees
+ * @ingroup Resource
+ */
+
+#include "TimetableProfile.hh"
+#include "GroundedProfile.hh"
+#include "LevelTree.hh"
+#include "Transaction.hh"
+#include "ConstrainedVariable.hh"
+#include "Domains.hh"
+
+#include <map>
+#include <set>
+
+namespace EUROPA {
+
+/**
+ * @brief A TimetableProfile or GroundedProfile which also keeps its lower and upper levels in
+ * LevelTrees, so that the level at a time or its bounds over a window are found in O(log T)
+ * without recomputing the profile.
+ *
+ * Each transaction adds a step to the levels at the start and at the end of its time domain, as
+ * the base profile's handleTransactionStart and handleTransactionEnd say.  Transactions which are
+ * added or change are only put into the trees at the next query, and one that is removed is
+ * taken out straight away; either costs O(log T).  Instants, flaws and violations are still
+ * computed by the base profile.
+ */
+template<class ProfileType>
+class SegmentTreeProfile : public ProfileType {
+ public:
+  SegmentTreeProfile(const PlanDatabaseId db, const FVDetectorId flawDetector)
+      : ProfileType(db, flawDetector), m_lowerLevels(), m_upperLevels(), m_steps(), m_changed() {}
+
+  void getLevel(const eint time, IntervalDomain& dest) {
+    edouble lb, ub;
+    getLevelBounds(time, time, lb, ub);
+    IntervalDomain result;
+    result.intersect(lb, ub);
+    dest = result;
+  }
+
+  /**
+   * @brief Gets the least lower level and the greatest upper level over [start, end].
+   */
+  void getLevelBounds(const eint start, const eint end, edouble& lb, edouble& ub) {
+    updateTrees();
+    lb = this->getInitCapacityLb() + m_lowerLevels.getMin(start, end);
+    ub = this->getInitCapacityUb() + m_upperLevels.getMax(start, end);
+  }
+
+ protected:
+  void handleTransactionAdded(const TransactionId t) {
+    ProfileType::handleTransactionAdded(t);
+    m_changed.insert(t);
+  }
+
+  void handleTransactionRemoved(const TransactionId t) {
+    ProfileType::handleTransactionRemoved(t);
+    m_changed.erase(t);
+    removeSteps(t);
+  }
+
+  void handleTransactionTimeChanged(const TransactionId t, const DomainListener::ChangeType& change) {
+    ProfileType::handleTransactionTimeChanged(t, change);
+    m_changed.insert(t);
+  }
+
+  void handleTransactionQuantityChanged(const TransactionId t, const DomainListener::ChangeType& change) {
+    ProfileType::handleTransactionQuantityChanged(t, change);
+    m_changed.insert(t);
+  }
+
+ private:
+  /**
+   * @brief The steps a transaction added to the trees, kept so they can be taken out again.
+   */
+  struct Steps {
+    eint start, end;
+    edouble startLower, startUpper, endLower, endUpper;
+  };
+
+  void updateTrees() {
+    for(typename std::set<TransactionId>::const_iterator it = m_changed.begin(); it != m_changed.end(); ++it) {
+      removeSteps(*it);
+      addSteps(*it);
+    }
+    m_changed.clear();
+  }
+
+  void addSteps(const TransactionId t) {
+    check_error(t.isValid());
+    Steps steps;
+    steps.start = static_cast<eint>(t->time()->lastDomain().getLowerBound());
+    steps.end = static_cast<eint>(t->time()->lastDomain().getUpperBound());
+    getStep(t, true, steps.startLower, steps.startUpper);
+    getStep(t, false, steps.endLower, steps.endUpper);
+    applySteps(steps, 1);
+    m_steps.insert(std::make_pair(t, steps));
+  }
+
+  void removeSteps(const TransactionId t) {
+    typename std::map<TransactionId, Steps>::iterator it = m_steps.find(t);
+    if(it == m_steps.end())
+      return;
+    applySteps(it->second, -1);
+    m_steps.erase(it);
+  }
+
+  void applySteps(const Steps& steps, const edouble sign) {
+    m_lowerLevels.add(steps.start, sign * steps.startLower);
+    m_upperLevels.add(steps.start, sign * steps.startUpper);
+    m_lowerLevels.add(steps.end, sign * steps.endLower);
+    m_upperLevels.add(steps.end, sign * steps.endUpper);
+  }
+
+  /**
+   * @brief Gets the change the base profile makes to the levels when the transaction starts or ends.
+   */
+  void getStep(const TransactionId t, const bool start, edouble& lower, edouble& upper) {
+    const edouble lowerLevelMin = this->m_lowerLevelMin, lowerLevelMax = this->m_lowerLevelMax;
+    const edouble upperLevelMin = this->m_upperLevelMin, upperLevelMax = this->m_upperLevelMax;
+    this->m_lowerLevelMin = this->m_lowerLevelMax = this->m_upperLevelMin = this->m_upperLevelMax = 0;
+
+    edouble lb, ub;
+    t->quantity()->lastDomain().getBounds(lb, ub);
+    if(start)
+      this->handleTransactionStart(t->isConsumer(), lb, ub);
+    else
+      this->handleTransactionEnd(t->isConsumer(), lb, ub);
+    lower = this->m_lowerLevelMin;
+    upper = this->m_upperLevelMax;
+
+    this->m_lowerLevelMin = lowerLevelMin;
+    this->m_lowerLevelMax = lowerLevelMax;
+    this->m_upperLevelMin = upperLevelMin;
+    this->m_upperLevelMax = upperLevelMax;
+  }
+
+  LevelTree m_lowerLevels, m_upperLevels;
+  std::map<TransactionId, Steps> m_steps;
+  std::set<TransactionId> m_changed; /**< Transactions whose steps are out of date. */
+};
+
+typedef SegmentTreeProfile<TimetableProfile> SegmentTreeTimetableProfile;
+typedef SegmentTreeProfile<GroundedProfile> SegmentTreeGroundedProfile;
+}
+
+#endif
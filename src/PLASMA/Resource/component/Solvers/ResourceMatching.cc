@@ -11,21 +11,10 @@ namespace EUROPA {
     template<>
     void MatchingEngine::getMatches(const InstantId inst,
 				    std::vector<MatchingRuleId>& results) {
-      m_cycleCount++;
-      results = m_unfilteredRules;
-      getMatchesInternal(inst, results);
-    }
-
-    template<>
-    void MatchingEngine::getMatchesInternal(const InstantId inst,
-					    std::vector<MatchingRuleId>& results)
-    {
       const ResourceId res = inst->getProfile()->getResource();
-      debugMsg("MatchingEngine:getMatchesInternal",
-	       "Triggering matches for object types (" <<
-	       res->getType().toString() << ")");
-      const SchemaId schema = res->getPlanDatabase()->getSchema();
-      trigger(schema->getAllObjectTypes(res->getType()), m_rulesByObjectType, results);
+      MatchKey key(MatchKey::OBJECT);
+      key.objectType = res->getType().getKey();
+      lookup(key, res->getPlanDatabase()->getSchema(), results);
     }
 
     void InstantMatchFinder::getMatches(const MatchingEngineId engine, const EntityId entity,
@@ -13,10 +13,6 @@ namespace EUROPA {
     void MatchingEngine::getMatches(const InstantId inst,
 				    std::vector<MatchingRuleId>& results);
 
-    template<>
-    void MatchingEngine::getMatchesInternal(const InstantId inst,
-					    std::vector<MatchingRuleId>& results);
-
     class InstantMatchFinder : public MatchFinder {
     public:
       void getMatches(const MatchingEngineId engine, const EntityId entity,
@@ -9,6 +9,7 @@
 #include "tinyxml.h"
 
 #include <boost/cast.hpp>
+#include <algorithm>
 
 namespace EUROPA {
   using namespace SOLVERS;
@@ -188,43 +189,50 @@ class SuccessorContributingChoiceFilter : public DefaultChoiceFilter {
   std::string toString() const {return "SuccessorContributingFilter";}
 };
 
+    /**
+     * @brief The time bounds and key of a transaction as they were when the choices were generated,
+     * so that choices put in order later compare the same way.
+     */
+    class ChoiceTransaction {
+    public:
+      ChoiceTransaction(const TransactionId t)
+        : id(t), lb(t->time()->lastDomain().getLowerBound()), ub(t->time()->lastDomain().getUpperBound()),
+          key(t->time()->getKey()) {}
+      TransactionId id;
+      edouble lb, ub;
+      eint key;
+    };
+
+    class ThreatChoice {
+    public:
+      ThreatChoice(const std::pair<TransactionId, TransactionId>& p) : predecessor(p.first), successor(p.second) {}
+      std::pair<TransactionId, TransactionId> get() const {return std::make_pair(predecessor.id, successor.id);}
+      ChoiceTransaction predecessor, successor;
+    };
+
     class ChoiceComparator {
     public:
       virtual ~ChoiceComparator() {}
-      virtual bool operator()(const std::pair<TransactionId, TransactionId>&,
-                              const std::pair<TransactionId, TransactionId>& ) const {
-        check_error(ALWAYS_FAIL, "This used to be a pure virtual method.");
-        return false;
-      }
-      virtual std::string toString() const {
-        check_error(ALWAYS_FAIL, "This used to be a pure virtual method.");
-        return "";
-      }
-      virtual ChoiceComparator* copy() const = 0;
+      virtual bool operator()(const ThreatChoice& p1, const ThreatChoice& p2) const = 0;
+      virtual std::string toString() const = 0;
     private:
     };
 
     class ChoiceOrder {
+    private:
+      ChoiceOrder(const ChoiceOrder&);
+      ChoiceOrder& operator=(const ChoiceOrder&);
     public:
       ChoiceOrder() : m_cmps() {}
-      ChoiceOrder(const ChoiceOrder& other) : m_cmps() {
-        debugMsg("ResourceThreatDecisionPoint:sort", "Copying the choice order.");
-        condDebugMsg(other.m_cmps.empty(), "ResourceThreatDecisionPoint:sort", "Other order has no comparators.");
-        for(std::list<ChoiceComparator*>::const_iterator it = other.m_cmps.begin(); it != other.m_cmps.end(); ++it) {
-          debugMsg("ResourceThreatDecisionPoint:sort", "Copying " << (*it)->toString());
-          m_cmps.push_back((*it)->copy());
-          //m_cmps.push_back(*it);
-        }
-      }
       ~ChoiceOrder() {
         for(std::list<ChoiceComparator*>::iterator it = m_cmps.begin(); it != m_cmps.end(); ++it)
           delete (*it);
         m_cmps.clear();
       }
-      bool operator()(const std::pair<TransactionId, TransactionId>& p1, const std::pair<TransactionId, TransactionId>& p2) const {
+      bool operator()(const ThreatChoice& p1, const ThreatChoice& p2) const {
         debugMsg("ResourceThreatDecisionPoint:sort", "Comparing the following pairs:" << std::endl <<
-                 "<" << p1.first->toString() << ", " << p1.second->toString() << ">" << std::endl <<
-                 "<" << p2.first->toString() << ", " << p2.second->toString() << ">");
+                 "<" << p1.predecessor.id->toString() << ", " << p1.successor.id->toString() << ">" << std::endl <<
+                 "<" << p2.predecessor.id->toString() << ", " << p2.successor.id->toString() << ">");
         checkError(!m_cmps.empty(), "No comparators.");
         for(std::list<ChoiceComparator*>::const_iterator it = m_cmps.begin(); it != m_cmps.end(); ++it) {
           ChoiceComparator* cmp = *it;
@@ -252,12 +260,43 @@ class SuccessorContributingChoiceFilter : public DefaultChoiceFilter {
       std::list<ChoiceComparator*> m_cmps;
     };
 
+    /**
+     * @brief A heap of choices, so that putting n of m choices in order costs O(m + n log m)
+     * rather than sorting all of them.
+     */
+    class ChoiceQueue {
+    public:
+      ChoiceQueue() : m_order(), m_heap() {}
+      ChoiceOrder& getOrder() {return m_order;}
+      void push(const std::pair<TransactionId, TransactionId>& choice) {m_heap.push_back(ThreatChoice(choice));}
+      void makeHeap() {std::make_heap(m_heap.begin(), m_heap.end(), Later(m_order));}
+      bool empty() const {return m_heap.empty();}
+      unsigned long size() const {return m_heap.size();}
+      std::pair<TransactionId, TransactionId> pop() {
+        check_error(!empty());
+        std::pop_heap(m_heap.begin(), m_heap.end(), Later(m_order));
+        std::pair<TransactionId, TransactionId> choice = m_heap.back().get();
+        m_heap.pop_back();
+        return choice;
+      }
+    private:
+      class Later {
+      public:
+        Later(const ChoiceOrder& order) : m_order(order) {}
+        bool operator()(const ThreatChoice& p1, const ThreatChoice& p2) const {return m_order(p2, p1);}
+      private:
+        const ChoiceOrder& m_order;
+      };
+
+      ChoiceOrder m_order;
+      std::vector<ThreatChoice> m_heap;
+    };
+
     class TransactionComparator {
     public:
       virtual ~TransactionComparator() {}
-      virtual bool operator()(const TransactionId t1, const TransactionId t2) const = 0;
+      virtual bool operator()(const ChoiceTransaction& t1, const ChoiceTransaction& t2) const = 0;
       virtual std::string toString() const = 0;
-      virtual TransactionComparator* copy() const = 0;
     private:
     };
 
@@ -268,15 +307,12 @@ class SuccessorContributingChoiceFilter : public DefaultChoiceFilter {
     public:
       SwitchComparator(TransactionComparator* cmp, bool predecessor) : ChoiceComparator(), m_cmp(cmp), m_predecessor(predecessor) {}
       ~SwitchComparator(){delete  m_cmp;}
-      bool operator()(const std::pair<TransactionId, TransactionId>& p1, const std::pair<TransactionId, TransactionId>& p2) const {
-        return (m_predecessor ? (*m_cmp)(p1.first, p2.first) : (*m_cmp)(p1.second, p2.second));
+      bool operator()(const ThreatChoice& p1, const ThreatChoice& p2) const {
+        return (m_predecessor ? (*m_cmp)(p1.predecessor, p2.predecessor) : (*m_cmp)(p1.successor, p2.successor));
       }
       std::string toString() const {
         return m_cmp->toString() + (m_predecessor ? "Predecessor" : "Successor");
       }
-      ChoiceComparator* copy() const {
-        return (new SwitchComparator(m_cmp->copy(), m_predecessor));
-      }
     private:
       TransactionComparator* m_cmp;
       bool m_predecessor;
@@ -285,23 +321,20 @@ class SuccessorContributingChoiceFilter : public DefaultChoiceFilter {
     class LeastImpactComparator : public ChoiceComparator {
     public:
       LeastImpactComparator() : ChoiceComparator() {}
-      bool operator()(const std::pair<TransactionId, TransactionId>& p1, const std::pair<TransactionId, TransactionId>& p2) const {
-        edouble score1 = std::max(pseudoAbs(p1.first->time()->lastDomain().getLowerBound() - p1.second->time()->lastDomain().getLowerBound()),
-                                 pseudoAbs(p1.first->time()->lastDomain().getUpperBound() - p1.second->time()->lastDomain().getUpperBound()));
-        edouble score2 = std::max(pseudoAbs(p2.first->time()->lastDomain().getLowerBound() - p2.second->time()->lastDomain().getLowerBound()),
-                                 pseudoAbs(p2.first->time()->lastDomain().getUpperBound() - p2.second->time()->lastDomain().getUpperBound()));
+      bool operator()(const ThreatChoice& p1, const ThreatChoice& p2) const {
+        edouble score1 = std::max(pseudoAbs(p1.predecessor.lb - p1.successor.lb),
+                                  pseudoAbs(p1.predecessor.ub - p1.successor.ub));
+        edouble score2 = std::max(pseudoAbs(p2.predecessor.lb - p2.successor.lb),
+                                  pseudoAbs(p2.predecessor.ub - p2.successor.ub));
 
         debugMsg("ResourceThreatDecisionPoint:filter:leastImpact", std::endl <<
-                 "<" << p1.first->toString() << ", " << p1.second->toString() << "> score: " << score1 << std::endl <<
-                 "<" << p2.first->toString() << ", " << p2.second->toString() << "> score: " << score2);
+                 "<" << p1.predecessor.id->toString() << ", " << p1.successor.id->toString() << "> score: " << score1 << std::endl <<
+                 "<" << p2.predecessor.id->toString() << ", " << p2.successor.id->toString() << "> score: " << score2);
         return score1 < score2;
       }
       std::string toString() const {
         return "LeastImpactComparator";
       }
-      ChoiceComparator* copy() const {
-        return (new LeastImpactComparator());
-      }
     private:
       inline edouble pseudoAbs(edouble value) const {
         return (value < 0 ? 0 : value);
@@ -310,61 +343,51 @@ class SuccessorContributingChoiceFilter : public DefaultChoiceFilter {
 
     class EarliestTransactionComparator : public TransactionComparator {
     public:
-      bool operator()(const TransactionId t1, const TransactionId t2) const {
-        return t1->time()->lastDomain().getLowerBound() < t2->time()->lastDomain().getLowerBound();
+      bool operator()(const ChoiceTransaction& t1, const ChoiceTransaction& t2) const {
+        return t1.lb < t2.lb;
       }
       std::string toString() const {return "earliest";}
-      TransactionComparator* copy() const {return new EarliestTransactionComparator();}
     };
 
     class LatestTransactionComparator : public TransactionComparator {
     public:
-      bool operator()(const TransactionId t1, const TransactionId t2) const {
-        debugMsg("ResourceThreatDecisionPoint:sort:latest", "Comparing upper bounds of timepoints for " << t1->toString() << " and " << t2->toString());
-        return t1->time()->lastDomain().getUpperBound() > t2->time()->lastDomain().getUpperBound();
+      bool operator()(const ChoiceTransaction& t1, const ChoiceTransaction& t2) const {
+        debugMsg("ResourceThreatDecisionPoint:sort:latest", "Comparing upper bounds of timepoints for " << t1.id->toString() << " and " << t2.id->toString());
+        return t1.ub > t2.ub;
       }
       std::string toString() const {return "latest";}
-      TransactionComparator* copy() const {return new LatestTransactionComparator();}
     };
 
     class LongestTransactionComparator : public TransactionComparator {
     public:
-      bool operator()(const TransactionId t1, const TransactionId t2) const {
-        return
-          (t1->time()->lastDomain().getUpperBound() - t1->time()->lastDomain().getLowerBound()) >
-          (t2->time()->lastDomain().getUpperBound() - t2->time()->lastDomain().getLowerBound());
+      bool operator()(const ChoiceTransaction& t1, const ChoiceTransaction& t2) const {
+        return (t1.ub - t1.lb) > (t2.ub - t2.lb);
       }
       std::string toString() const {return "longest";}
-      TransactionComparator* copy() const {return new LongestTransactionComparator();}
     };
 
     class ShortestTransactionComparator : public TransactionComparator {
     public:
-      bool operator()(const TransactionId t1, const TransactionId t2) const {
-        return
-          (t1->time()->lastDomain().getUpperBound() - t1->time()->lastDomain().getLowerBound()) <
-          (t2->time()->lastDomain().getUpperBound() - t2->time()->lastDomain().getLowerBound());
+      bool operator()(const ChoiceTransaction& t1, const ChoiceTransaction& t2) const {
+        return (t1.ub - t1.lb) < (t2.ub - t2.lb);
       }
       std::string toString() const {return "shortest";}
-      TransactionComparator* copy() const {return new ShortestTransactionComparator();}
     };
 
     class AscendingKeyTransactionComparator : public TransactionComparator {
     public:
-      bool operator()(const TransactionId t1, const TransactionId t2) const {
-        return t1->time()->getKey() < t2->time()->getKey();
+      bool operator()(const ChoiceTransaction& t1, const ChoiceTransaction& t2) const {
+        return t1.key < t2.key;
       }
       std::string toString() const {return "ascendingKey";}
-      TransactionComparator* copy() const {return new AscendingKeyTransactionComparator();}
     };
 
     class DescendingKeyTransactionComparator : public TransactionComparator {
     public:
-      bool operator()(const TransactionId t1, const TransactionId t2) const {
-        return t1->time()->getKey() > t2->time()->getKey();
+      bool operator()(const ChoiceTransaction& t1, const ChoiceTransaction& t2) const {
+        return t1.key > t2.key;
       }
       std::string toString() const {return "descendingKey";}
-      TransactionComparator* copy() const {return new DescendingKeyTransactionComparator();}
     };
 
 
@@ -401,54 +424,111 @@ class SuccessorContributingChoiceFilter : public DefaultChoiceFilter {
        order="leastImpact" will order choices by last estimated temporal impact
 
      */
+ResourceThreatConfig::ResourceThreatConfig(const TiXmlElement& configData)
+    : m_predecessorNot(false), m_successor(false), m_order(), m_constraintNames(),
+      m_constraintFirst(false) {
+  //process the filter, defaulting to "none"
+  std::string filter = (configData.Attribute("filter") == NULL ? "none" : configData.Attribute("filter"));
+  checkError(filter == "none" || filter == "predecessorNot" || filter == "successor" || filter == "both",
+             "Unknown filter attribute '" << filter << "'");
+  m_predecessorNot = (filter == "predecessorNot" || filter == "both");
+  m_successor = (filter == "successor" || filter == "both");
+
+  //process the order, with ascendingKeyPredecessor,ascendingKeySuccessor as the universal tie-breaker
+  std::string order = (configData.Attribute("order") == NULL ? "" : configData.Attribute("order"));
+  if(order.size() > 0)
+    order += ",";
+  order += "ascendingKeyPredecessor,ascendingKeySuccessor";
+  parseOrder(order);
+
+  //store the names of the constraints to get created
+  if(configData.Attribute("constraint") == NULL)
+    m_constraintNames.push_back("precedes");
+  else {
+    std::string constraint = configData.Attribute("constraint");
+    if(constraint == "precedesOnly" || constraint == "precedesFirst")
+      m_constraintNames.push_back("precedes");
+    if(constraint == "concurrentOnly" || constraint == "concurrentFirst" || constraint == "precedesFirst")
+      m_constraintNames.push_back("concurrent");
+    if(constraint == "concurrentFirst")
+      m_constraintNames.push_back("precedes");
+  }
+  check_error(m_constraintNames.size() == 1 || m_constraintNames.size() == 2, "Expected one or two constraint names.");
+
+  std::string iterate = (configData.Attribute("iterate") == NULL ? "pairFirst" : configData.Attribute("iterate"));
+  checkError(iterate == "pairFirst" || iterate == "constraintFirst", "Expected 'pairFirst' or 'constraintFirst' for iterate attribute.");
+  m_constraintFirst = (iterate == "constraintFirst");
+}
+
+//this parsing could be tightened up a bit more.
+void ResourceThreatConfig::parseOrder(const std::string& order) {
+  check_error(order.size() > 0, "Empty choice ordering.  Bizarre.");
+
+  std::string::size_type curPos = 0;
+  while(curPos != std::string::npos) {
+    std::string::size_type nextPos = order.find(',', curPos);
+    std::string orderStr = order.substr(curPos, (nextPos == std::string::npos ? nextPos : nextPos - curPos));
+    if(orderStr == "leastImpact") {
+      m_order.push_back(OrderKey(LEAST_IMPACT, false));
+    }
+    else {
+      bool predecessor = false;
+
+      if(orderStr.find("Predecessor") != std::string::npos)
+        predecessor = true;
+      else if(orderStr.find("Successor") != std::string::npos)
+        predecessor = false;
+      else {
+        checkError(ALWAYS_FAIL, "Expected a 'Predecessor' or 'Successor' order.");
+      }
+      if(orderStr.find("earliest") != std::string::npos)
+        m_order.push_back(OrderKey(EARLIEST, predecessor));
+      else if(orderStr.find("latest") != std::string::npos)
+        m_order.push_back(OrderKey(LATEST, predecessor));
+      else if(orderStr.find("longest") != std::string::npos)
+        m_order.push_back(OrderKey(LONGEST, predecessor));
+      else if(orderStr.find("shortest") != std::string::npos)
+        m_order.push_back(OrderKey(SHORTEST, predecessor));
+      else if(orderStr.find("ascendingKey") != std::string::npos)
+        m_order.push_back(OrderKey(ASCENDING_KEY, predecessor));
+      else if(orderStr.find("descendingKey") != std::string::npos)
+        m_order.push_back(OrderKey(DESCENDING_KEY, predecessor));
+      else {
+        checkError(ALWAYS_FAIL, "Unknown choice order '" << orderStr);
+      }
+    }
+    curPos = (nextPos == std::string::npos ? nextPos : nextPos + 1);
+  }
+}
+
 ResourceThreatDecisionPoint::ResourceThreatDecisionPoint(const DbClientId client,
                                                          const InstantId flawedInstant,
                                                          const TiXmlElement& configData,
                                                          const LabelStr& explanation)
-    : DecisionPoint(client, flawedInstant->getKey(), explanation), 
-      m_flawedInstant(flawedInstant), m_choices(), m_choiceCount(0), m_index(0),
-      m_constr(), m_instTime(flawedInstant->getTime()), 
+    : DecisionPoint(client, flawedInstant->getKey(), explanation),
+      m_flawedInstant(flawedInstant), m_config(configData), m_queue(NULL), m_choices(),
+      m_choiceCount(0), m_index(0), m_constr(), m_instTime(flawedInstant->getTime()),
       m_resName(m_flawedInstant->getProfile()->getResource()->getName()),
-      m_order(), m_filter(), m_constraintOrder(), m_constraintNames(), 
-      m_constraintIt(m_constraintNames.end()) {
-
-      //process the configuration data for ordering choices
-      //store the filter, defaulting to "none"
-      m_filter = (configData.Attribute("filter") == NULL ? "none" : configData.Attribute("filter"));
-
-      //store the order, with ascendingKeyPredecessor,ascendingKeySuccessor as the universal tie-breaker
-      m_order = (configData.Attribute("order") == NULL ? "" : configData.Attribute("order"));
-      if(m_order.size() > 0)
-        m_order += ",";
-      m_order += "ascendingKeyPredecessor,ascendingKeySuccessor";
-
-      //store the names of the constraints to get created
-      if(configData.Attribute("constraint") == NULL)
-        m_constraintNames.push_back("precedes");
-      else {
-        std::string order = configData.Attribute("constraint");
-        if(order == "precedesOnly" || order == "precedesFirst")
-          m_constraintNames.push_back("precedes");
-        if(order == "concurrentOnly" || order == "concurrentFirst" || order == "precedesFirst")
-          m_constraintNames.push_back("concurrent");
-        if(order == "concurrentFirst")
-          m_constraintNames.push_back("precedes");
-      }
-      check_error(m_constraintNames.size() == 1 || m_constraintNames.size() == 2, "Expected one or two constraint names.");
-      m_constraintIt = m_constraintNames.begin();
-
-      m_constraintOrder = (configData.Attribute("iterate") == NULL ? "pairFirst" : configData.Attribute("iterate"));
-      checkError(m_constraintOrder == "pairFirst" || m_constraintOrder == "constraintFirst", "Expected 'pairFirst' or 'constraintFirst' for iterate attribute.");
-    }
+      m_constraintIt(m_config.getConstraintNames().begin()) {}
+
+ResourceThreatDecisionPoint::ResourceThreatDecisionPoint(const DbClientId client,
+                                                         const InstantId flawedInstant,
+                                                         const ResourceThreatConfig& config,
+                                                         const LabelStr& explanation)
+    : DecisionPoint(client, flawedInstant->getKey(), explanation),
+      m_flawedInstant(flawedInstant), m_config(config), m_queue(NULL), m_choices(),
+      m_choiceCount(0), m_index(0), m_constr(), m_instTime(flawedInstant->getTime()),
+      m_resName(m_flawedInstant->getProfile()->getResource()->getName()),
+      m_constraintIt(m_config.getConstraintNames().begin()) {}
 
-    ResourceThreatDecisionPoint::~ResourceThreatDecisionPoint() {}
+    ResourceThreatDecisionPoint::~ResourceThreatDecisionPoint() {
+      delete m_queue;
+    }
 
-    void ResourceThreatDecisionPoint::createFilter(ChoiceFilters& filters, const std::string& filter, ProfileId profile) {
-      checkError(filter == "none" || filter == "predecessorNot" || filter == "successor" || filter == "both",
-                 "Unknown filter attribute '" << filter << "'");
-      if(filter == "successor" || filter == "both")
+    void ResourceThreatDecisionPoint::createFilter(ChoiceFilters& filters, ProfileId profile) {
+      if(m_config.filterSuccessor())
     	  filters.addFilter(new SuccessorContributingChoiceFilter(profile, getExplanation(), m_flawedInstant));
-      if(filter == "predecessorNot" || filter == "both")
+      if(m_config.filterPredecessorNot())
         filters.addFilter(new PredecessorNotContributingChoiceFilter(profile, getExplanation(), m_flawedInstant));
       filters.addFilter(new DefaultChoiceFilter(profile, getExplanation(), m_flawedInstant));
     }
@@ -457,9 +537,11 @@ ResourceThreatDecisionPoint::ResourceThreatDecisionPoint(const DbClientId client
       std::stringstream os;
 
       os << "INS(" << m_instTime << ") on " << m_resName.toString();
-      TransactionId predecessor = m_choices[m_index].first;
-      TransactionId successor = m_choices[m_index].second;
-      os << " {" << predecessor->toString() << " < " << successor->toString() << "}";
+      if(m_index < m_choices.size()) {
+        TransactionId predecessor = m_choices[m_index].first;
+        TransactionId successor = m_choices[m_index].second;
+        os << " {" << predecessor->toString() << " < " << successor->toString() << "}";
+      }
 
       return os.str();
     }
@@ -473,15 +555,18 @@ ResourceThreatDecisionPoint::ResourceThreatDecisionPoint(const DbClientId client
     	return os.str();
       }
 
-      TransactionId predecessor = m_choices[m_index].first;
-      TransactionId successor = m_choices[m_index].second;
-      os << "  DECISION (CHOICE=" << (m_index+1) << " of MAX_CHOICE=" << m_choiceCount<< ") "
-         << predecessor->toString()
-         << " to be before " << successor->toString()
-         << " : ";
+      if(m_index < m_choices.size()) {
+        TransactionId predecessor = m_choices[m_index].first;
+        TransactionId successor = m_choices[m_index].second;
+        os << "  DECISION (CHOICE=" << (m_index+1) << " of MAX_CHOICE=" << m_choiceCount<< ") "
+           << predecessor->toString()
+           << " to be before " << successor->toString()
+           << " : ";
+      }
 
+      // only the choices put in order so far
       os << "  CHOICES ";
-      for(unsigned int i = 0; i < m_choiceCount; i++)
+      for(unsigned int i = 0; i < m_choices.size(); i++)
         os << " : " << (i+1) << " " << toString(m_choices[i]);
       return os.str();
     }
@@ -494,42 +579,48 @@ ResourceThreatDecisionPoint::ResourceThreatDecisionPoint(const DbClientId client
 
     void ResourceThreatDecisionPoint::handleInitialize() {
       check_error(m_flawedInstant.isValid());
-      m_flawedInstant->getProfile()->getResource()->getOrderingChoices(m_flawedInstant, m_choices);
+      std::vector<std::pair<TransactionId, TransactionId> > choices;
+      m_flawedInstant->getProfile()->getResource()->getOrderingChoices(m_flawedInstant, choices);
 
-      debugMsg("ResourceThreatDecisionPoint:handleInitialize", "Found " << m_choices.size() << " choices before filtering.");
+      debugMsg("ResourceThreatDecisionPoint:handleInitialize", "Found " << choices.size() << " choices before filtering.");
 
-      //filter based on the configuration
+      //filter based on the configuration.  This has to happen now, while the profile is as it was
+      //when the flaw was found.
       ChoiceFilters filter;
-      createFilter(filter, m_filter, static_cast<ProfileId>(m_flawedInstant->getProfile()));
-      //order based ont he configuration
-      ChoiceOrder order;
-      createOrder(order);
-
-      std::set<std::pair<TransactionId, TransactionId>, ChoiceOrder> sort(order);
-
-      std::insert_iterator<std::set<std::pair<TransactionId, TransactionId>, ChoiceOrder > > choiceIt =
-        inserter(sort, sort.begin());
-//       std::back_insert_iterator<std::vector<std::pair<TransactionId, TransactionId> > > choiceIt =
-//         std::back_inserter(m_choices);
-
-      for(std::vector<std::pair<TransactionId, TransactionId> >::iterator it = m_choices.begin();
-          it != m_choices.end(); ++it) {
+      createFilter(filter, static_cast<ProfileId>(m_flawedInstant->getProfile()));
+      //the choices are only put in order as they're needed
+      delete m_queue;
+      m_queue = new ChoiceQueue();
+      createOrder(m_queue->getOrder());
+
+      for(std::vector<std::pair<TransactionId, TransactionId> >::const_iterator it = choices.begin();
+          it != choices.end(); ++it) {
         if(filter(*it))
-          *choiceIt++ = *it;
+          m_queue->push(*it);
       }
+      m_queue->makeHeap();
 
-      //       std::sort(m_choices.begin(), m_choices.end(), order);
       m_choices.clear();
-      m_choices.insert(m_choices.end(), sort.begin(), sort.end());
-      m_choiceCount = m_choices.size();
+      m_choiceCount = m_queue->size();
       debugMsg("ResourceThreatDecisionPoint:handleInitialize", "Found " << m_choiceCount << " choices after filtering.");
-      //for some reason, std::sort copies the comparator object, so I'm going to try this with a set.
-      //std::sort(m_choices.begin(), m_choices.end(), order);
       m_flawedInstant = InstantId::noId();
     }
 
+    const std::pair<TransactionId, TransactionId>& ResourceThreatDecisionPoint::getChoice(const unsigned long index) {
+      checkError(index < m_choiceCount, "Tried to get choice " << index << " of " << m_choiceCount);
+      while(m_choices.size() <= index)
+        m_choices.push_back(m_queue->pop());
+      return m_choices[index];
+    }
+
+    const std::vector<std::pair<TransactionId, TransactionId> >& ResourceThreatDecisionPoint::getChoices() {
+      if(m_choiceCount > 0)
+        getChoice(m_choiceCount - 1);
+      return m_choices;
+    }
+
     bool ResourceThreatDecisionPoint::hasNext() const {
-      return m_index < m_choiceCount && m_constraintIt != m_constraintNames.end();
+      return m_index < m_choiceCount && m_constraintIt != m_config.getConstraintNames().end();
     }
 
     bool ResourceThreatDecisionPoint::canUndo() const {
@@ -539,8 +630,9 @@ ResourceThreatDecisionPoint::ResourceThreatDecisionPoint(const DbClientId client
     void ResourceThreatDecisionPoint::handleExecute() {
       check_error(m_constr.isNoId());
       checkError(m_index < m_choiceCount, "Tried to execute past available choices:" << m_index << ">=" << m_choiceCount);
-      TransactionId predecessor = m_choices[m_index].first;
-      TransactionId successor = m_choices[m_index].second;
+      const std::pair<TransactionId, TransactionId>& choice = getChoice(m_index);
+      TransactionId predecessor = choice.first;
+      TransactionId successor = choice.second;
       debugMsg("SolverDecisionPoint:handleExecute", "For " << m_instTime << " on " << m_resName.toString() << ", assigning " <<
                predecessor->toString() << " to be before " << successor->toString() << " because of " << getExplanation().toString() << ".");
       m_constr = m_client->createConstraint((*m_constraintIt).c_str(), makeScope(predecessor->time(), successor->time()));
@@ -553,63 +645,62 @@ ResourceThreatDecisionPoint::ResourceThreatDecisionPoint(const DbClientId client
       m_constr->discard();
       m_constr = ConstraintId::noId();
       //advance constraints before advancing pairs
-      if(m_constraintOrder == "constraintFirst") {
+      if(m_config.iterateConstraintFirst()) {
         ++m_constraintIt;
-        if(m_constraintIt == m_constraintNames.end()) {
+        if(m_constraintIt == m_config.getConstraintNames().end()) {
           m_index++;
-          m_constraintIt = m_constraintNames.begin();
+          m_constraintIt = m_config.getConstraintNames().begin();
         }
       }
-      else if(m_constraintOrder == "pairFirst") {
+      else {
         m_index++;
-        if(m_index == m_choices.size()) {
+        if(m_index == m_choiceCount) {
           m_index = 0;
           m_constraintIt++;
         }
       }
-      //m_index++
     }
 
-    //this parsing could be tightened up a bit more.
     void ResourceThreatDecisionPoint::createOrder(ChoiceOrder& order) {
-      check_error(m_order.size() > 0, "Empty choice ordering.  Bizarre.");
-
-      std::string::size_type curPos = 0;
-      while(curPos != std::string::npos) {
-        std::string::size_type nextPos = m_order.find(',', curPos);
-        std::string orderStr = m_order.substr(curPos, (nextPos == std::string::npos ? nextPos : nextPos - curPos));
-        if(orderStr == "leastImpact") {
+      const std::vector<ResourceThreatConfig::OrderKey>& keys = m_config.getOrder();
+      for(std::vector<ResourceThreatConfig::OrderKey>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+        TransactionComparator* cmp = NULL;
+        switch(it->comparison) {
+        case ResourceThreatConfig::LEAST_IMPACT:
           order.addOrder(new LeastImpactComparator());
+          continue;
+        case ResourceThreatConfig::EARLIEST:
+          cmp = new EarliestTransactionComparator();
+          break;
+        case ResourceThreatConfig::LATEST:
+          cmp = new LatestTransactionComparator();
+          break;
+        case ResourceThreatConfig::LONGEST:
+          cmp = new LongestTransactionComparator();
+          break;
+        case ResourceThreatConfig::SHORTEST:
+          cmp = new ShortestTransactionComparator();
+          break;
+        case ResourceThreatConfig::ASCENDING_KEY:
+          cmp = new AscendingKeyTransactionComparator();
+          break;
+        case ResourceThreatConfig::DESCENDING_KEY:
+          cmp = new DescendingKeyTransactionComparator();
+          break;
         }
-        else {
-          bool predecessor = false;
-
-          if(orderStr.find("Predecessor") != std::string::npos)
-            predecessor = true;
-          else if(orderStr.find("Successor") != std::string::npos)
-            predecessor = false;
-          else {
-            checkError(ALWAYS_FAIL, "Expected a 'Predecessor' or 'Successor' order.");
-          }
-          ChoiceComparator* cmp=NULL;
-          if(orderStr.find("earliest") != std::string::npos)
-            cmp = new SwitchComparator(new EarliestTransactionComparator(), predecessor);
-          else if(orderStr.find("latest") != std::string::npos)
-            cmp = new SwitchComparator(new LatestTransactionComparator(), predecessor);
-          else if(orderStr.find("longest") != std::string::npos)
-            cmp = new SwitchComparator(new LongestTransactionComparator(), predecessor);
-          else if(orderStr.find("shortest") != std::string::npos)
-            cmp = new SwitchComparator(new ShortestTransactionComparator(), predecessor);
-          else if(orderStr.find("ascendingKey") != std::string::npos)
-            cmp = new SwitchComparator(new AscendingKeyTransactionComparator(), predecessor);
-          else if(orderStr.find("descendingKey") != std::string::npos)
-            cmp = new SwitchComparator(new DescendingKeyTransactionComparator(), predecessor);
-          else {
-            checkError(ALWAYS_FAIL, "Unknown choice order '" << orderStr);
-          }
-          order.addOrder(cmp);
-        }
-        curPos = (nextPos == std::string::npos ? nextPos : nextPos + 1);
+        order.addOrder(new SwitchComparator(cmp, it->predecessor));
       }
     }
+
+ResourceThreatHandler::ResourceThreatHandler(const TiXmlElement& configData)
+    : ConcreteFlawHandler<ResourceThreatDecisionPoint>(configData),
+      m_threatConfig(*FlawHandler::m_configData) {}
+
+DecisionPointId ResourceThreatHandler::create(const DbClientId client, const EntityId flaw,
+                                              const LabelStr& explanation) const {
+  ResourceThreatDecisionPoint* dp =
+      new ResourceThreatDecisionPoint(client, flaw, m_threatConfig, explanation);
+  dp->setContext(m_context);
+  return dp->getId();
+}
 }
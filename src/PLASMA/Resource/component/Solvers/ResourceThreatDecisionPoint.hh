@@ -2,6 +2,7 @@
 #define _H_ResourceThreatDecisionPoint
 
 #include "SolverDecisionPoint.hh"
+#include "FlawHandler.hh"
 #include "ResourceDefs.hh"
 #include "Instant.hh"
 #include "ConstraintEngineDefs.hh"
@@ -12,16 +13,62 @@ namespace EUROPA {
 
     class ChoiceOrder;
     class ChoiceFilters;
+    class ChoiceQueue;
+
+    /**
+     * @brief The filter, order and constraint attributes of a ResourceThreatDecisionPoint, parsed.
+     */
+    class ResourceThreatConfig {
+    public:
+      enum Comparison {
+        EARLIEST = 0,
+        LATEST,
+        LONGEST,
+        SHORTEST,
+        ASCENDING_KEY,
+        DESCENDING_KEY,
+        LEAST_IMPACT
+      };
+
+      /**
+       * @brief One comparison of the choice order, on the predecessors or the successors of the choices.
+       */
+      struct OrderKey {
+        OrderKey(const Comparison cmp, const bool pred) : comparison(cmp), predecessor(pred) {}
+        Comparison comparison;
+        bool predecessor;
+      };
+
+      ResourceThreatConfig(const TiXmlElement& configData);
+
+      bool filterPredecessorNot() const {return m_predecessorNot;}
+      bool filterSuccessor() const {return m_successor;}
+      const std::vector<OrderKey>& getOrder() const {return m_order;}
+      const std::vector<std::string>& getConstraintNames() const {return m_constraintNames;}
+      bool iterateConstraintFirst() const {return m_constraintFirst;}
+
+    private:
+      void parseOrder(const std::string& order);
+
+      bool m_predecessorNot, m_successor;
+      std::vector<OrderKey> m_order;
+      std::vector<std::string> m_constraintNames;
+      bool m_constraintFirst;
+    };
 
     class ResourceThreatDecisionPoint : public SOLVERS::DecisionPoint {
     public:
       ResourceThreatDecisionPoint(const DbClientId client, const InstantId inst, const TiXmlElement& configData, const LabelStr& explanation = "unknown");
+      ResourceThreatDecisionPoint(const DbClientId client, const InstantId inst, const ResourceThreatConfig& config, const LabelStr& explanation = "unknown");
       virtual ~ResourceThreatDecisionPoint();
       virtual std::string toString() const;
       virtual std::string toShortString() const;
       void execute() {DecisionPoint::execute();}
       void undo() {DecisionPoint::undo();}
-      const std::vector<std::pair<TransactionId, TransactionId> >& getChoices() {return m_choices;}
+      /**
+       * @brief Returns every choice, in order.  Choices are otherwise put in order only as they are tried.
+       */
+      const std::vector<std::pair<TransactionId, TransactionId> >& getChoices();
       virtual void handleInitialize();
       virtual bool hasNext() const;
       virtual bool canUndo() const;
@@ -30,24 +77,36 @@ namespace EUROPA {
       static bool test(const EntityId entity);
 
     private:
+      ResourceThreatDecisionPoint(const ResourceThreatDecisionPoint&);
+      ResourceThreatDecisionPoint& operator=(const ResourceThreatDecisionPoint&);
       std::string toString(const std::pair<TransactionId, TransactionId>& choice) const;
-      void createFilter(ChoiceFilters& filters, const std::string& filter, ProfileId profile);
+      void createFilter(ChoiceFilters& filters, ProfileId profile);
       void createOrder(ChoiceOrder& order);
+      const std::pair<TransactionId, TransactionId>& getChoice(const unsigned long index);
     protected:
       InstantId m_flawedInstant;
+      ResourceThreatConfig m_config;
+      ChoiceQueue* m_queue; /**< The choices not yet put in order */
       std::vector<std::pair<TransactionId, TransactionId> > m_choices;
       unsigned long m_choiceCount;
       unsigned long m_index;
       ConstraintId m_constr;
       eint m_instTime;
       LabelStr m_resName;
-      std::string m_order;
-      std::string m_filter;
-      std::string m_constraintOrder;
-      std::vector<std::string> m_constraintNames;
       std::vector<std::string>::const_iterator m_constraintIt;
     };
 
+    /**
+     * @brief Creates ResourceThreatDecisionPoints, parsing their configuration once rather than for each one.
+     */
+    class ResourceThreatHandler : public SOLVERS::ConcreteFlawHandler<ResourceThreatDecisionPoint> {
+    public:
+      ResourceThreatHandler(const TiXmlElement& configData);
+      SOLVERS::DecisionPointId create(const DbClientId client, const EntityId flaw, const LabelStr& explanation) const;
+    private:
+      ResourceThreatConfig m_threatConfig;
+    };
+
 }
 
 #endif
@@ -36,6 +36,10 @@ class ThreatIterator : public FlawIterator {
  public:
   ThreatIterator(ResourceThreatManager& manager) 
       : FlawIterator(manager), m_flawedInstants(), m_it(m_flawedInstants.end()) {
+    const eint windowEnd = manager.getWindowEnd();
+    const unsigned long flawLimit = manager.getFlawLimit();
+    const bool bounded = windowEnd != PLUS_INFINITY || flawLimit != 0;
+    std::vector<ResourceId> resources;
     const ObjectSet& objs = manager.getPlanDatabase()->getObjects();
     for(ObjectSet::const_iterator it = objs.begin(); it != objs.end(); ++it) {
       ObjectId obj(*it);
@@ -46,9 +50,20 @@ class ThreatIterator : public FlawIterator {
       ResourceId res(obj);
       std::vector<InstantId> temp;
       debugMsg("ThreatIterator:ThreatIterator", "Resource!  Getting flawed instants...");
-      res->getFlawedInstants(temp);
+      if(bounded) {
+        res->getFlawedInstants(temp, windowEnd, flawLimit);
+        resources.push_back(res);
+      }
+      else
+        res->getFlawedInstants(temp);
       m_flawedInstants.insert(m_flawedInstants.end(), temp.begin(), temp.end());
     }
+    // With no flaws left in the window the search is about to finish, so recompute the rest of the
+    // profiles to catch any violation after the window.  Flaws there are still out of scope.
+    if(m_flawedInstants.empty()) {
+      for(std::vector<ResourceId>::const_iterator it = resources.begin(); it != resources.end(); ++it)
+        (*it)->getProfile()->recompute();
+    }
     debugMsg("ThreatIterator:ThreatIterator", "Got " << m_flawedInstants.size() << " total instants.");
     m_it = m_flawedInstants.begin();
     advance();
@@ -256,7 +271,12 @@ DecisionOrder::DecisionOrder(const DecisionOrder& other) : m_cmps() {
 
     //at some point, this should take data about ordering choices by earliest/latest, most/least flawed, and most/least transactions
 ResourceThreatManager::ResourceThreatManager(const TiXmlElement& configData) 
-    : FlawManager(configData), m_preferUpper(false), m_preferLower(false), m_order() {
+    : FlawManager(configData), m_preferUpper(false), m_preferLower(false),
+      m_horizonBounded(configData.Attribute("horizonBounded") != NULL &&
+                       std::string(configData.Attribute("horizonBounded")) == "true"),
+      m_flawLimit(configData.Attribute("flawLimit") == NULL ? 0 :
+                  static_cast<unsigned long>(atol(configData.Attribute("flawLimit")))),
+      m_order() {
   std::string order = (configData.Attribute("order") == NULL ? 
                        "lower,most,earliest" : configData.Attribute("order"));
       std::string::size_type curPos = 0;
@@ -325,6 +345,14 @@ ResourceThreatManager::ResourceThreatManager(const TiXmlElement& configData)
       return os.str();
     }
 
+eint ResourceThreatManager::getWindowEnd() const {
+  if(!m_horizonBounded)
+    return PLUS_INFINITY;
+  checkRuntimeError(getContext().isValid(),
+                    "ResourceThreatManager bounded by the horizon without a solver context.");
+  return static_cast<eint::basis_type>(getContext()->get("horizonEnd"));
+}
+
 bool ResourceThreatManager::noMoreFlaws() {
   return ThreatIterator(*this).done();
 }
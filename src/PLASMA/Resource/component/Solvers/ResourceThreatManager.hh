@@ -37,9 +37,22 @@ namespace EUROPA {
       virtual void notifyRemoved(const TokenId) {}
       bool noMoreFlaws();
 
+      /**
+       * @brief The latest time at which flaws are looked for: the end of the solver horizon if the
+       * manager is configured with horizonBounded="true", PLUS_INFINITY otherwise.
+       */
+      eint getWindowEnd() const;
+
+      /**
+       * @brief The most flawed instants looked for on each resource, from the flawLimit attribute (0 for no limit).
+       */
+      unsigned long getFlawLimit() const {return m_flawLimit;}
+
     protected:
     private:
       bool m_preferUpper, m_preferLower;
+      bool m_horizonBounded;
+      unsigned long m_flawLimit;
       DecisionOrder m_order;
     };
 }
@@ -26,6 +26,7 @@
 #include "Debug.hh"
 
 #include "ThreatDecisionPoint.hh"
+#include "Solver.hh"
 #include "Context.hh"
 #include "Profile.hh"
 #include "FlowProfile.hh"
@@ -50,6 +51,7 @@
 #include "ModuleResource.hh"
 #include "ModuleNddl.hh"
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <list>
@@ -1169,6 +1171,30 @@ private:
   }
 };
 
+/**
+ * @brief Exposes the bookkeeping a CBReusable keeps for its Uses constraints.
+ */
+class CBReusableFootprint : public CBReusable {
+public:
+  CBReusableFootprint(const PlanDatabaseId db, const LabelStr& name, edouble capacity)
+    : CBReusable(db, "CBReusable", name, "ClosedWorldFVDetector", "TimetableProfile",
+                 capacity, capacity, 0) {}
+
+  const std::vector<UsesId>& getUses() const {return m_uses;}
+
+  unsigned long getViolatedInstantCount() const {return m_violations.size();}
+
+  /**
+   * @brief Bytes held by the resource for its constraints, counting a tree node as three pointers.
+   */
+  unsigned long getBookkeepingBytes() const {
+    unsigned long bytes = m_uses.capacity() * sizeof(UsesId);
+    for(ViolationMap::const_iterator it = m_violations.begin(); it != m_violations.end(); ++it)
+      bytes += 3 * sizeof(void*) + sizeof(*it) + it->second.uses.capacity() * sizeof(unsigned int);
+    return bytes;
+  }
+};
+
 class ResourceTest {
 public:
   static bool test() {
@@ -1176,8 +1202,11 @@ public:
     EUROPA_runTest(testFlowReservoirWithConsumptionParameterSpecification);
     EUROPA_runTest(testIncrementalFlowProfileIssue71);
     EUROPA_runTest(testReusable);
+    EUROPA_runTest(testCBReusableViolations);
+    EUROPA_runTest(testCBReusableFootprint);
     EUROPA_runTest(testReservoirRemove);
     EUROPA_runTest(testDanglingTransaction);
+    EUROPA_runTest(testConcurrentViolation);
     return true;
   }
 private:
@@ -1395,6 +1424,150 @@ private:
     return true;
   }
 
+  /**
+   * @brief Profiles recomputed on several threads pass their violations on as profiles recomputed
+   * one after another do: only as far as the first one, which leaves the network inconsistent.
+   */
+  static bool testConcurrentViolation() {
+    const unsigned int threadCounts[] = {1, 4};
+    for(unsigned int i = 0; i < 2; ++i) {
+      RESOURCE_DEFAULT_SETUP(ce, db, false);
+      ProfilePropagator* propagator = id_cast<ProfilePropagator>(ce.getPropagatorByName(LabelStr("Resource")));
+      CPPUNIT_ASSERT(propagator != NULL);
+      propagator->setThreadCount(threadCounts[i]);
+
+      // every resource is oversubscribed
+      std::vector<Reusable*> resources;
+      std::vector<ReusableToken*> uses, extraUses;
+      const char* names[] = {"ReusableA", "ReusableB", "ReusableC", "ReusableD"};
+      for(unsigned int j = 0; j < 4; ++j) {
+        const LabelStr name(names[j]);
+        resources.push_back(new Reusable(db.getId(), LabelStr("Reusable"), name,
+                                         LabelStr("ClosedWorldFVDetector"), LabelStr("TimetableProfile"), 1, 1, 0));
+        uses.push_back(new ReusableToken(db.getId(), LabelStr("Reusable.uses"), IntervalIntDomain(0), IntervalIntDomain(10),
+                                         IntervalIntDomain(10), IntervalDomain(1), name));
+        extraUses.push_back(new ReusableToken(db.getId(), LabelStr("Reusable.uses"), IntervalIntDomain(0), IntervalIntDomain(10),
+                                              IntervalIntDomain(10), IntervalDomain(1), name));
+      }
+
+      CPPUNIT_ASSERT(!ce.propagate());
+      CPPUNIT_ASSERT(ce.getEmptyVariables().size() == 1);
+
+      // the profiles left out of date are brought up to date once the resources are no longer oversubscribed
+      for(std::vector<ReusableToken*>::const_iterator it = extraUses.begin(); it != extraUses.end(); ++it)
+        delete *it;
+      CPPUNIT_ASSERT(ce.propagate());
+      for(std::vector<Reusable*>::const_iterator it = resources.begin(); it != resources.end(); ++it) {
+        std::vector<InstantId> flawedInstants;
+        (*it)->getFlawedInstants(flawedInstants);
+        CPPUNIT_ASSERT(flawedInstants.empty());
+      }
+
+      for(std::vector<ReusableToken*>::const_iterator it = uses.begin(); it != uses.end(); ++it)
+        delete *it;
+      for(std::vector<Reusable*>::const_iterator it = resources.begin(); it != resources.end(); ++it)
+        delete *it;
+      RESOURCE_DEFAULT_TEARDOWN();
+    }
+    return true;
+  }
+
+  static ConstraintId createUses(ConstraintEngine& ce, CBReusable& res, const edouble quantity,
+                                 const eint start, const eint end,
+                                 std::vector<ConstrainedVariableId>& variables) {
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(res.getThis());
+    scope.push_back((new Variable<IntervalDomain>(ce.getId(), IntervalDomain(quantity)))->getId());
+    scope.push_back((new Variable<IntervalIntDomain>(ce.getId(), IntervalIntDomain(start)))->getId());
+    scope.push_back((new Variable<IntervalIntDomain>(ce.getId(), IntervalIntDomain(end)))->getId());
+    variables.insert(variables.end(), scope.begin() + 1, scope.end());
+    return (new Uses(Uses::CONSTRAINT_NAME(), Uses::PROPAGATOR_NAME(), ce.getId(), scope))->getId();
+  }
+
+  static bool testCBReusableViolations() {
+    RESOURCE_DEFAULT_SETUP(ce, db, false);
+    ce.setAllowViolations(true);
+
+    CBReusableFootprint res(db.getId(), "myCBReusable", 1);
+    std::vector<ConstrainedVariableId> variables;
+    ConstraintId first = createUses(ce, res, 1, 0, 10, variables);
+    ConstraintId second = createUses(ce, res, 1, 5, 15, variables);
+    ConstraintId third = createUses(ce, res, 1, 20, 30, variables);
+    CPPUNIT_ASSERT(ce.propagate());
+
+    CPPUNIT_ASSERT(res.getUses().size() == 3);
+    CPPUNIT_ASSERT(res.getUses()[2] == third);
+
+    // only the overlapping uses exceed the capacity
+    CPPUNIT_ASSERT(res.getViolatedInstantCount() > 0);
+    CPPUNIT_ASSERT(ce.isViolated(first));
+    CPPUNIT_ASSERT(ce.isViolated(second));
+    CPPUNIT_ASSERT(!ce.isViolated(third));
+    UsesId uses = second;
+    std::map<InstantId, Resource::ProblemType> problems = uses->getViolationProblems();
+    CPPUNIT_ASSERT(!problems.empty());
+    CPPUNIT_ASSERT(problems.begin()->second == Resource::LevelTooLow);
+    CPPUNIT_ASSERT(!uses->getViolationExpl().empty());
+    uses = third;
+    CPPUNIT_ASSERT(uses->getViolationProblems().empty());
+
+    // the last constraint takes the place of the one removed
+    first->discard();
+    CPPUNIT_ASSERT(res.getUses().size() == 2);
+    CPPUNIT_ASSERT(res.getUses()[0] == third);
+    CPPUNIT_ASSERT(res.getUses()[1] == second);
+    CPPUNIT_ASSERT(ce.propagate());
+    CPPUNIT_ASSERT(res.getViolatedInstantCount() == 0);
+    CPPUNIT_ASSERT(!ce.isViolated(second));
+    uses = second;
+    CPPUNIT_ASSERT(uses->getViolationProblems().empty());
+
+    second->discard();
+    third->discard();
+    for(std::vector<ConstrainedVariableId>::const_iterator it = variables.begin(); it != variables.end(); ++it)
+      delete static_cast<ConstrainedVariable*>(*it);
+
+    RESOURCE_DEFAULT_TEARDOWN();
+    return true;
+  }
+
+  /**
+   * @brief Reports what a CBReusable holds for each of many Uses constraints, half of them violated.
+   */
+  static bool testCBReusableFootprint() {
+    RESOURCE_DEFAULT_SETUP(ce, db, false);
+    ce.setAllowViolations(true);
+
+    const int useCount = 1000;
+    CBReusableFootprint res(db.getId(), "myCBReusable", 1);
+    std::vector<ConstrainedVariableId> variables;
+    std::vector<ConstraintId> constraints;
+    for(int i = 0; i < useCount; ++i) {
+      // every other pair of uses overlaps
+      eint start = i * 10 - ((i % 4) == 1 ? 5 : 0);
+      constraints.push_back(createUses(ce, res, 1, start, start + 8, variables));
+    }
+    CPPUNIT_ASSERT(ce.propagate());
+    CPPUNIT_ASSERT(res.getUses().size() == (unsigned int) useCount);
+    CPPUNIT_ASSERT(res.getViolatedInstantCount() > 0);
+
+    std::cout << "    CBReusable with " << useCount << " uses, " << res.getViolatedInstantCount()
+              << " violated instants: " << sizeof(Uses) << " bytes per Uses constraint, "
+              << static_cast<double>(res.getBookkeepingBytes()) / useCount
+              << " bytes of resource bookkeeping per use" << std::endl;
+
+    for(std::vector<ConstraintId>::const_iterator it = constraints.begin(); it != constraints.end(); ++it)
+      (*it)->discard();
+    CPPUNIT_ASSERT(res.getUses().empty());
+    CPPUNIT_ASSERT(ce.propagate());
+    CPPUNIT_ASSERT(res.getViolatedInstantCount() == 0);
+    for(std::vector<ConstrainedVariableId>::const_iterator it = variables.begin(); it != variables.end(); ++it)
+      delete static_cast<ConstrainedVariable*>(*it);
+
+    RESOURCE_DEFAULT_TEARDOWN();
+    return true;
+  }
+
   static bool testDanglingTransaction() {
     RESOURCE_DEFAULT_SETUP(unused(ce), db, false);
     rte.getConfig()->setProperty("nddl.includePath", ".:../component/NDDL");
@@ -1447,7 +1620,7 @@ private:
     ResourceId res(battery);
     CPPUNIT_ASSERT(res.isValid());
     
-    const std::map<eint, InstantId>& insts(res->getProfile()->getInstants());
+    const InstantMap& insts(res->getProfile()->getInstants());
     CPPUNIT_ASSERT(!insts.empty());
 
     TransactionId trans = *(insts.begin()->second->getTransactions().begin());
@@ -1486,6 +1659,9 @@ class ResourceSolverTest {
     EUROPA_runTest(testResourceThreatDecisionPoint);
     EUROPA_runTest(testResourceThreatManager);
     EUROPA_runTest(testResourceThreatManagerNoMoreFlaws);
+    EUROPA_runTest(testLazyProfilesWithoutThreatManager);
+    EUROPA_runTest(testLazyThreatChoices);
+    EUROPA_runTest(testViolationBlamesObjectDecision);
     return true;
   }
  private:
@@ -1641,6 +1817,11 @@ class ResourceSolverTest {
     CPPUNIT_ASSERT(dp7.getChoices()[2].first->time() == tok1.end());
     CPPUNIT_ASSERT(dp7.getChoices()[2].second->time() == tok3.start());
 
+    // a configuration parsed once orders choices the same way
+    ResourceThreatConfig latestPredConfig(*latestPredXml);
+    ResourceThreatDecisionPoint dp7Config(client, flawedInstants[0], latestPredConfig);
+    dp7Config.initialize();
+    CPPUNIT_ASSERT(dp7Config.getChoices() == dp7.getChoices());
 
     std::string longestPred = "<FlawHandler component=\"ResourceThreatDecisionPoint\" filter=\"successor\" order=\"longestPredecessor\"/>";
     TiXmlElement* longestPredXml = initXml(longestPred);
@@ -1963,6 +2144,158 @@ class ResourceSolverTest {
     delete earliestXml;
     return true;
   }
+
+  /**
+   * @brief With lazy profiles and no ResourceThreatManager nothing asks for the profiles, so the
+   * solver has to bring them up to date itself before taking the plan to be complete.
+   */
+  static bool testLazyProfilesWithoutThreatManager() {
+    RESOURCE_DEFAULT_SETUP(ceObj, dbObj, false);
+
+    PlanDatabaseId db = dbObj.getId();
+    ConstraintEngineId ce = ceObj.getId();
+    ProfilePropagator* propagator = id_cast<ProfilePropagator>(ce->getPropagatorByName(LabelStr("Resource")));
+    CPPUNIT_ASSERT(propagator != NULL);
+    propagator->setLazy(true);
+
+    Reusable reusable(db, "Reusable", "myReusable", "ClosedWorldFVDetector", "IncrementalFlowProfile", 1, 1, 0);
+
+    ReusableToken tok1(db, "Reusable.uses",
+                       IntervalIntDomain(1, 1), IntervalIntDomain(10, 10),
+                       IntervalIntDomain(9, 9),
+                       IntervalDomain(1.0, 1.0), "myReusable");
+
+    ReusableToken tok2(db, "Reusable.uses",
+                       IntervalIntDomain(5, 5), IntervalIntDomain(15, 15),
+                       IntervalIntDomain(10, 10),
+                       IntervalDomain(1.0, 1.0), "myReusable");
+
+    // the overlap goes unnoticed by propagation
+    CPPUNIT_ASSERT(ce->propagate());
+
+    std::string config = "<Solver name=\"LazyProfiles\"/>";
+    TiXmlElement* configXml = initXml(config);
+    SOLVERS::Solver solver(db, *configXml);
+    CPPUNIT_ASSERT(!solver.solve());
+    CPPUNIT_ASSERT(solver.isExhausted());
+    delete configXml;
+    return true;
+  }
+
+  /**
+   * @brief ThreatDecisionPoint asks for a few more ordering choices each time it runs out, so a resource
+   * must give them in the same order however many are asked for.
+   */
+  static bool testLazyThreatChoices() {
+    RESOURCE_DEFAULT_SETUP(ceObj, dbObj, false);
+
+    PlanDatabaseId db = dbObj.getId();
+    ConstraintEngineId ce = ceObj.getId();
+    DbClientId client = db->getClient();
+
+    Reusable reusable(db, "Reusable", "myReusable", "ClosedWorldFVDetector", "IncrementalFlowProfile", 1, 1, 0);
+    ReusableToken tok1(db, "Reusable.uses", IntervalIntDomain(0, 20), IntervalIntDomain(5, 25), IntervalIntDomain(5, 5),
+                       IntervalDomain(1.0, 1.0), "myReusable");
+    ReusableToken tok2(db, "Reusable.uses", IntervalIntDomain(0, 20), IntervalIntDomain(5, 25), IntervalIntDomain(5, 5),
+                       IntervalDomain(1.0, 1.0), "myReusable");
+    ReusableToken tok3(db, "Reusable.uses", IntervalIntDomain(0, 20), IntervalIntDomain(5, 25), IntervalIntDomain(5, 5),
+                       IntervalDomain(1.0, 1.0), "myReusable");
+
+    Reusable other(db, "Reusable", "otherReusable", "ClosedWorldFVDetector", "IncrementalFlowProfile", 1, 1, 0);
+    ReusableToken tok4(db, "Reusable.uses", IntervalIntDomain(0, 20), IntervalIntDomain(5, 25), IntervalIntDomain(5, 5),
+                       IntervalDomain(1.0, 1.0), "otherReusable");
+    ReusableToken tok5(db, "Reusable.uses", IntervalIntDomain(0, 20), IntervalIntDomain(5, 25), IntervalIntDomain(5, 5),
+                       IntervalDomain(1.0, 1.0), "otherReusable");
+
+    CPPUNIT_ASSERT(ce->propagate());
+    CPPUNIT_ASSERT(reusable.hasTokensToOrder() && other.hasTokensToOrder());
+
+    std::vector<std::pair<TokenId, TokenId> > all;
+    reusable.getOrderingChoices(tok1.getId(), all);
+    CPPUNIT_ASSERT(all.size() > 2);
+    for(unsigned long limit = 1; limit < all.size(); limit++) {
+      std::vector<std::pair<TokenId, TokenId> > some;
+      reusable.getOrderingChoices(tok1.getId(), some, limit);
+      CPPUNIT_ASSERT(some.size() == limit && std::equal(some.begin(), some.end(), all.begin()));
+    }
+
+    // Every choice on the other resource involves the token to order, so the decision can step through them all
+    all.clear();
+    other.getOrderingChoices(tok4.getId(), all);
+    CPPUNIT_ASSERT(!all.empty());
+
+    TiXmlElement dummy("");
+    SOLVERS::ThreatDecisionPoint threat(client, tok4.getId(), dummy);
+    SOLVERS::DecisionPoint& threatDecision = threat;
+    threat.initialize();
+    for(unsigned int i = 0; i < all.size(); i++) {
+      CPPUNIT_ASSERT(threatDecision.hasNext());
+      threatDecision.execute();
+      SOLVERS::ChoiceSignature signature;
+      CPPUNIT_ASSERT(threat.getChoiceSignature(signature));
+      CPPUNIT_ASSERT(signature.second.first == all[i].first->getKey());
+      CPPUNIT_ASSERT(signature.second.second == all[i].second->getKey());
+      threatDecision.undo();
+    }
+    CPPUNIT_ASSERT(!threatDecision.hasNext());
+    CPPUNIT_ASSERT(threat.getChoicesBuilt() == all.size());
+
+    RESOURCE_DEFAULT_TEARDOWN();
+    return true;
+  }
+
+  /**
+   * @brief A token only uses a resource once it is assigned to it, so when the resource is
+   * over-subscribed, backjumping has to be able to go back to where the token was assigned.
+   */
+  static bool testViolationBlamesObjectDecision() {
+    RESOURCE_DEFAULT_SETUP(ceObj, dbObj, false);
+
+    PlanDatabaseId db = dbObj.getId();
+    ConstraintEngineId ce = ceObj.getId();
+
+    Reusable shared(db, "Reusable", "shared", "ClosedWorldFVDetector", "IncrementalFlowProfile", 1, 1, 0);
+    Reusable spare(db, "Reusable", "spare", "ClosedWorldFVDetector", "IncrementalFlowProfile", 1, 1, 0);
+    Reusable busy(db, "Reusable", "busy", "ClosedWorldFVDetector", "IncrementalFlowProfile", 1, 1, 0);
+    db->close();
+
+    ReusableToken blocker(db, "Reusable.uses", IntervalIntDomain(0, 0), IntervalIntDomain(10, 10),
+                          IntervalIntDomain(10, 10), IntervalDomain(1.0, 1.0), "busy");
+
+    // Decided first, and tries the shared resource before the spare one
+    ReusableToken first(db, "Reusable.uses", IntervalIntDomain(0, 0), IntervalIntDomain(10, 10),
+                        IntervalIntDomain(10, 10), IntervalDomain(1.0, 1.0));
+    std::list<ObjectId> firstObjects;
+    firstObjects.push_back(shared.getId());
+    firstObjects.push_back(spare.getId());
+    first.getObject()->restrictBaseDomain(ObjectDomain(first.getObject()->baseDomain().getDataType(), firstObjects));
+
+    // Decided last, and fails on both of its resources while the first token is on the shared one
+    ReusableToken last(db, "Reusable.uses", IntervalIntDomain(0, 0), IntervalIntDomain(10, 10),
+                       IntervalIntDomain(10, 10), IntervalDomain(1.0, 1.0));
+    std::list<ObjectId> lastObjects;
+    lastObjects.push_back(shared.getId());
+    lastObjects.push_back(busy.getId());
+    last.getObject()->restrictBaseDomain(ObjectDomain(last.getObject()->baseDomain().getDataType(), lastObjects));
+    CPPUNIT_ASSERT(ce->propagate());
+
+    std::string config =
+        "<Solver name=\"ObjectBlame\">"
+        "  <UnboundVariableManager defaultPriority=\"0\">"
+        "    <FlawHandler component=\"Min\"/>"
+        "  </UnboundVariableManager>"
+        "</Solver>";
+    TiXmlElement* configXml = initXml(config);
+    SOLVERS::Solver solver(db, *configXml);
+    solver.setBackjumping(true);
+    CPPUNIT_ASSERT(solver.solve());
+    CPPUNIT_ASSERT(first.getObject()->lastDomain().getSingletonValue() == spare.getId()->getKey());
+    CPPUNIT_ASSERT(last.getObject()->lastDomain().getSingletonValue() == shared.getId()->getKey());
+    delete configXml;
+
+    RESOURCE_DEFAULT_TEARDOWN();
+    return true;
+  }
 };
 
 void ResourceModuleTests::cppSetup(void)
@@ -0,0 +1,50 @@
+#include "PlanDatabaseFork.hh"
+#include "RulesEngine.hh"
+#include "PlanDatabase.hh"
+#include "ConstraintEngine.hh"
+#include "DbClient.hh"
+#include "DbClientTransactionLog.hh"
+#include "DbClientTransactionPlayer.hh"
+#include "Debug.hh"
+
+namespace EUROPA {
+
+  PlanDatabaseFork::PlanDatabaseFork(const RulesEngineId parent,
+                                     const DbClientTransactionLogId transactions)
+    : m_constraintEngine(), m_planDatabase(), m_rulesEngine(), m_transactionLog() {
+    check_error(parent.isValid());
+    check_error(transactions.isValid());
+    const PlanDatabaseId parentDb = parent->getPlanDatabase();
+    checkError(!transactions->isStreaming(), "Cannot fork from a streaming transaction log.");
+
+    m_constraintEngine = parentDb->getConstraintEngine()->fork();
+    m_planDatabase = parentDb->fork(m_constraintEngine);
+    m_rulesEngine = (new RulesEngine(parent->getRuleSchema(), m_planDatabase))->getId();
+
+    DbClientId client = m_planDatabase->getClient();
+    client->enableTransactionLogging();
+    m_transactionLog = (new DbClientTransactionLog(client))->getId();
+
+    debugMsg("PlanDatabaseFork:PlanDatabaseFork", "Forking " << parentDb->getId());
+    DbClientTransactionPlayer player(client);
+    player.play(transactions);
+    m_constraintEngine->propagate();
+  }
+
+  PlanDatabaseFork::~PlanDatabaseFork() {
+    // Remove the plan first so that the rules engine sees all of its instances undone
+    m_planDatabase->purge();
+    delete static_cast<RulesEngine*>(m_rulesEngine);
+    delete static_cast<DbClientTransactionLog*>(m_transactionLog);
+    delete static_cast<PlanDatabase*>(m_planDatabase);
+    delete static_cast<ConstraintEngine*>(m_constraintEngine);
+  }
+
+  const ConstraintEngineId PlanDatabaseFork::getConstraintEngine() const {return m_constraintEngine;}
+
+  const PlanDatabaseId PlanDatabaseFork::getPlanDatabase() const {return m_planDatabase;}
+
+  const RulesEngineId PlanDatabaseFork::getRulesEngine() const {return m_rulesEngine;}
+
+  const DbClientTransactionLogId PlanDatabaseFork::getTransactionLog() const {return m_transactionLog;}
+}
@@ -0,0 +1,49 @@
+#ifndef _H_PlanDatabaseFork
+#define _H_PlanDatabaseFork
+
+/**
+ * @file PlanDatabaseFork.hh
+ * @brief Independent copies of a plan database for speculative search
+ * @ingroup RulesEngine
+ */
+
+#include "RulesEngineDefs.hh"
+
+namespace EUROPA {
+
+  /**
+   * @class PlanDatabaseFork
+   * @brief Owns a constraint engine, plan database and rules engine forked from a parent, populated by
+   * replaying the transactions the parent has logged so far.
+   *
+   * Schemas, rule definitions and engine registries are shared with the parent; everything mutable
+   * belongs to the fork. Distinct forks can therefore be searched in separate threads once constructed.
+   * The parent must have been logging transactions (with DbClient::enableTransactionLogging()) since
+   * it was created, and must not be modified while a fork is being built.
+   */
+  class PlanDatabaseFork {
+  public:
+    PlanDatabaseFork(const RulesEngineId parent, const DbClientTransactionLogId transactions);
+    ~PlanDatabaseFork();
+
+    const ConstraintEngineId getConstraintEngine() const;
+    const PlanDatabaseId getPlanDatabase() const;
+    const RulesEngineId getRulesEngine() const;
+
+    /**
+     * @brief The transactions played into the fork and any made on it since, so that it can be forked in turn.
+     */
+    const DbClientTransactionLogId getTransactionLog() const;
+
+  private:
+    PlanDatabaseFork(const PlanDatabaseFork&);
+    PlanDatabaseFork& operator=(const PlanDatabaseFork&);
+
+    ConstraintEngineId m_constraintEngine;
+    PlanDatabaseId m_planDatabase;
+    RulesEngineId m_rulesEngine;
+    DbClientTransactionLogId m_transactionLog;
+  };
+}
+
+#endif
@@ -17,6 +17,10 @@
 #include "Constraint.hh"
 #include "CESchema.hh"
 #include "TestUtils.hh"
+#include "TokenType.hh"
+#include "DbClient.hh"
+#include "DbClientTransactionLog.hh"
+#include "PlanDatabaseFork.hh"
 
 #include "Constraints.hh"
 #include "ModuleConstraintEngine.hh"
@@ -211,6 +215,18 @@ void LocalVariableGuard_0_0::handleExecute(){
   addSlave(new IntervalToken(m_token, "any", LabelStr("AllObjects.Predicate")));
 }
 
+class PredicateTokenType: public TokenType {
+public:
+  PredicateTokenType(const ObjectTypeId ot) : TokenType(ot, LabelStr("AllObjects.Predicate")) {}
+private:
+  TokenId createInstance(const PlanDatabaseId planDb, const LabelStr& name, bool rejectable, bool isFact) const {
+    return (new IntervalToken(planDb, name, rejectable, isFact))->getId();
+  }
+  TokenId createInstance(const TokenId master, const LabelStr& name, const LabelStr& relation) const {
+    return (new IntervalToken(master, relation, name))->getId();
+  }
+};
+
 class RETestEngine : public EngineBase
 {
   public:
@@ -315,6 +331,7 @@ public:
     EUROPA_runTest(testPurge);
     EUROPA_runTest(testGNATS_3157);
     EUROPA_runTest(testProxyVariableRelation);
+    EUROPA_runTest(testFork);
     return true;
   }
 private:
@@ -691,6 +708,53 @@ private:
 
     return true;
   }
+
+  static bool testFork(){
+    RE_DEFAULT_SETUP(ce, db, false);
+    ObjectTypeId ot = schema->getObjectType("AllObjects");
+    TokenTypeId tt = (new PredicateTokenType(ot))->getId();
+    ot->addTokenType(tt);
+    schema->registerTokenType(tt);
+    re->getRuleSchema()->registerRule((new SimpleSubGoal())->getId());
+
+    DbClientId client = db->getClient();
+    client->enableTransactionLogging();
+    DbClientTransactionLog txLog(client);
+    client->createObject("AllObjects", "forkObj");
+    client->close();
+    TokenId t0 = client->createToken("AllObjects.Predicate", "t0", false);
+    client->activate(t0);
+    CPPUNIT_ASSERT(client->propagate());
+    CPPUNIT_ASSERT(db->getTokens().size() == 2);
+
+    {
+      PlanDatabaseFork fork(re, txLog.getId());
+      PlanDatabaseId child = fork.getPlanDatabase();
+      CPPUNIT_ASSERT(child != db);
+      CPPUNIT_ASSERT(child->getSchema() == schema);
+      CPPUNIT_ASSERT(fork.getConstraintEngine() != ce);
+      CPPUNIT_ASSERT(fork.getRulesEngine()->getRuleSchema() == re->getRuleSchema());
+      CPPUNIT_ASSERT(child->getTokens().size() == 2);
+
+      TokenId c0 = child->getClient()->getTokenByPath(client->getPathByToken(t0));
+      CPPUNIT_ASSERT(c0.isValid() && c0 != t0);
+      CPPUNIT_ASSERT(c0->isActive() && c0->slaves().size() == 1);
+
+      // Changes to the fork leave the parent alone, and are carried over when the fork is forked
+      child->getClient()->cancel(c0);
+      CPPUNIT_ASSERT(child->getTokens().size() == 1);
+      CPPUNIT_ASSERT(db->getTokens().size() == 2);
+      CPPUNIT_ASSERT(t0->isActive());
+
+      PlanDatabaseFork grandChild(fork.getRulesEngine(), fork.getTransactionLog());
+      CPPUNIT_ASSERT(grandChild.getPlanDatabase()->getTokens().size() == 1);
+      CPPUNIT_ASSERT(child->getTokens().size() == 1);
+    }
+
+    CPPUNIT_ASSERT(db->getTokens().size() == 2);
+    CPPUNIT_ASSERT(ce->propagate());
+    return true;
+  }
 };
 
 /*void RulesEngineModuleTests::runTests(std::string path)
@@ -3,11 +3,27 @@
 
 #include "Engine.hh"
 #include "PSList.hh"
+#include "PSEntity.hh"
 #include <string>
 
 namespace EUROPA 
 {
   class PSSolver;
+
+  /**
+   * @brief A forward view over the open flaws which describes each one without formatting it as a string.
+   * Only valid until the solver next steps. The caller owns it.
+   */
+  class PSFlawIterator
+  {
+    public:
+      virtual ~PSFlawIterator() {}
+      virtual bool done() const = 0;
+      virtual void next() = 0;
+      virtual PSEntityKey getEntityKey() const = 0;
+      virtual const std::string& getFlawManager() const = 0; /*!< The name of the manager responsible for the flaw */
+      virtual double getPriority() const = 0;
+  };
   
   class PSSolverManager : public EngineComponent
   {
@@ -38,6 +54,7 @@ class PSSolver {
   virtual bool hasFlaws() = 0;	
 
   virtual PSList<std::string> getFlaws() = 0;	
+  virtual PSFlawIterator* getFlawIterator() = 0;
   virtual std::string getLastExecutedDecision() = 0;	
 
   // TODO: should horizon start and end be part of configuration?
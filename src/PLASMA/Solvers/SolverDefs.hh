@@ -47,6 +47,12 @@ namespace EUROPA {
      */
     typedef std::pair<LabelStr, edouble> GuardEntry;
 
+    /**
+     * @brief Identifies the choice made by a decision well enough to recognise the same choice made on another path.
+     * @see DecisionPoint::getChoiceSignature
+     */
+    typedef std::pair<edouble, std::pair<edouble, edouble> > ChoiceSignature;
+
     static Priority & worstCasePriority() {
       static Priority sl_worstCasePriority(99999);
       return sl_worstCasePriority;
@@ -35,7 +35,10 @@ FlawManager::FlawManager(const TiXmlElement& configData)
     , m_dynamicFiltersByKey()
     , m_flawHandlerGuards()
     , m_activeFlawHandlersByKey()
+    , m_priorityByKey()
     , m_timestamp(0)
+    , m_tieBreakSeed(0)
+    , m_activity(NULL)
     , m_context()
 {
 }
@@ -143,6 +146,8 @@ FlawManager::FlawManager(const TiXmlElement& configData)
           eint targetKey = listener->getTarget()->getKey();
           double weight = listener->getHandler()->getWeight();
 
+          m_priorityByKey.erase(targetKey);
+
           debugMsg("FlawManager:notifyRemoved:Constraint", "Looking for active flaw handlers on target key.");
           std::map<eint, FlawHandlerEntry>::iterator activeFlawHandlerEntry = m_activeFlawHandlersByKey.find(targetKey);
           if(activeFlawHandlerEntry != m_activeFlawHandlersByKey.end()) {
@@ -196,6 +201,7 @@ FlawManager::FlawManager(const TiXmlElement& configData)
 
       condDebugMsg(m_activeFlawHandlersByKey.find(var->getKey()) != m_activeFlawHandlersByKey.end(), "FlawManager:erase:active", " [" << __FILE__ << ":" << __LINE__ << "] removing entries with key " << var->getKey() << " from m_activeFlawHandlersByKey");
       m_activeFlawHandlersByKey.erase(var->getKey());
+      m_priorityByKey.erase(var->getKey());
 
       condDebugMsg(m_staticFiltersByKey.find(var->getKey()) != m_staticFiltersByKey.end(), "FlawManager:erase:static", " [" << __FILE__ << ":" << __LINE__ << "] removing entries with key " << var->getKey() << " from m_staticFiltersByKey");
       m_staticFiltersByKey.erase(var->getKey());
@@ -216,6 +222,8 @@ FlawManager::FlawManager(const TiXmlElement& configData)
             eint targetKey = listener->getTarget()->getKey();
             double weight = listener->getHandler()->getWeight();
 
+            m_priorityByKey.erase(targetKey);
+
             debugMsg("FlawManager:notifyRemoved", "Looking for active flaw handlers on target key.");
             std::map<eint, FlawHandlerEntry>::iterator activeFlawHandlerEntry = m_activeFlawHandlersByKey.find(targetKey);
             if(activeFlawHandlerEntry != m_activeFlawHandlersByKey.end()) {
@@ -259,6 +267,7 @@ FlawManager::FlawManager(const TiXmlElement& configData)
 
         condDebugMsg(m_activeFlawHandlersByKey.find(var->parent()->getKey()) != m_activeFlawHandlersByKey.end(), "FlawManager:erase:active", " [" << __FILE__ << ":" << __LINE__ << "] removing entries with key " << var->parent()->getKey() << " from m_activeFlawHandlersByKey");
         m_activeFlawHandlersByKey.erase(var->parent()->getKey());
+        m_priorityByKey.erase(var->parent()->getKey());
 
         condDebugMsg(m_staticFiltersByKey.find(var->parent()->getKey()) != m_staticFiltersByKey.end(), "FlawManager:erase:static", " [" << __FILE__ << ":" << __LINE__ << "] removing entries with key " << var->parent()->getKey() << " from m_staticFiltersByKey");
         m_staticFiltersByKey.erase(var->parent()->getKey());
@@ -290,6 +299,7 @@ FlawManager::FlawManager(const TiXmlElement& configData)
 
       condDebugMsg(m_activeFlawHandlersByKey.find(token->getKey()) != m_activeFlawHandlersByKey.end(), "FlawManager:erase:active", " [" << __FILE__ << ":" << __LINE__ << "] removing entries with key " << token->getKey() << " from m_activeFlawHandlersByKey");
       m_activeFlawHandlersByKey.erase(token->getKey());
+      m_priorityByKey.erase(token->getKey());
 
       condDebugMsg(m_staticFiltersByKey.find(token->getKey()) != m_staticFiltersByKey.end(), "FlawManager:erase:static", " [" << __FILE__ << ":" << __LINE__ << "] removing entries with key " << token->getKey() << " from m_staticFiltersByKey");
       m_staticFiltersByKey.erase(token->getKey());
@@ -499,12 +509,27 @@ FlawManager::FlawManager(const TiXmlElement& configData)
       return false;
     }
 
+    /**
+     * The priority is a function of the active flaw handler, which only changes when guards fire
+     * (notifyActivated/notifyDeactivated) or the entity goes away, so it is cached by key rather
+     * than re-derived for every candidate on every call to next().
+     */
     Priority FlawManager::getPriority(const EntityId entity){
       debugMsg("FlawManager:getPriority", "Getting priority for " << entity->getKey());
+      std::map<eint, Priority>::const_iterator it = m_priorityByKey.find(entity->getKey());
+      if(it != m_priorityByKey.end()){
+        debugMsg("FlawManager:getPriority", "Returning cached priority " << it->second);
+        return it->second;
+      }
+
+      // Loading the handler may propagate guards and so call back into notifyActivated, hence
+      // the cache is only written once the handler is settled.
       FlawHandlerId flawHandler = getFlawHandler(entity);
       checkError(flawHandler.isValid(), "No flawHandler for " << entity->toString());
-      debugMsg("FlawManager:getPriority", "Returning priority " << flawHandler->getPriority(entity));
-      return flawHandler->getPriority(entity);
+      Priority priority = flawHandler->getPriority(entity);
+      m_priorityByKey.insert(std::make_pair(entity->getKey(), priority));
+      debugMsg("FlawManager:getPriority", "Returning priority " << priority);
+      return priority;
     }
 
     /**
@@ -518,6 +543,7 @@ FlawManager::FlawManager(const TiXmlElement& configData)
       checkError(flawHandler.isValid(), "On " << sl_counter << ": No flawHandler for " << entity->toString());
       DecisionPointId dp =  flawHandler->create(m_db->getClient(), entity, explanation);
       dp->setCutoff(flawHandler->getMaxChoices());
+      dp->setFlawHandler(flawHandler);
       return dp;
     }
 
@@ -532,7 +558,7 @@ FlawManager::FlawManager(const TiXmlElement& configData)
 
     std::map<eint, FlawHandlerEntry >::const_iterator it = m_activeFlawHandlersByKey.find(entity->getKey());
     if(it != m_activeFlawHandlersByKey.end()){
-      FlawHandlerEntry entry = it->second;
+      const FlawHandlerEntry& entry = it->second;
       FlawHandlerEntry::const_iterator entryIt = entry.end();
       FlawHandlerId flawHandler = (--entryIt)->second;
 
@@ -612,6 +638,7 @@ FlawManager::FlawManager(const TiXmlElement& configData)
                  "We should have at least one entry for a standard handler for entity " << target->getKey() << " handler " << flawHandler->toString());
       FlawHandlerEntry& entry = it->second;
       entry.insert(std::pair<double, FlawHandlerId>(flawHandler->getWeight(),flawHandler ));
+      m_priorityByKey.erase(target->getKey());
       debugMsg("FlawManager:notifyActivated", "Added active FlawHandler " << flawHandler->toString() << std::endl << " for entity " << target->getKey());
       condDebugMsg(!isValid(), "FlawManager:isValid", "Invalid datastructures in flaw manger.");
     }
@@ -627,6 +654,7 @@ FlawManager::FlawManager(const TiXmlElement& configData)
       for(FlawHandlerEntry::iterator handlerIt = entry.begin(); handlerIt != entry.end(); ++handlerIt){
         if(handlerIt->second == flawHandler){
           entry.erase(handlerIt);
+          m_priorityByKey.erase(target->getKey());
           condDebugMsg(!isValid(), "FlawManager:isValid", "Invalid datastructures in flaw manger.");
           return;
         }
@@ -635,6 +663,8 @@ FlawManager::FlawManager(const TiXmlElement& configData)
 
     bool FlawManager::betterThan(const EntityId a, const EntityId b, LabelStr& explanation){
       if(a.isId() && b.isId()) {
+        if(m_tieBreakSeed != 0)
+          return breakTie(a, b, explanation);
         explanation = "higherKey";
         return (a->getKey() > b->getKey());
       }
@@ -645,6 +675,43 @@ FlawManager::FlawManager(const TiXmlElement& configData)
       }
     }
 
+    void FlawManager::setTieBreaking(unsigned int seed, const std::map<eint, double>* activity){
+      m_tieBreakSeed = seed;
+      m_activity = activity;
+    }
+
+    namespace {
+      /**
+       * @brief Scrambles an entity key so that keys compare in an order fixed by the seed.
+       */
+      unsigned long scramble(long key, unsigned int seed){
+        unsigned long x = static_cast<unsigned long>(key) * 2654435761UL + seed;
+        x ^= x >> 15;
+        x *= 2246822519UL;
+        x ^= x >> 13;
+        return x;
+      }
+    }
+
+    bool FlawManager::breakTie(const EntityId a, const EntityId b, LabelStr& explanation) const {
+      if(m_tieBreakSeed == 0 || a.isNoId() || b.isNoId())
+        return false;
+
+      if(m_activity != NULL){
+        std::map<eint, double>::const_iterator itA = m_activity->find(a->getKey());
+        std::map<eint, double>::const_iterator itB = m_activity->find(b->getKey());
+        const double activityA = (itA == m_activity->end() ? 0 : itA->second);
+        const double activityB = (itB == m_activity->end() ? 0 : itB->second);
+        if(activityA != activityB){
+          explanation = "activity";
+          return activityA > activityB;
+        }
+      }
+
+      explanation = "random";
+      return scramble(cast_long(a->getKey()), m_tieBreakSeed) > scramble(cast_long(b->getKey()), m_tieBreakSeed);
+    }
+
     std::string FlawManager::toString(const EntityId entity) const {
       return entity->toString();
     }
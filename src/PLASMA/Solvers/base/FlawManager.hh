@@ -80,7 +80,8 @@ namespace EUROPA {
       bool matches(const EntityId entity);
 
       /**
-       * @brief Obtain the priority for the given entity
+       * @brief Obtain the priority for the given entity. The result is cached until the set of
+       * active flaw handlers for the entity changes, or the entity is removed.
        */
       Priority getPriority(const EntityId entity);
 
@@ -158,6 +159,15 @@ namespace EUROPA {
 
       virtual bool noMoreFlaws() = 0;
 
+      /**
+       * @brief Break ties between equally preferred flaws in a seeded random order, preferring flaws
+       * with higher activity when given.
+       * @param seed Seed for the order. Zero restores the default, deterministic tie breaking.
+       * @param activity Optional activity scores by entity key. Must outlive its use here.
+       * @see breakTie
+       */
+      void setTieBreaking(unsigned int seed, const std::map<eint, double>* activity = NULL);
+
     protected:
 
       FlawManager(const TiXmlElement& configData);
@@ -174,6 +184,13 @@ namespace EUROPA {
 
       virtual bool betterThan(const EntityId a, const EntityId b, LabelStr& explanation);
 
+      /**
+       * @brief Final tie breaker for betterThan when randomized tie breaking is on.
+       * @return true if a is to be preferred to b. Always false when tie breaking is off.
+       * @see setTieBreaking
+       */
+      bool breakTie(const EntityId a, const EntityId b, LabelStr& explanation) const;
+
       PlanDatabaseId m_db;
 
     private:
@@ -188,7 +205,10 @@ namespace EUROPA {
       Eint2FlawFilterVectorMap m_dynamicFiltersByKey;
       std::multimap<eint, ConstraintId> m_flawHandlerGuards; /*!< Flaw Handler Guard constraints by Entity Key */
       std::map<eint, FlawHandlerEntry> m_activeFlawHandlersByKey; /*!< Applicable Flaw Handlers for each entity */
+      std::map<eint, Priority> m_priorityByKey; /*!< Cached priority of the active Flaw Handler for each entity */
       unsigned int m_timestamp; /*!< Used for testing for stale iterators */
+      unsigned int m_tieBreakSeed; /*!< Zero unless ties are broken at random */
+      const std::map<eint, double>* m_activity; /*!< Optional activity scores for tie breaking */
       ContextId m_context;
       //static const Priority BEST_CASE_PRIORITY = 0;
     };
@@ -9,6 +9,8 @@
 #include "SolverUtils.hh"
 #include "tinyxml.h"
 
+#include <boost/functional/hash.hpp>
+
 namespace EUROPA {
 namespace SOLVERS {
 
@@ -27,7 +29,8 @@ MatchingEngine::MatchingEngine(EngineId engine,
     , m_cycleCount(1),
       m_rules(),
       m_rulesByExpression(),
-      m_unfilteredRules() {
+      m_unfilteredRules(),
+      m_matchTable() {
   // Now load all the flaw managers
   std::string ruleTagStr(ruleTag);
 
@@ -67,6 +70,7 @@ MatchingEngine::~MatchingEngine() {
       debugMsg("MatchingEngine:registerRule", rule->toString());
 
       m_rules.insert(rule);
+      m_matchTable.clear();
 
       std::string expression = rule->toString();
       LabelStr expressionLabel(expression);
@@ -130,29 +134,39 @@ MatchingEngine::~MatchingEngine() {
     template<>
     void MatchingEngine::getMatches(const ConstrainedVariableId var,
 				    std::vector<MatchingRuleId>& results) {
-      m_cycleCount++;
-      results = m_unfilteredRules;
+      MatchKey key(MatchKey::VARIABLE);
+      key.variable = var->getName().getKey();
+      SchemaId schema;
 
       // If it has a parent, then process that too
       if(var->parent().isId()){
-        if(TokenId::convertable(var->parent()))
-          getMatchesInternal(TokenId(var->parent()), results);
-        else if(RuleInstanceId::convertable(var->parent()))
-          getMatchesInternal(RuleInstanceId(var->parent())->getToken(), results);
+        if(TokenId::convertable(var->parent())){
+          key.kind = MatchKey::TOKEN_VARIABLE;
+          describe(TokenId(var->parent()), key);
+          schema = TokenId(var->parent())->getPlanDatabase()->getSchema();
+        }
+        else if(RuleInstanceId::convertable(var->parent())){
+          TokenId token = RuleInstanceId(var->parent())->getToken();
+          key.kind = MatchKey::TOKEN_VARIABLE;
+          describe(token, key);
+          schema = token->getPlanDatabase()->getSchema();
+        }
         else if(ObjectId::convertable(var->parent())){
           ObjectId object = var->parent();
-          trigger(object->getPlanDatabase()->getSchema()->getAllObjectTypes(object->getType()), m_rulesByObjectType, results);
+          key.kind = MatchKey::OBJECT_VARIABLE;
+          key.objectType = object->getType().getKey();
+          schema = object->getPlanDatabase()->getSchema();
         }
       }
 
-      trigger(var->getName(), m_rulesByVariable, results);
+      lookup(key, schema, results);
     }
 
     template<>
     void MatchingEngine::getMatches(const TokenId token, std::vector<MatchingRuleId>& results) {
-      m_cycleCount++;
-      results = m_unfilteredRules;
-      getMatchesInternal(token, results);
+      MatchKey key(MatchKey::TOKEN);
+      describe(token, key);
+      lookup(key, token->getPlanDatabase()->getSchema(), results);
     }
 
     unsigned long MatchingEngine::ruleCount() const {
@@ -210,43 +224,107 @@ MatchingEngine::~MatchingEngine() {
              "Found " << results.size() << " matches for " << lbl.toString() << " so far.  Added " << addedCount);
   }
   }
-    /**
-     * @brief todo. Fire for all cases
-     */
-    template<>
-    void MatchingEngine::getMatchesInternal(const TokenId token, std::vector<MatchingRuleId>& results){
-      // Fire for predicate
-      LabelStr unqualifiedName = token->getUnqualifiedPredicateName();
-      debugMsg("MatchingEngine:getMatchesInternal", "Triggering matches for predicate " << unqualifiedName.toString());
-      trigger(unqualifiedName, m_rulesByPredicate, results);
+    MatchingEngine::MatchKey::MatchKey(Kind k)
+      : kind(k), hasMaster(false), variable(0), predicate(0), objectType(0), tokenName(0),
+        masterObjectType(0), masterPredicate(0), masterRelation(0) {}
+
+    bool MatchingEngine::MatchKey::operator==(const MatchKey& other) const {
+      return kind == other.kind && hasMaster == other.hasMaster && variable == other.variable &&
+        predicate == other.predicate && objectType == other.objectType && tokenName == other.tokenName &&
+        masterObjectType == other.masterObjectType && masterPredicate == other.masterPredicate &&
+        masterRelation == other.masterRelation;
+    }
 
-      // Fire for tokenName
-      LabelStr tokenName = token->getName();
-      debugMsg("MatchingEngine:getMatchesInternal", "Triggering matches for tokenName " << tokenName.toString());
-      triggerTokenByName(tokenName, m_rulesByTokenName, results);
+    size_t MatchingEngine::MatchKeyHash::operator()(const MatchKey& key) const {
+      size_t seed = static_cast<size_t>(key.kind);
+      boost::hash_combine(seed, key.hasMaster);
+      boost::hash_combine(seed, cast_double(key.variable));
+      boost::hash_combine(seed, cast_double(key.predicate));
+      boost::hash_combine(seed, cast_double(key.objectType));
+      boost::hash_combine(seed, cast_double(key.tokenName));
+      boost::hash_combine(seed, cast_double(key.masterObjectType));
+      boost::hash_combine(seed, cast_double(key.masterPredicate));
+      boost::hash_combine(seed, cast_double(key.masterRelation));
+      return seed;
+    }
 
-      SchemaId schema = token->getPlanDatabase()->getSchema();
+    void MatchingEngine::describe(const TokenId token, MatchKey& key) const {
+      key.predicate = token->getUnqualifiedPredicateName().getKey();
+      key.objectType = token->getBaseObjectType().getKey();
 
-      // Fire for class and all super classes
-      debugMsg("MatchingEngine:getMatchesInternal", "Triggering matches for object types (" << token->getBaseObjectType() << ")");
-      trigger(schema->getAllObjectTypes(token->getBaseObjectType()),
-              m_rulesByObjectType, results);
+      // Token names are matched by substring, and are often unique, so only tell tokens apart by name if we must
+      if(!m_rulesByTokenName.empty())
+        key.tokenName = token->getName().getKey();
 
-      // If it has a master, trigger on the relation
       if(token->master().isId()){
-        debugMsg("MatchingEngine:getMatchesInternal", "Triggering matches for master object types (" << token->master()->getBaseObjectType().toString() << ")");
-        trigger(schema->getAllObjectTypes(token->master()->getBaseObjectType()),
-                m_rulesByMasterObjectType, results);
-        debugMsg("MatchingEngine:getMatchesInternal", "Triggering matches for master predicate " << token->master()->getUnqualifiedPredicateName().toString());
-        trigger(token->master()->getUnqualifiedPredicateName(), m_rulesByMasterPredicate, results);
-        debugMsg("MatchingEngine:getMatchesInternal", "Triggering matches for master relation " << token->getRelation().toString());
-        trigger(token->getRelation(), m_rulesByMasterRelation, results);
+        key.hasMaster = true;
+        key.masterObjectType = token->master()->getBaseObjectType().getKey();
+        key.masterPredicate = token->master()->getUnqualifiedPredicateName().getKey();
+        key.masterRelation = token->getRelation().getKey();
+      }
+    }
+
+    void MatchingEngine::lookup(const MatchKey& key, const SchemaId schema, std::vector<MatchingRuleId>& results) {
+      MatchTable::const_iterator it = m_matchTable.find(key);
+      if(it == m_matchTable.end()){
+        std::vector<MatchingRuleId> matches;
+        compile(key, schema, matches);
+        it = m_matchTable.insert(std::make_pair(key, matches)).first;
+      }
+      results = it->second;
+    }
+
+    /**
+     * @brief Fire for all cases. Rules are returned in the order they are completed, after the unfiltered rules.
+     */
+    void MatchingEngine::compile(const MatchKey& key, const SchemaId schema, std::vector<MatchingRuleId>& results){
+      m_cycleCount++;
+      results = m_unfilteredRules;
+
+      if(key.kind == MatchKey::TOKEN || key.kind == MatchKey::TOKEN_VARIABLE){
+        // Fire for predicate
+        LabelStr unqualifiedName(key.predicate);
+        debugMsg("MatchingEngine:compile", "Triggering matches for predicate " << unqualifiedName.toString());
+        trigger(unqualifiedName, m_rulesByPredicate, results);
+
+        // Fire for tokenName
+        if(!m_rulesByTokenName.empty()){
+          LabelStr tokenName(key.tokenName);
+          debugMsg("MatchingEngine:compile", "Triggering matches for tokenName " << tokenName.toString());
+          triggerTokenByName(tokenName, m_rulesByTokenName, results);
+        }
+
+        // Fire for class and all super classes
+        LabelStr objectType(key.objectType);
+        debugMsg("MatchingEngine:compile", "Triggering matches for object types (" << objectType.toString() << ")");
+        trigger(schema->getAllObjectTypes(objectType), m_rulesByObjectType, results);
+
+        // If it has a master, trigger on the relation
+        if(key.hasMaster){
+          LabelStr masterObjectType(key.masterObjectType);
+          debugMsg("MatchingEngine:compile", "Triggering matches for master object types (" << masterObjectType.toString() << ")");
+          trigger(schema->getAllObjectTypes(masterObjectType), m_rulesByMasterObjectType, results);
+          LabelStr masterPredicate(key.masterPredicate);
+          debugMsg("MatchingEngine:compile", "Triggering matches for master predicate " << masterPredicate.toString());
+          trigger(masterPredicate, m_rulesByMasterPredicate, results);
+          LabelStr relation(key.masterRelation);
+          debugMsg("MatchingEngine:compile", "Triggering matches for master relation " << relation.toString());
+          trigger(relation, m_rulesByMasterRelation, results);
+        }
+        else { // Trigger for those registered for 'none' explicitly
+          static const LabelStr none("none");
+          debugMsg("MatchingEngine:compile", "Triggering matches for 'none' master relation.");
+          trigger(none, m_rulesByMasterRelation, results);
+        }
       }
-      else { // Trigger for those registered for 'none' explicitly
-        static const LabelStr none("none");
-        debugMsg("MatchingEngine:getMatchesInternal", "Triggering matches for 'none' master relation.");
-        trigger(none, m_rulesByMasterRelation, results);
+      else if(key.kind == MatchKey::OBJECT_VARIABLE || key.kind == MatchKey::OBJECT){
+        LabelStr objectType(key.objectType);
+        debugMsg("MatchingEngine:compile", "Triggering matches for object types (" << objectType.toString() << ")");
+        trigger(schema->getAllObjectTypes(objectType), m_rulesByObjectType, results);
       }
+
+      if(key.kind != MatchKey::TOKEN && key.kind != MatchKey::OBJECT)
+        trigger(LabelStr(key.variable), m_rulesByVariable, results);
     }
 
     void MatchingEngine::trigger(const LabelStr& lbl, 
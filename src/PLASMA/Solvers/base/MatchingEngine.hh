@@ -13,6 +13,8 @@
 #include <set>
 #include <typeinfo>
 
+#include <boost/unordered_map.hpp>
+
 namespace EUROPA {
 namespace SOLVERS {
 
@@ -34,6 +36,11 @@ class MatchFinderMgr : public EngineComponent {
   std::map<edouble, MatchFinderId> m_entityMatchers;        
 };
     
+/**
+ * @brief Matches entities against rules. Rules are indexed by each of their static filters, and the rules matched
+ * by an entity depend only on a few of its properties (see MatchKey), so the matches for each combination of
+ * properties are computed on first use and kept in a hash table until another rule is registered.
+ */
 class MatchingEngine {
  public:
   MatchingEngine(EngineId engine,const TiXmlElement& configData, const char* ruleTag = "MatchingRule");
@@ -66,10 +73,15 @@ class MatchingEngine {
   bool hasRule(const LabelStr& expression) const;
 
   /**
-   * @brief The last count of matches tried.
+   * @brief The last count of matches tried. Only incremented when matches are computed rather than found in the table.
    */
   unsigned int cycleCount() const;
 
+  /**
+   * @brief The number of distinct entity descriptions matched so far.
+   */
+  unsigned long matchTableSize() const {return m_matchTable.size();}
+
   /**
    * @brief Get the total number of registered rules.
    */
@@ -79,17 +91,59 @@ class MatchingEngine {
 
  private:
 
+  /**
+   * @brief The properties of an entity that static filters test. Entities with equal keys match the same rules.
+   */
+  struct MatchKey {
+    enum Kind {
+      TOKEN = 0,
+      VARIABLE, /*!< A variable without a parent */
+      TOKEN_VARIABLE, /*!< A variable of a token or of a rule instance on a token */
+      OBJECT_VARIABLE,
+      OBJECT /*!< Any other entity matched by the type of an object, such as a resource instant */
+    };
+
+    MatchKey(Kind k);
+    bool operator==(const MatchKey& other) const;
+
+    Kind kind;
+    bool hasMaster;
+    edouble variable;
+    edouble predicate;
+    edouble objectType;
+    edouble tokenName; /*!< Only set if some rule filters by token name */
+    edouble masterObjectType;
+    edouble masterPredicate;
+    edouble masterRelation;
+  };
+
+  struct MatchKeyHash {
+    size_t operator()(const MatchKey& key) const;
+  };
+
+  typedef boost::unordered_map<MatchKey, std::vector<MatchingRuleId>, MatchKeyHash> MatchTable;
+
+  /**
+   * @brief Fill in the token properties of a key.
+   */
+  void describe(const TokenId token, MatchKey& key) const;
+
+  /**
+   * @brief Retrieve the matches for a key, computing them if they are not in the table yet.
+   */
+  void lookup(const MatchKey& key, const SchemaId schema, std::vector<MatchingRuleId>& results);
+
+  /**
+   * @brief Compute the matches for a key by triggering rules along each index.
+   */
+  void compile(const MatchKey& key, const SchemaId schema, std::vector<MatchingRuleId>& results);
+
   /**
    * @brief Utility method to add a rule to an index if it is required.
    */
   void addFilter(const LabelStr& label, const MatchingRuleId rule, 
                  std::multimap<edouble,MatchingRuleId>& index);
 
-  template<typename T>
-  void getMatchesInternal(const T, std::vector<MatchingRuleId>&) {
-    checkError(ALWAYS_FAIL,
-               "Don't know how to match objects of type " << typeid(T).name());
-  }
   /**
    * @brief Utility method to trigger rules along a given index.
    */
@@ -125,6 +179,7 @@ class MatchingEngine {
   std::set<MatchingRuleId> m_rules; /*!< The set of all rules. */
   std::multimap<edouble, MatchingRuleId> m_rulesByExpression; /*!< All rules by expression */
   std::vector<MatchingRuleId> m_unfilteredRules; /*!< All rules without filters */
+  MatchTable m_matchTable; /*!< Matches by entity description. Cleared when a rule is registered. */
 
   std::map<edouble, MatchFinderId>& getEntityMatchers();
 };
@@ -148,10 +203,6 @@ template<>
 void MatchingEngine::getMatches(const TokenId token,
                                 std::vector<MatchingRuleId>& results);
     
-template<>
-void MatchingEngine::getMatchesInternal(const TokenId token,
-                                        std::vector<MatchingRuleId>& results);
-
 /**
  * Class for 
  */
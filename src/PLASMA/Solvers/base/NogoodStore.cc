@@ -0,0 +1,137 @@
+#include "NogoodStore.hh"
+#include "Debug.hh"
+
+#include <algorithm>
+#include <functional>
+
+/**
+ * @file NogoodStore.cc
+ * @brief Provides the implementation for NogoodStore
+ */
+
+namespace EUROPA {
+  namespace SOLVERS {
+
+    NogoodStore::NogoodStore(unsigned int capacity)
+      : m_capacity(capacity), m_nogoods(), m_index(), m_mentions(), m_hits(0), m_misses(0) {}
+
+    void NogoodStore::setCapacity(unsigned int capacity) {
+      m_capacity = capacity;
+      while(m_nogoods.size() > m_capacity)
+        evict();
+    }
+
+    void NogoodStore::add(const Nogood& nogood) {
+      if(nogood.empty() || m_capacity == 0)
+        return;
+
+      checkError(std::adjacent_find(nogood.begin(), nogood.end(), std::greater_equal<Choice>()) == nogood.end(),
+                 "Nogood choices must be sorted and unique.");
+
+      // Already stored under its first choice if stored at all
+      std::pair<Index::const_iterator, Index::const_iterator> range = m_index.equal_range(nogood.front());
+      for(Index::const_iterator it = range.first; it != range.second; ++it)
+        if(*(it->second) == nogood)
+          return;
+
+      if(m_nogoods.size() >= m_capacity)
+        evict();
+
+      m_nogoods.push_front(nogood);
+      for(Nogood::const_iterator it = nogood.begin(); it != nogood.end(); ++it)
+        m_index.insert(std::make_pair(*it, m_nogoods.begin()));
+
+      std::vector<edouble> keys;
+      getMentions(nogood, keys);
+      for(std::vector<edouble>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+        m_mentions.insert(std::make_pair(*it, m_nogoods.begin()));
+
+      debugMsg("NogoodStore:add", "Added a nogood of " << nogood.size() << " choices. Size is " << m_nogoods.size());
+    }
+
+    bool NogoodStore::mentions(const Choice& choice) const {
+      return m_index.find(choice) != m_index.end();
+    }
+
+    const NogoodStore::Nogood* NogoodStore::match(const Choice& choice, const std::set<Choice>& context) {
+      std::pair<Index::iterator, Index::iterator> range = m_index.equal_range(choice);
+      for(Index::iterator it = range.first; it != range.second; ++it) {
+        const Nogood& nogood = *(it->second);
+        bool matched = true;
+        for(Nogood::const_iterator c = nogood.begin(); matched && c != nogood.end(); ++c)
+          matched = (*c == choice || context.find(*c) != context.end());
+
+        if(matched) {
+          m_nogoods.splice(m_nogoods.begin(), m_nogoods, it->second);
+          m_hits++;
+          return &m_nogoods.front();
+        }
+      }
+
+      m_misses++;
+      return NULL;
+    }
+
+    void NogoodStore::clear() {
+      m_index.clear();
+      m_mentions.clear();
+      m_nogoods.clear();
+    }
+
+    void NogoodStore::forget(eint key) {
+      // Erasing a nogood updates the index being read, so victims are collected first
+      std::vector<Entries::iterator> victims;
+      std::pair<Mentions::const_iterator, Mentions::const_iterator> range = m_mentions.equal_range(edouble(key));
+      for(Mentions::const_iterator it = range.first; it != range.second; ++it)
+        victims.push_back(it->second);
+
+      for(std::vector<Entries::iterator>::const_iterator it = victims.begin(); it != victims.end(); ++it)
+        erase(*it);
+
+      condDebugMsg(!victims.empty(), "NogoodStore:forget",
+                   "Forgot " << victims.size() << " nogoods mentioning " << key << ". Size is " << m_nogoods.size());
+    }
+
+    void NogoodStore::getMentions(const Nogood& nogood, std::vector<edouble>& keys) {
+      for(Nogood::const_iterator it = nogood.begin(); it != nogood.end(); ++it) {
+        keys.push_back(edouble(it->first));
+        keys.push_back(it->second.first);
+        keys.push_back(it->second.second.first);
+        keys.push_back(it->second.second.second);
+      }
+      std::sort(keys.begin(), keys.end());
+      keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    }
+
+    void NogoodStore::evict() {
+      checkError(!m_nogoods.empty(), "Nothing to evict.");
+      erase(--m_nogoods.end());
+    }
+
+    void NogoodStore::erase(Entries::iterator victim) {
+      for(Nogood::const_iterator c = victim->begin(); c != victim->end(); ++c) {
+        std::pair<Index::iterator, Index::iterator> range = m_index.equal_range(*c);
+        for(Index::iterator it = range.first; it != range.second; ++it) {
+          if(it->second == victim) {
+            m_index.erase(it);
+            break;
+          }
+        }
+      }
+
+      std::vector<edouble> keys;
+      getMentions(*victim, keys);
+      for(std::vector<edouble>::const_iterator m = keys.begin(); m != keys.end(); ++m) {
+        std::pair<Mentions::iterator, Mentions::iterator> range = m_mentions.equal_range(*m);
+        for(Mentions::iterator it = range.first; it != range.second; ++it) {
+          if(it->second == victim) {
+            m_mentions.erase(it);
+            break;
+          }
+        }
+      }
+
+      m_nogoods.erase(victim);
+    }
+  }
+}
@@ -0,0 +1,107 @@
+#ifndef H_NogoodStore
+#define H_NogoodStore
+
+/**
+ * @file NogoodStore.hh
+ * @brief Bounded memory of combinations of choices known to lead to failure.
+ * @ingroup Solvers
+ */
+
+#include "SolverDefs.hh"
+
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace EUROPA {
+  namespace SOLVERS {
+
+    /**
+     * @brief Stores nogoods: sets of choices, each identified by the key of the flawed entity and a ChoiceSignature,
+     * that cannot all hold in a plan.
+     *
+     * Nogoods are indexed by each of their choices, so the solver can ask whether a choice it has just made
+     * completes a known nogood given the choices already on its stack. When full, the least recently
+     * added or matched nogood is evicted.
+     *
+     * @see Solver::setNogoodLearning
+     */
+    class NogoodStore {
+    public:
+      typedef std::pair<eint, ChoiceSignature> Choice; /*!< Flawed entity key and the choice made for it */
+      typedef std::vector<Choice> Nogood; /*!< Sorted, without duplicates */
+
+      /**
+       * @param capacity The maximum number of nogoods kept. Zero disables the store.
+       */
+      NogoodStore(unsigned int capacity = 0);
+
+      /**
+       * @brief Change the capacity, evicting the least recently used nogoods if there are too many.
+       */
+      void setCapacity(unsigned int capacity);
+
+      unsigned int getCapacity() const {return m_capacity;}
+
+      unsigned int getSize() const {return m_nogoods.size();}
+
+      /**
+       * @brief Store a nogood. Empty nogoods and nogoods already stored are ignored.
+       */
+      void add(const Nogood& nogood);
+
+      /**
+       * @brief Test if any stored nogood mentions the given choice. Cheap, and used to avoid building a context.
+       */
+      bool mentions(const Choice& choice) const;
+
+      /**
+       * @brief Look for a nogood containing the given choice with all of its other choices in the context.
+       * Counts a hit or a miss.
+       * @return The matched nogood, which becomes the most recently used, or NULL if there is none.
+       */
+      const Nogood* match(const Choice& choice, const std::set<Choice>& context);
+
+      unsigned int getHitCount() const {return m_hits;}
+
+      unsigned int getMissCount() const {return m_misses;}
+
+      /**
+       * @brief Remove all nogoods. Counters are kept.
+       */
+      void clear();
+
+      /**
+       * @brief Remove every nogood that mentions the given key, as a flawed entity or anywhere in a signature.
+       *
+       * Entity keys are never reused, so a nogood naming an entity that has been deleted can never match again.
+       * Signature values that merely equal the key are dropped as well, which only loses what was learned.
+       */
+      void forget(eint key);
+
+    private:
+      typedef std::list<Nogood> Entries;
+      typedef std::multimap<Choice, Entries::iterator> Index;
+      typedef std::multimap<edouble, Entries::iterator> Mentions;
+
+      /**
+       * @brief The flawed entity key and signature values of each choice, any of which may be an entity key.
+       */
+      static void getMentions(const Nogood& nogood, std::vector<edouble>& keys);
+
+      void evict();
+
+      void erase(Entries::iterator victim);
+
+      unsigned int m_capacity;
+      Entries m_nogoods; /*!< Most recently used first */
+      Index m_index; /*!< Every nogood under each of its choices */
+      Mentions m_mentions; /*!< Every nogood under each value it mentions */
+      unsigned int m_hits;
+      unsigned int m_misses;
+    };
+  }
+}
+
+#endif
@@ -4,6 +4,10 @@ namespace EUROPA {
 namespace SOLVERS {
 void SearchListener::notifyCreated(DecisionPointId) {};
 
+void SearchListener::notifyInitialized(DecisionPointId) {};
+
+void SearchListener::notifyExecuted(DecisionPointId) {};
+
 void SearchListener::notifyDeleted(DecisionPointId) {};
 
 void SearchListener::notifyUndone(DecisionPointId) {};
@@ -15,6 +19,10 @@ void SearchListener::notifyStepFailed(DecisionPointId) {};
 void SearchListener::notifyRetractSucceeded(DecisionPointId) {};
 
 void SearchListener::notifyRetractNotDone(DecisionPointId) {};
+
+void SearchListener::notifyNogoodHit(DecisionPointId) {};
+
+void SearchListener::notifyNogoodMiss(DecisionPointId) {};
 }
 }
 
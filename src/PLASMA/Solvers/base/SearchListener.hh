@@ -50,6 +50,16 @@ namespace EUROPA {
        */
       virtual void notifyCreated(DecisionPointId dp);
 
+      /**
+       * @brief Notify that the choices of a new decision point have been initialized.
+       */
+      virtual void notifyInitialized(DecisionPointId dp);
+
+      /**
+       * @brief Notify that a choice was applied to the plan, before the result is propagated.
+       */
+      virtual void notifyExecuted(DecisionPointId dp);
+
       /**
        * @brief Notify that a decision point was removed for some reason (i.e. backtracked over).
        * @param dp The removed decision point.
@@ -82,6 +92,17 @@ namespace EUROPA {
        */
       virtual void notifyRetractNotDone(DecisionPointId dp);
 
+      /**
+       * @brief Notify that the choice just made completes a known nogood, so it is retracted without propagation.
+       * @see Solver::setNogoodLearning
+       */
+      virtual void notifyNogoodHit(DecisionPointId dp);
+
+      /**
+       * @brief Notify that the choice just made was checked against known nogoods and completes none of them.
+       */
+      virtual void notifyNogoodMiss(DecisionPointId dp);
+
       /**
        * @brief Notify of a completed search (a consistent plan was found).
        */
@@ -96,6 +117,12 @@ namespace EUROPA {
        * @brief Notify of a failed search (the search took more steps than was allowed).
        */
       virtual void notifyTimedOut() {};
+
+      /**
+       * @brief Notify that the search was abandoned and the plan reset so that it can start over.
+       * @see Solver::solveWithRestarts
+       */
+      virtual void notifyRestarted() {};
     protected:
     private:
       SearchListenerId m_id;
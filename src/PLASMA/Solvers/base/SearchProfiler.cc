@@ -0,0 +1,263 @@
+#include "SearchProfiler.hh"
+#include "FlawHandler.hh"
+#include "Debug.hh"
+
+#include <iomanip>
+#include <ostream>
+#include <sys/time.h>
+
+/**
+ * @file SearchProfiler.cc
+ * @brief Provides the implementation for SearchProfiler
+ */
+
+namespace EUROPA {
+  namespace SOLVERS {
+
+    namespace {
+      double now() {
+        timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + tv.tv_usec / 1e6;
+      }
+
+      void charge(SearchProfiler::Profile& profile, SearchProfiler::Phase phase,
+                  double seconds, unsigned long constraintExecutions) {
+        profile.intervals[phase]++;
+        profile.seconds[phase] += seconds;
+        profile.constraintExecutions[phase] += constraintExecutions;
+      }
+
+      void writeJsonString(std::ostream& os, const std::string& str) {
+        os << '"';
+        for(std::string::const_iterator it = str.begin(); it != str.end(); ++it){
+          switch(*it){
+          case '"': os << "\\\""; break;
+          case '\\': os << "\\\\"; break;
+          case '\n': os << "\\n"; break;
+          case '\t': os << "\\t"; break;
+          default:
+            if(static_cast<unsigned char>(*it) < 0x20)
+              os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) *it << std::dec << std::setfill(' ');
+            else
+              os << *it;
+          }
+        }
+        os << '"';
+      }
+
+      void writeProfiles(std::ostream& os, const std::string& title,
+                         const std::map<std::string, SearchProfiler::Profile>& profiles) {
+        os << title << std::endl;
+        for(std::map<std::string, SearchProfiler::Profile>::const_iterator it = profiles.begin(); it != profiles.end(); ++it){
+          const SearchProfiler::Profile& profile = it->second;
+          os << "  " << it->first << std::endl
+             << "    decisions=" << profile.decisions
+             << " seconds=" << profile.totalSeconds()
+             << " constraintExecutions=" << profile.totalConstraintExecutions();
+          if(profile.decisions > 0)
+            os << " (" << ((double) profile.totalConstraintExecutions() / profile.decisions) << " per decision)";
+          os << std::endl;
+          for(int phase = SearchProfiler::GENERATE; phase < SearchProfiler::PHASE_COUNT; phase++)
+            os << "    " << std::setw(9) << std::left << SearchProfiler::getPhaseName((SearchProfiler::Phase) phase) << std::right
+               << " n=" << profile.intervals[phase]
+               << " seconds=" << profile.seconds[phase]
+               << " constraintExecutions=" << profile.constraintExecutions[phase] << std::endl;
+        }
+      }
+    }
+
+    SearchProfiler::Profile::Profile() : decisions(0) {
+      for(int phase = 0; phase < PHASE_COUNT; phase++){
+        intervals[phase] = 0;
+        seconds[phase] = 0;
+        constraintExecutions[phase] = 0;
+      }
+    }
+
+    double SearchProfiler::Profile::totalSeconds() const {
+      double total = 0;
+      for(int phase = 0; phase < PHASE_COUNT; phase++)
+        total += seconds[phase];
+      return total;
+    }
+
+    unsigned long SearchProfiler::Profile::totalConstraintExecutions() const {
+      unsigned long total = 0;
+      for(int phase = 0; phase < PHASE_COUNT; phase++)
+        total += constraintExecutions[phase];
+      return total;
+    }
+
+    SearchProfiler::SearchProfiler(const ConstraintEngineId ce, unsigned int maxTraceEvents)
+      : SearchListener(), m_counter(ce, *this), m_retracted(), m_maxTraceEvents(maxTraceEvents), m_origin(now()), m_lastTime(m_origin),
+        m_lastCount(0), m_byType(), m_byHandler(), m_total(), m_lastHandler(), m_lastHandlerIndex(0),
+        m_handlerIndex(), m_handlers(), m_trace(), m_dropped(0) {
+      addHandler("unknown", "unknown");
+    }
+
+    SearchProfiler::~SearchProfiler() {}
+
+    const char* SearchProfiler::getPhaseName(Phase phase) {
+      static const char* sl_names[PHASE_COUNT] = {"select", "generate", "execute", "propagate", "undo"};
+      checkError(phase < PHASE_COUNT, "No such phase " << phase);
+      return sl_names[phase];
+    }
+
+    void SearchProfiler::clear() {
+      m_byType.clear();
+      m_byHandler.clear();
+      m_total = Profile();
+      m_lastHandler = FlawHandlerId::noId();
+      m_lastHandlerIndex = 0;
+      m_handlerIndex.clear();
+      m_handlers.clear();
+      m_trace.clear();
+      m_dropped = 0;
+      m_origin = m_lastTime = now();
+      m_lastCount = m_counter.count;
+      m_retracted = DecisionPointId::noId();
+      addHandler("unknown", "unknown");
+    }
+
+    void SearchProfiler::addHandler(const std::string& type, const std::string& expression) {
+      HandlerEntry entry;
+      entry.type = type;
+      entry.expression = expression;
+      entry.byType = &m_byType[type];
+      entry.byHandler = &m_byHandler[expression];
+      m_handlers.push_back(entry);
+    }
+
+    unsigned int SearchProfiler::getHandlerIndex(const DecisionPointId dp) {
+      const FlawHandlerId& handler = dp->getFlawHandler();
+      if(handler.isNoId())
+        return 0;
+
+      if(handler == m_lastHandler)
+        return m_lastHandlerIndex;
+
+      std::map<FlawHandlerId, unsigned int>::const_iterator it = m_handlerIndex.find(handler);
+      if(it == m_handlerIndex.end()){
+        addHandler(handler->getName().toString(), handler->MatchingRule::toString());
+        it = m_handlerIndex.insert(std::make_pair(handler, m_handlers.size() - 1)).first;
+      }
+
+      m_lastHandler = handler;
+      m_lastHandlerIndex = it->second;
+      return it->second;
+    }
+
+    void SearchProfiler::mark(Phase phase, const DecisionPointId dp) {
+      double time = now();
+      double seconds = time - m_lastTime;
+      unsigned long constraintExecutions = m_counter.count - m_lastCount;
+      m_lastTime = time;
+      m_lastCount = m_counter.count;
+      m_retracted = DecisionPointId::noId();
+
+      charge(m_total, phase, seconds, constraintExecutions);
+
+      unsigned int handler = 0;
+      if(dp.isId()){
+        handler = getHandlerIndex(dp);
+        if(phase != SELECT){
+          charge(*m_handlers[handler].byType, phase, seconds, constraintExecutions);
+          charge(*m_handlers[handler].byHandler, phase, seconds, constraintExecutions);
+        }
+      }
+
+      if(m_trace.size() >= m_maxTraceEvents){
+        m_dropped++;
+        return;
+      }
+
+      TraceEvent event;
+      event.phase = phase;
+      event.start = time - seconds - m_origin;
+      event.duration = seconds;
+      event.constraintExecutions = constraintExecutions;
+      event.entityKey = dp.isId() ? dp->getFlawedEntityKey() : eint(0);
+      event.handler = handler;
+      m_trace.push_back(event);
+    }
+
+    void SearchProfiler::notifyCreated(DecisionPointId dp) {
+      mark(SELECT, dp);
+      const HandlerEntry& entry = m_handlers[getHandlerIndex(dp)];
+      entry.byType->decisions++;
+      entry.byHandler->decisions++;
+      m_total.decisions++;
+    }
+
+    void SearchProfiler::notifyInitialized(DecisionPointId dp) {mark(GENERATE, dp);}
+
+    void SearchProfiler::notifyExecuted(DecisionPointId dp) {mark(EXECUTE, dp);}
+
+    void SearchProfiler::notifyStepSucceeded(DecisionPointId dp) {mark(PROPAGATE, dp);}
+
+    void SearchProfiler::notifyStepFailed(DecisionPointId dp) {mark(PROPAGATE, dp);}
+
+    void SearchProfiler::notifyUndone(DecisionPointId dp) {mark(UNDO, dp);}
+
+    void SearchProfiler::notifyRetractSucceeded(DecisionPointId dp) {
+      mark(GENERATE, dp);
+      m_retracted = dp;
+    }
+
+    void SearchProfiler::notifyPropagated() {
+      if(m_retracted.isId())
+        mark(UNDO, m_retracted);
+    }
+
+    void SearchProfiler::notifyRetractNotDone(DecisionPointId dp) {mark(GENERATE, dp);}
+
+    void SearchProfiler::notifyCompleted() {mark(SELECT, DecisionPointId::noId());}
+
+    void SearchProfiler::notifyExhausted() {mark(SELECT, DecisionPointId::noId());}
+
+    void SearchProfiler::notifyTimedOut() {mark(SELECT, DecisionPointId::noId());}
+
+    void SearchProfiler::notifyRestarted() {mark(SELECT, DecisionPointId::noId());}
+
+    void SearchProfiler::write(std::ostream& os) const {
+      os << "Search profile: " << m_total.decisions << " decisions, "
+         << m_total.totalSeconds() << " seconds, "
+         << m_total.totalConstraintExecutions() << " constraint executions" << std::endl;
+      for(int phase = 0; phase < PHASE_COUNT; phase++)
+        os << "  " << std::setw(9) << std::left << getPhaseName((Phase) phase) << std::right
+           << " n=" << m_total.intervals[phase]
+           << " seconds=" << m_total.seconds[phase]
+           << " constraintExecutions=" << m_total.constraintExecutions[phase] << std::endl;
+      writeProfiles(os, "By decision type:", m_byType);
+      writeProfiles(os, "By flaw handler:", m_byHandler);
+    }
+
+    void SearchProfiler::writeTrace(std::ostream& os) const {
+      std::ios_base::fmtflags flags = os.flags();
+      std::streamsize precision = os.precision();
+      os << std::fixed << std::setprecision(3);
+
+      os << "{\"traceEvents\":[";
+      for(std::vector<TraceEvent>::const_iterator it = m_trace.begin(); it != m_trace.end(); ++it){
+        const TraceEvent& event = *it;
+        const HandlerEntry& handler = m_handlers[event.handler];
+        if(it != m_trace.begin())
+          os << ",";
+        os << std::endl << "{\"name\":\"" << getPhaseName(event.phase) << "\",\"cat\":";
+        writeJsonString(os, handler.type);
+        os << ",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+           << ",\"ts\":" << event.start * 1e6
+           << ",\"dur\":" << event.duration * 1e6
+           << ",\"args\":{\"handler\":";
+        writeJsonString(os, handler.expression);
+        os << ",\"entity\":" << event.entityKey
+           << ",\"constraintExecutions\":" << event.constraintExecutions << "}}";
+      }
+      os << std::endl << "],\"otherData\":{\"droppedEvents\":" << m_dropped << "}}" << std::endl;
+
+      os.flags(flags);
+      os.precision(precision);
+    }
+  }
+}
@@ -0,0 +1,185 @@
+#ifndef H_SearchProfiler
+#define H_SearchProfiler
+
+/**
+ * @file SearchProfiler.hh
+ * @brief A SearchListener that measures where search time goes.
+ * @ingroup Solvers
+ */
+
+#include "SearchListener.hh"
+#include "ConstraintEngineListener.hh"
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace EUROPA {
+  namespace SOLVERS {
+
+    /**
+     * @brief Attributes search time and constraint executions to decisions, by decision type and by FlawHandler.
+     *
+     * Time is measured between consecutive Solver notifications and charged to the phase the later one
+     * closes: choosing a flaw, generating choices (including choices generated on demand after an undo),
+     * executing a choice, propagating it (including the nogood check), and undoing it (including the
+     * propagation of the retraction, which the Solver defers to the next step). Every measured
+     * interval is also kept as a trace event, up to a limit, and can be written in the Chrome trace event
+     * format for offline inspection.
+     *
+     * Decisions not allocated by a FlawManager have no FlawHandler and are reported under "unknown".
+     * @see Solver::addListener
+     */
+    class SearchProfiler : public SearchListener {
+    public:
+      enum Phase {
+        SELECT = 0, /*!< Propagating at the start of a step and choosing the next flaw */
+        GENERATE,
+        EXECUTE,
+        PROPAGATE,
+        UNDO,
+        PHASE_COUNT
+      };
+
+      /**
+       * @brief Totals for a set of decisions.
+       */
+      struct Profile {
+        Profile();
+
+        unsigned int decisions; /*!< Decisions created */
+        unsigned int intervals[PHASE_COUNT];
+        double seconds[PHASE_COUNT];
+        unsigned long constraintExecutions[PHASE_COUNT];
+
+        double totalSeconds() const;
+        unsigned long totalConstraintExecutions() const;
+      };
+
+      /**
+       * @param ce The engine whose constraint executions are counted.
+       * @param maxTraceEvents Trace events beyond this many are counted but not kept.
+       */
+      SearchProfiler(const ConstraintEngineId ce, unsigned int maxTraceEvents = 100000);
+
+      ~SearchProfiler();
+
+      static const char* getPhaseName(Phase phase);
+
+      /**
+       * @brief Totals keyed by the name the FlawHandler was registered under, which identifies the decision type.
+       */
+      const std::map<std::string, Profile>& getProfilesByType() const {return m_byType;}
+
+      /**
+       * @brief Totals keyed by the FlawHandler matching expression.
+       */
+      const std::map<std::string, Profile>& getProfilesByHandler() const {return m_byHandler;}
+
+      /**
+       * @brief Totals over all decisions. Time spent choosing flaws is only counted here.
+       */
+      const Profile& getTotal() const {return m_total;}
+
+      unsigned int getTraceEventCount() const {return m_trace.size();}
+
+      unsigned int getDroppedTraceEventCount() const {return m_dropped;}
+
+      /**
+       * @brief Write a table of totals by decision type and by handler.
+       */
+      void write(std::ostream& os) const;
+
+      /**
+       * @brief Write the trace events as Chrome trace event JSON, one complete event per interval.
+       */
+      void writeTrace(std::ostream& os) const;
+
+      /**
+       * @brief Discard all totals and trace events.
+       */
+      void clear();
+
+      void notifyCreated(DecisionPointId dp);
+      void notifyInitialized(DecisionPointId dp);
+      void notifyExecuted(DecisionPointId dp);
+      void notifyStepSucceeded(DecisionPointId dp);
+      void notifyStepFailed(DecisionPointId dp);
+      void notifyUndone(DecisionPointId dp);
+      void notifyRetractSucceeded(DecisionPointId dp);
+      void notifyRetractNotDone(DecisionPointId dp);
+      void notifyCompleted();
+      void notifyExhausted();
+      void notifyTimedOut();
+      void notifyRestarted();
+
+    private:
+      struct TraceEvent {
+        Phase phase;
+        double start; /*!< Seconds since the profiler was created */
+        double duration;
+        unsigned long constraintExecutions;
+        eint entityKey;
+        unsigned int handler; /*!< Index into m_handlers */
+      };
+
+      struct HandlerEntry {
+        std::string type;
+        std::string expression;
+        Profile* byType;
+        Profile* byHandler;
+      };
+
+      /**
+       * @brief Counts constraint executions, and tells the profiler when propagation ends.
+       */
+      class Counter : public ConstraintEngineListener {
+      public:
+        Counter(const ConstraintEngineId ce, SearchProfiler& profiler)
+          : ConstraintEngineListener(ce), count(0), m_profiler(profiler) {}
+        void notifyExecuted(const ConstraintId) {count++;}
+        void notifyPropagationCompleted() {m_profiler.notifyPropagated();}
+        void notifyPropagationPreempted() {m_profiler.notifyPropagated();}
+        unsigned long count;
+      private:
+        SearchProfiler& m_profiler;
+      };
+
+      SearchProfiler(const SearchProfiler&);
+      SearchProfiler& operator=(const SearchProfiler&);
+
+      /**
+       * @brief Charge the time and constraint executions since the last mark to a phase of a decision.
+       */
+      void mark(Phase phase, const DecisionPointId dp);
+
+      /**
+       * @brief A retraction is propagated at the start of the next step, so charge it to the undo.
+       */
+      void notifyPropagated();
+
+      unsigned int getHandlerIndex(const DecisionPointId dp);
+
+      void addHandler(const std::string& type, const std::string& expression);
+
+      Counter m_counter;
+      DecisionPointId m_retracted; /*!< Set from a successful retraction until the next mark */
+      const unsigned int m_maxTraceEvents;
+      double m_origin;
+      double m_lastTime;
+      unsigned long m_lastCount;
+      std::map<std::string, Profile> m_byType;
+      std::map<std::string, Profile> m_byHandler;
+      Profile m_total;
+      FlawHandlerId m_lastHandler; /*!< Caches the lookup of handler names */
+      unsigned int m_lastHandlerIndex;
+      std::map<FlawHandlerId, unsigned int> m_handlerIndex;
+      std::vector<HandlerEntry> m_handlers; /*!< Every handler seen, after one for decisions without a handler */
+      std::vector<TraceEvent> m_trace;
+      unsigned int m_dropped;
+    };
+  }
+}
+
+#endif
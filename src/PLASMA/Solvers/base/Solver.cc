@@ -11,7 +11,9 @@
 #include "FlawHandler.hh"
 #include "Context.hh"
 #include "tinyxml.h"
+#include <algorithm>
 #include <bitset>
+#include <cstdlib>
 
 /**
  * @file Solver.cc
@@ -67,6 +69,20 @@ Solver::Solver(const PlanDatabaseId db, const TiXmlElement& configData)
   m_decisionStack(),
   m_lastExecutedDecision(),
   m_listeners(),
+  m_activity(),
+  m_collectActivity(false),
+  m_restartCount(0),
+  m_backjumping(false),
+  m_culprits(),
+  m_nogoods(),
+  m_cutCount(0),
+  m_cutsAtAllocation(),
+  m_retiredChoices(),
+  m_strategy(DEPTH_FIRST),
+  m_strategyLimit(0),
+  m_discrepancyLimit(std::numeric_limits<unsigned int>::max()),
+  m_discrepancyLimited(false),
+  m_interrupted(false),
   m_ceListener(db->getConstraintEngine(), *this),
       m_dbListener(db, *this) {
   checkError(strcmp(configData.Value(), "Solver") == 0,
@@ -75,6 +91,25 @@ Solver::Solver(const PlanDatabaseId db, const TiXmlElement& configData)
   // Extract the name of the Solver
   m_name = extractData(configData, "name");
 
+  // Extract the search strategy, if not the default
+  if(configData.Attribute("search") != NULL){
+    std::string search(configData.Attribute("search"));
+    if(search == "lds"){
+      const char* maxDiscrepancies = configData.Attribute("maxDiscrepancies");
+      setSearchStrategy(LIMITED_DISCREPANCY,
+                        maxDiscrepancies == NULL ? std::numeric_limits<unsigned int>::max() :
+                        static_cast<unsigned int>(atoi(maxDiscrepancies)));
+    }
+    else if(search == "beam"){
+      checkError(configData.Attribute("beamWidth") != NULL,
+                 "Configuration file error. Beam search needs a beamWidth attribute.");
+      setSearchStrategy(BEAM, static_cast<unsigned int>(atoi(configData.Attribute("beamWidth"))));
+    }
+    else {
+      checkError(search == "dfs", "Configuration file error. Unknown search strategy " << search);
+    }
+  }
+
   m_context = ((new Context(m_name.toString() + "Context"))->getId());
   // Initialize the common filter
   m_masterFlawFilter.initialize(configData, m_db, m_context);
@@ -124,6 +159,17 @@ Solver::~Solver(){
     }
 
     bool Solver::solve(unsigned int maxSteps, unsigned int maxDepth){
+      switch(m_strategy){
+      case LIMITED_DISCREPANCY:
+        return solveWithDiscrepancyLimit(m_strategyLimit, maxSteps, maxDepth);
+      case BEAM:
+        return solveWithBeam(m_strategyLimit, maxSteps, maxDepth);
+      default:
+        return solveDepthFirst(maxSteps, maxDepth);
+      }
+    }
+
+    bool Solver::solveDepthFirst(unsigned int maxSteps, unsigned int maxDepth){
       // Initialize the step count floor with the prior step count so we can apply limits
       m_stepCountFloor = getStepCount();
       m_depthFloor = getDepth();
@@ -133,6 +179,7 @@ Solver::~Solver(){
       // Reset the flaw found flag for a new evaluation
       m_noFlawsFound = false;
       m_timedOut = false;
+      m_interrupted = false;
 
       while(!m_timedOut && !m_exhausted && !m_noFlawsFound) step();
 
@@ -141,10 +188,560 @@ Solver::~Solver(){
                  " Stack size is " << m_decisionStack.size());
 
       debugMsg("Solver:solve", "Finished with " << m_stepCount << " steps and depth of " << m_decisionStack.size());
+      condDebugMsg(getChoiceStatistics().decisions > 0, "Solver:choiceStatistics",
+                   "Choices built per decision: " << getChoiceStatistics().averageBuilt() <<
+                   ", tried per decision: " << getChoiceStatistics().averageTried());
 
       return m_noFlawsFound;
     }
 
+    bool Solver::solveWithRestarts(unsigned int baseSteps, unsigned int maxRestarts, RestartSchedule schedule,
+                                   unsigned int seed, bool retainActivity){
+      checkError(baseSteps > 0, "Restarts need a step budget.");
+      checkError(seed > 0, "A zero seed turns off randomized tie breaking.");
+
+      // Decisions already on the stack belong to the caller and are never reset
+      const unsigned long depthFloor = getDepth();
+      m_collectActivity = retainActivity;
+      m_restartCount = 0;
+
+      bool solved = false;
+      double geometricBudget = baseSteps;
+      for(unsigned int run = 0; ; run++){
+        double budget = (schedule == LUBY_RESTARTS ? static_cast<double>(baseSteps) * lubyTerm(run + 1) : geometricBudget);
+        geometricBudget *= 1.5;
+        unsigned int maxSteps = (budget >= std::numeric_limits<unsigned int>::max() ?
+                                 std::numeric_limits<unsigned int>::max() : static_cast<unsigned int>(budget));
+
+        for(FlawManagers::const_iterator it = m_flawManagers.begin(); it != m_flawManagers.end(); ++it)
+          (*it)->setTieBreaking(seed + run, retainActivity ? &m_activity : NULL);
+
+        debugMsg("Solver:solveWithRestarts", "Run " << run << " with a budget of " << maxSteps << " steps");
+        solved = solveDepthFirst(maxSteps, std::numeric_limits<unsigned int>::max());
+        if(solved || m_exhausted || m_interrupted || run == maxRestarts)
+          break;
+
+        restart(getDepth() - depthFloor);
+        m_restartCount++;
+        publish(notifyRestarted);
+      }
+
+      for(FlawManagers::const_iterator it = m_flawManagers.begin(); it != m_flawManagers.end(); ++it)
+        (*it)->setTieBreaking(0);
+      m_collectActivity = false;
+
+      debugMsg("Solver:solveWithRestarts", "Finished after " << m_restartCount << " restarts");
+      return solved;
+    }
+
+    unsigned int Solver::getRestartCount() const {return m_restartCount;}
+
+    bool Solver::solveWithDiscrepancyLimit(unsigned int maxDiscrepancies, unsigned int maxSteps, unsigned int maxDepth){
+      const unsigned int stepCount = getStepCount();
+      bool solved = false;
+
+      for(m_discrepancyLimit = 0; ; m_discrepancyLimit++){
+        m_discrepancyLimited = false;
+        const unsigned int stepsTaken = getStepCount() - stepCount;
+        debugMsg("Solver:solveWithDiscrepancyLimit", "Allowing " << m_discrepancyLimit << " discrepancies");
+        solved = solveDepthFirst(maxSteps - std::min(maxSteps, stepsTaken), maxDepth);
+
+        // Done unless some choice was skipped for the limit, which can then be raised
+        if(solved || m_timedOut || !m_discrepancyLimited)
+          break;
+
+        if(m_discrepancyLimit >= maxDiscrepancies){
+          m_exhausted = false;
+          m_timedOut = true;
+          publish(notifyTimedOut);
+          break;
+        }
+
+        m_exhausted = false;
+        publish(notifyRestarted);
+      }
+
+      debugMsg("Solver:solveWithDiscrepancyLimit", "Finished allowing " << m_discrepancyLimit << " discrepancies");
+      m_discrepancyLimit = std::numeric_limits<unsigned int>::max();
+      return solved;
+    }
+
+    unsigned int Solver::getDiscrepancyLimit() const {return m_discrepancyLimit;}
+
+    bool Solver::exceedsDiscrepancyLimit(const DecisionPointId decision){
+      if(m_discrepancyLimit == std::numeric_limits<unsigned int>::max() || decision->getChoicesTried() == 0)
+        return false;
+
+      // Decisions on the stack past their first choice
+      unsigned int discrepancies = 0;
+      for(DecisionStack::const_iterator it = m_decisionStack.begin(); it != m_decisionStack.end(); ++it)
+        if((*it)->getChoicesTried() > 1)
+          discrepancies++;
+
+      if(discrepancies < m_discrepancyLimit)
+        return false;
+
+      m_discrepancyLimited = true;
+      return true;
+    }
+
+    namespace {
+      /**
+       * @brief Orders beam search candidates by their number of open flaws.
+       */
+      struct CandidateComparator {
+        bool operator()(const std::pair<unsigned int, std::vector<unsigned int> >& a,
+                        const std::pair<unsigned int, std::vector<unsigned int> >& b) const {
+          return a.first < b.first;
+        }
+      };
+    }
+
+    bool Solver::solveWithBeam(unsigned int width, unsigned int maxSteps, unsigned int maxDepth){
+      checkError(width > 0, "A beam must hold at least one plan.");
+      typedef std::vector<unsigned int> Choices;
+      typedef std::pair<unsigned int, Choices> Candidate; /*!< Open flaws and the choices leading to them */
+
+      // Decisions already on the stack belong to the caller and are where every plan in the beam starts
+      retract(0);
+      const unsigned long depthFloor = getDepth();
+      const unsigned int stepCount = getStepCount();
+      m_noFlawsFound = false;
+      m_exhausted = false;
+      m_timedOut = false;
+      m_interrupted = false;
+
+      m_baseConflictLevel = m_db->getConstraintEngine()->getViolation();
+      m_db->getClient()->propagate();
+      if(!conflictLevelOk()){
+        m_exhausted = true;
+        publish(notifyExhausted);
+        return false;
+      }
+
+      std::vector<Choices> beam(1);
+      bool pruned = false;
+      while(!beam.empty()){
+        std::vector<Candidate> candidates;
+        for(std::vector<Choices>::const_iterator candIt = beam.begin(); candIt != beam.end(); ++candIt){
+          const Choices& choices = *candIt;
+          const unsigned int stepsTaken = getStepCount() - stepCount;
+
+          if(stepsTaken >= maxSteps || choices.size() >= maxDepth || m_interrupted){
+            retract(getDepth() - depthFloor);
+            m_timedOut = true;
+            publish(notifyTimedOut);
+            return false;
+          }
+
+          if(!replay(choices, maxSteps - stepsTaken)){
+            // Allocation is not guaranteed to repeat itself, and a plan may no longer be rebuilt as it was
+            debugMsg("Solver:solveWithBeam", "Failed to replay a plan of " << choices.size() << " decisions");
+            retract(getDepth() - depthFloor);
+            pruned = true;
+            continue;
+          }
+
+          m_db->getClient()->propagate();
+          allocateNewDecisionPoint();
+          if(m_activeDecision.isNoId()){
+            m_db->getConstraintEngine()->propagateDeferred();
+            if(!conflictLevelOk()){
+              debugMsg("Solver:solveWithBeam", "Found a conflict completing a plan of " << choices.size() << " decisions");
+              retract(getDepth() - depthFloor);
+              pruned = true;
+              continue;
+            }
+            m_noFlawsFound = true;
+            publish(notifyCompleted);
+            debugMsg("Solver:solveWithBeam", "Found a plan of " << getDepth() << " decisions");
+            return true;
+          }
+
+          // Try every choice, keeping those that are consistent
+          for(unsigned int index = 0;
+              !m_activeDecision->cut() && m_activeDecision->hasNext() && getStepCount() - stepCount < maxSteps;
+              index++){
+            m_activeDecision->execute();
+            publish(notifyExecuted,m_activeDecision);
+            m_db->getClient()->propagate();
+            m_stepCount++;
+
+            if(conflictLevelOk()){
+              publish(notifyStepSucceeded,m_activeDecision);
+              candidates.push_back(Candidate(getFlawCount(), choices));
+              candidates.back().second.push_back(index);
+            }
+            else
+              publish(notifyStepFailed,m_activeDecision);
+
+            m_activeDecision->undo();
+            publish(notifyUndone,m_activeDecision);
+          }
+
+          retract(getDepth() - depthFloor);
+        }
+
+        // Keep the plans with the fewest open flaws. The sort is stable so ties go to the preferred choices.
+        std::stable_sort(candidates.begin(), candidates.end(), CandidateComparator());
+        if(candidates.size() > width){
+          candidates.resize(width);
+          pruned = true;
+        }
+
+        beam.clear();
+        for(std::vector<Candidate>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+          beam.push_back(it->second);
+
+        debugMsg("Solver:solveWithBeam", "Beam of " << beam.size() << " plans after " << getStepCount() - stepCount << " steps");
+      }
+
+      if(pruned || depthFloor > 0){
+        m_timedOut = true;
+        publish(notifyTimedOut);
+      }
+      else {
+        m_exhausted = true;
+        publish(notifyExhausted);
+      }
+      return false;
+    }
+
+    bool Solver::replay(const std::vector<unsigned int>& choices, unsigned int maxSteps){
+      checkError(m_activeDecision.isNoId(), "Cannot replay with an active decision.");
+      const unsigned int stepCount = getStepCount();
+
+      for(std::vector<unsigned int>::const_iterator choiceIt = choices.begin(); choiceIt != choices.end(); ++choiceIt){
+        if(getStepCount() - stepCount >= maxSteps)
+          return false;
+
+        m_db->getClient()->propagate();
+        allocateNewDecisionPoint();
+        if(m_activeDecision.isNoId())
+          return false;
+
+        // Pass over earlier choices without propagating, as backtracking does
+        while(m_activeDecision->getChoicesTried() < *choiceIt && !m_activeDecision->cut() && m_activeDecision->hasNext()){
+          m_activeDecision->execute();
+          m_activeDecision->undo();
+        }
+
+        if(m_activeDecision->getChoicesTried() < *choiceIt || m_activeDecision->cut() || !m_activeDecision->hasNext())
+          return false;
+
+        m_activeDecision->execute();
+        publish(notifyExecuted,m_activeDecision);
+        m_db->getClient()->propagate();
+        m_stepCount++;
+
+        if(!conflictLevelOk()){
+          publish(notifyStepFailed,m_activeDecision);
+          return false;
+        }
+
+        m_decisionStack.push_back(m_activeDecision);
+        publish(notifyStepSucceeded,m_activeDecision);
+        m_activeDecision = DecisionPointId::noId();
+      }
+
+      return true;
+    }
+
+    Solver::SearchStrategy Solver::getSearchStrategy() const {return m_strategy;}
+
+    void Solver::setSearchStrategy(SearchStrategy strategy, unsigned int limit){
+      checkError(strategy != BEAM || limit > 0, "A beam must hold at least one plan.");
+      m_strategy = strategy;
+      m_strategyLimit = limit;
+    }
+
+    unsigned int Solver::lubyTerm(unsigned int i){
+      checkError(i > 0, "The Luby sequence starts at 1.");
+      unsigned int k = 1;
+      while(((1u << k) - 1) < i)
+        k++;
+      if(i == (1u << k) - 1)
+        return 1u << (k - 1);
+      return lubyTerm(i - (1u << (k - 1)) + 1);
+    }
+
+    void Solver::setBackjumping(bool enabled){
+      m_backjumping = enabled;
+      m_culprits.clear();
+    }
+
+    void Solver::setNogoodLearning(unsigned int capacity){
+      m_nogoods.setCapacity(capacity);
+    }
+
+    const NogoodStore& Solver::getNogoodStore() const {return m_nogoods;}
+
+    Solver::ChoiceStatistics Solver::getChoiceStatistics() const {
+      ChoiceStatistics stats(m_retiredChoices);
+      DecisionStack live(m_decisionStack);
+      if(m_activeDecision.isId())
+        live.push_back(m_activeDecision);
+
+      for(DecisionStack::const_iterator it = live.begin(); it != live.end(); ++it){
+        DecisionPointId dp = *it;
+        if(!dp->isInitialized())
+          continue;
+        stats.decisions++;
+        stats.built += dp->getChoicesBuilt();
+        stats.tried += dp->getChoicesTried();
+      }
+      return stats;
+    }
+
+    void Solver::retire(const DecisionPointId decision){
+      if(decision->isInitialized()){
+        m_retiredChoices.decisions++;
+        m_retiredChoices.built += decision->getChoicesBuilt();
+        m_retiredChoices.tried += decision->getChoicesTried();
+      }
+      decision->discard();
+    }
+
+    Solver::Culprits& Solver::getCulprits(unsigned long depth){
+      if(m_culprits.size() <= depth)
+        m_culprits.resize(depth + 1);
+      return m_culprits[depth];
+    }
+
+    /**
+     * A variable decision picks from the values left in its domain, and whatever removed the others can be
+     * reached from the variable along constraints. Open conditions and threats pick from tokens and orderings
+     * that earlier decisions may have ruled out without any constraint to show for it, so every shallower
+     * decision is blamed for them.
+     */
+    void Solver::blameChoiceRestrictions(){
+      Culprits& culprits = getCulprits(getDepth());
+      EntityId entity = Entity::getEntity(m_activeDecision->getFlawedEntityKey());
+      if(entity.isNoId() || !ConstrainedVariableId::convertable(entity)){
+        culprits.all = true;
+        return;
+      }
+
+      ConstrainedVariableSet seeds;
+      seeds.insert(ConstrainedVariableId(entity));
+      blameCone(seeds, culprits);
+    }
+
+    /**
+     * Domains only shrink along constraints, so the failure can only have come from decisions on variables
+     * reachable from the emptied ones, or from those named as part of the conflict by whoever emptied them
+     * (e.g. the transactions behind a resource violation).
+     */
+    void Solver::recordConflict(){
+      Culprits& culprits = getCulprits(getDepth());
+      culprits.recorded = true;
+      if(culprits.all)
+        return;
+
+      const ConstrainedVariableSet& emptied = m_db->getConstraintEngine()->getEmptyVariables();
+      if(emptied.empty()){
+        debugMsg("Solver:backjump", "No emptied variable to explain the failure of " << m_activeDecision->toString());
+        culprits.all = true;
+        return;
+      }
+
+      ConstrainedVariableSet seeds(emptied);
+      seeds.insert(m_db->getConstraintEngine()->getConflictVariables().begin(),
+                   m_db->getConstraintEngine()->getConflictVariables().end());
+      blameCone(seeds, culprits);
+
+      debugMsg("Solver:backjump", "Blamed " << culprits.depths.size() << " of " << getDepth() <<
+               " decisions for the failure of " << m_activeDecision->toString());
+    }
+
+    /**
+     * Variables still at their base domain have not been restricted by anything, so the search does not pass
+     * through them.
+     */
+    void Solver::blameCone(const ConstrainedVariableSet& seeds, Culprits& culprits) const {
+      std::set<eint> cone;
+      std::vector<ConstrainedVariableId> agenda;
+      for(ConstrainedVariableSet::const_iterator it = seeds.begin(); it != seeds.end(); ++it){
+        cone.insert((*it)->getKey());
+        agenda.push_back(*it);
+      }
+
+      while(!agenda.empty()){
+        ConstrainedVariableId var = agenda.back();
+        agenda.pop_back();
+        ConstraintSet constraints;
+        var->constraints(constraints);
+        for(ConstraintSet::const_iterator cIt = constraints.begin(); cIt != constraints.end(); ++cIt){
+          if(!(*cIt)->isActive())
+            continue;
+          const std::vector<ConstrainedVariableId>& scope = (*cIt)->getScope();
+          for(std::vector<ConstrainedVariableId>::const_iterator vIt = scope.begin(); vIt != scope.end(); ++vIt){
+            ConstrainedVariableId other = *vIt;
+            if(!cone.insert(other->getKey()).second)
+              continue;
+            if(other->lastDomain().isOpen() || !(other->lastDomain() == other->baseDomain()))
+              agenda.push_back(other);
+          }
+        }
+      }
+
+      for(unsigned long i = 0; i < getDepth(); i++){
+        if(isCulprit(m_decisionStack[i], cone))
+          culprits.depths.insert(i);
+      }
+    }
+
+    bool Solver::isCulprit(const DecisionPointId decision, const std::set<eint>& cone) const {
+      EntityId entity = Entity::getEntity(decision->getFlawedEntityKey());
+      if(entity.isNoId())
+        return true;
+
+      if(ConstrainedVariableId::convertable(entity))
+        return cone.find(entity->getKey()) != cone.end();
+
+      if(TokenId::convertable(entity)){
+        TokenId token = entity;
+        // A merged token's constraints have moved over to the token it was merged with
+        std::vector<TokenId> tokens(1, token);
+        if(token->isMerged())
+          tokens.push_back(token->getActiveToken());
+        for(std::vector<TokenId>::const_iterator it = tokens.begin(); it != tokens.end(); ++it){
+          const std::vector<ConstrainedVariableId>& vars = (*it)->getVariables();
+          for(std::vector<ConstrainedVariableId>::const_iterator vIt = vars.begin(); vIt != vars.end(); ++vIt)
+            if(cone.find((*vIt)->getKey()) != cone.end())
+              return true;
+        }
+        return false;
+      }
+
+      // Nothing is known about how other kinds of decision affect the plan
+      return true;
+    }
+
+    bool Solver::completesNogood(){
+      if(m_nogoods.getSize() == 0)
+        return false;
+
+      NogoodStore::Choice choice(m_activeDecision->getFlawedEntityKey(), ChoiceSignature());
+      if(!m_activeDecision->getChoiceSignature(choice.second))
+        return false;
+
+      // Only gather the choices on the stack if some nogood could match
+      std::set<NogoodStore::Choice> context;
+      if(m_nogoods.mentions(choice)){
+        for(DecisionStack::const_iterator it = m_decisionStack.begin(); it != m_decisionStack.end(); ++it){
+          ChoiceSignature signature;
+          if((*it)->getChoiceSignature(signature))
+            context.insert(NogoodStore::Choice((*it)->getFlawedEntityKey(), signature));
+        }
+      }
+
+      const NogoodStore::Nogood* nogood = m_nogoods.match(choice, context);
+      if(nogood == NULL){
+        publish(notifyNogoodMiss,m_activeDecision);
+        return false;
+      }
+
+      publish(notifyNogoodHit,m_activeDecision);
+
+      // The rest of the nogood is exactly what is to blame
+      if(m_backjumping){
+        const unsigned long depth = getDepth();
+        Culprits& culprits = getCulprits(depth);
+        culprits.recorded = true;
+        for(unsigned long i = 0; i < depth; i++){
+          ChoiceSignature signature;
+          if(m_decisionStack[i]->getChoiceSignature(signature) &&
+             std::binary_search(nogood->begin(), nogood->end(),
+                                NogoodStore::Choice(m_decisionStack[i]->getFlawedEntityKey(), signature)))
+            culprits.depths.insert(i);
+        }
+      }
+
+      return true;
+    }
+
+    /**
+     * A decision that ran out of choices proves its prefix a nogood only if every choice below it was tried
+     * or pruned soundly, so nothing is learned once a decision allocated since has been cut.
+     */
+    void Solver::learnNogood(unsigned long depth, bool cut){
+      if(cut)
+        m_cutCount++;
+      if(cut || depth >= m_cutsAtAllocation.size() || m_cutsAtAllocation[depth] != m_cutCount)
+        return;
+
+      const Culprits* culprits = NULL;
+      if(m_backjumping && depth < m_culprits.size() && m_culprits[depth].recorded && !m_culprits[depth].all)
+        culprits = &m_culprits[depth];
+
+      NogoodStore::Nogood nogood;
+      for(unsigned long i = 0; i < depth; i++){
+        if(culprits != NULL && culprits->depths.find(i) == culprits->depths.end())
+          continue;
+        ChoiceSignature signature;
+        if(!m_decisionStack[i]->getChoiceSignature(signature)){
+          debugMsg("Solver:nogood", "Cannot learn a nogood through " << m_decisionStack[i]->toString());
+          return;
+        }
+        nogood.push_back(NogoodStore::Choice(m_decisionStack[i]->getFlawedEntityKey(), signature));
+      }
+
+      std::sort(nogood.begin(), nogood.end());
+      nogood.erase(std::unique(nogood.begin(), nogood.end()), nogood.end());
+      m_nogoods.add(nogood);
+    }
+
+    void Solver::jumpBack(unsigned long depth, bool cut){
+      Culprits culprits = getCulprits(depth);
+      m_culprits.resize(depth);
+
+      // Choices left untried, or a failure nobody could be blamed for, mean ordinary chronological backtracking
+      if(cut || !culprits.recorded || culprits.all){
+        if(depth > 0){
+          Culprits& parent = getCulprits(depth - 1);
+          parent.all = true;
+          parent.recorded = true;
+        }
+        return;
+      }
+
+      // No decision is to blame, so no other choice can help
+      unsigned long target = 0;
+      bool exhausted = culprits.depths.empty();
+      if(!exhausted)
+        target = *culprits.depths.rbegin();
+
+      while(!m_decisionStack.empty() && (exhausted || m_decisionStack.size() > target + 1)){
+        DecisionPointId node = m_decisionStack.back();
+        m_decisionStack.pop_back();
+        if(node->isExecuted()){
+          node->undo();
+          publish(notifyUndone,node);
+        }
+        publish(notifyRetractNotDone,node);
+        publish(notifyDeleted,node);
+        retire(node);
+      }
+
+      if(exhausted){
+        debugMsg("Solver:backjump", "Nothing to blame for failures at depth " << depth);
+        m_culprits.clear();
+        return;
+      }
+
+      debugMsg("Solver:backjump", "Jumping from depth " << depth << " back to " << target);
+      m_culprits.resize(target + 1);
+      Culprits& inherited = m_culprits[target];
+      inherited.recorded = true;
+      culprits.depths.erase(target);
+      inherited.depths.insert(culprits.depths.begin(), culprits.depths.end());
+
+      // The target is picked up by backtrack as the next decision to retract
+      m_activeDecision = m_decisionStack.back();
+      m_decisionStack.pop_back();
+    }
+
     const SolverId Solver::getId() const{ return m_id;}
 
     const LabelStr& Solver::getName() const { return m_name;}
@@ -236,6 +833,7 @@ Solver::~Solver(){
       if(m_activeDecision.isId()) {
         publish(notifyCreated,m_activeDecision);
         m_activeDecision->initialize();
+        publish(notifyInitialized,m_activeDecision);
       }
     }
 
@@ -269,6 +867,8 @@ Solver::~Solver(){
       return m_timedOut;
     }
 
+    void Solver::interrupt() {m_interrupted = true;}
+
     void Solver::step(){
       ConstraintEngineId ce = m_db->getConstraintEngine();
       bool autoPropagation = ce->getAutoPropagation();
@@ -315,8 +915,33 @@ Solver::~Solver(){
       m_noFlawsFound = false;
 
       // If we have no active decision to work on, we get one
-      if(m_activeDecision.isNoId())
+      if(m_activeDecision.isNoId()){
         allocateNewDecisionPoint();
+        if(m_backjumping){
+          m_culprits.resize(getDepth());
+          if(m_activeDecision.isId())
+            blameChoiceRestrictions();
+        }
+        if(m_nogoods.getCapacity() > 0){
+          m_cutsAtAllocation.resize(getDepth() + 1);
+          m_cutsAtAllocation[getDepth()] = m_cutCount;
+        }
+      }
+
+      // Flaw managers may compute state on demand while looking for flaws (e.g. resource profiles
+      // left out of date by lazy propagation), which can expose a conflict propagation did not find.
+      // Whatever they left out of date is brought up to date before the plan is taken to be complete.
+      if(m_activeDecision.isNoId())
+        m_db->getConstraintEngine()->propagateDeferred();
+      if(m_activeDecision.isNoId() && !conflictLevelOk()){
+        debugMsg("Solver:backtrack", "Backtracking because of a conflict found while looking for flaws.");
+        m_exhausted = backtrack();
+        if(m_exhausted) {
+          checkError(m_decisionStack.empty(), "Must be exhausted if we failed to backtrack out.");
+          publish(notifyExhausted);
+        }
+        return;
+      }
 
       if(m_activeDecision.isNoId()){
         m_noFlawsFound = true;
@@ -325,7 +950,7 @@ Solver::~Solver(){
       }
 
       if(m_maxSteps <= getStepCount() - m_stepCountFloor || 
-         m_maxDepth < getDepth() - m_depthFloor){
+         m_maxDepth < getDepth() - m_depthFloor || m_interrupted){
         debugMsg("Solver:step", 
                  "Timeout!  Max steps: " << m_maxSteps << " step (above floor) " << 
                  getStepCount() - m_stepCountFloor <<
@@ -341,26 +966,38 @@ Solver::~Solver(){
       if(!m_activeDecision->cut() && m_activeDecision->hasNext()){
         m_lastExecutedDecision = m_activeDecision->toString();
         m_activeDecision->execute();
-        m_db->getClient()->propagate();
-        m_stepCount++;
+        publish(notifyExecuted,m_activeDecision);
 
-        if(conflictLevelOk()){
-          m_decisionStack.push_back(m_activeDecision);
-          publish(notifyStepSucceeded,m_activeDecision);
-          m_activeDecision = DecisionPointId::noId();
-          debugMsg("Solver:printPlan:infrequent", std::endl << PlanDatabaseWriter::toString(m_db));
-          return;
+        if(completesNogood()){
+          debugMsg("Solver:backtrack", "Backtracking because " << m_lastExecutedDecision << " completes a nogood.");
         }
         else {
-          publish(notifyStepFailed,m_activeDecision);
-          debugMsg("Solver:backtrack",
-                   "Backtracking because of constraint inconsistency due to " << m_lastExecutedDecision);
+          m_db->getClient()->propagate();
+          m_stepCount++;
+
+          if(conflictLevelOk()){
+            m_decisionStack.push_back(m_activeDecision);
+            publish(notifyStepSucceeded,m_activeDecision);
+            m_activeDecision = DecisionPointId::noId();
+            debugMsg("Solver:printPlan:infrequent", std::endl << PlanDatabaseWriter::toString(m_db));
+            return;
+          }
+          else {
+            publish(notifyStepFailed,m_activeDecision);
+            if(m_backjumping)
+              recordConflict();
+            debugMsg("Solver:backtrack",
+                     "Backtracking because of constraint inconsistency due to " << m_lastExecutedDecision);
+          }
         }
       }
       else {
         debugMsg("Solver:backtrack", "Backtracking because " << m_activeDecision->toString() << " has no available choices.");
       }
 
+      if(m_collectActivity)
+        m_activity[m_activeDecision->getFlawedEntityKey()] += 1;
+
       // If we get here then we must have to backtrack. so do it!
       m_exhausted = backtrack();
 
@@ -401,15 +1038,23 @@ Solver::~Solver(){
           //debugMsg("Solver:printPlan", std::endl << PlanDatabaseWriter::toString(m_db));
         }
 
-        // If there are available choices to take, we can quit and resume normal search
-        backtracking = m_activeDecision->cut() || !m_activeDecision->hasNext();
+        // If there are available choices to take, we can quit and resume normal search. Choices skipped
+        // for the discrepancy limit are cut as well.
+        bool cut = m_activeDecision->cut();
+        backtracking = cut || !m_activeDecision->hasNext();
+        if(!backtracking && exceedsDiscrepancyLimit(m_activeDecision))
+          backtracking = cut = true;
 
         // If still retracting, we must discard the active decision
         if(backtracking){
           publish(notifyRetractNotDone,m_activeDecision);
           publish(notifyDeleted,m_activeDecision);
-          m_activeDecision->discard();
+          retire(m_activeDecision);
           m_activeDecision = DecisionPointId::noId();
+          if(m_nogoods.getCapacity() > 0)
+            learnNogood(m_decisionStack.size(), cut);
+          if(m_backjumping)
+            jumpBack(m_decisionStack.size(), cut);
         }
         else {
           publish(notifyRetractSucceeded,m_activeDecision);
@@ -422,16 +1067,33 @@ Solver::~Solver(){
       reset(m_decisionStack.size());
     }
 
+    /**
+     * The plan database may be changed outside the solver before it runs again, so what was learned no longer holds.
+     */
     void Solver::reset(unsigned long depth){
+      restart(depth);
+      m_nogoods.clear();
+    }
+
+    void Solver::restart(unsigned long depth){
+      retract(depth);
+
+      m_stepCount = 0;
+      m_noFlawsFound = false;
+      m_exhausted = false;
+      m_timedOut = false;
+    }
+
+    void Solver::retract(unsigned long depth){
       checkError(depth <= getDepth(), "Cannot reset past current depth: " << depth << " exceeds " << getDepth());
 
       if(m_activeDecision.isId()){
         if(m_activeDecision->canUndo()) {
-          publish(notifyUndone,m_activeDecision);
           m_activeDecision->undo();
+          publish(notifyUndone,m_activeDecision);
         }
 
-        m_activeDecision->discard();
+        retire(m_activeDecision);
         m_activeDecision = DecisionPointId::noId();
       }
 
@@ -453,30 +1115,28 @@ Solver::~Solver(){
         m_decisionStack.pop_back();
 
         if(node->canUndo()) {
-          publish(notifyUndone,node);
           node->undo();
+          publish(notifyUndone,node);
         }
 
         publish(notifyDeleted,node);
-        node->discard();
+        retire(node);
         depth--;
       }
 
-      m_stepCount = 0;
-      m_noFlawsFound = false;
-      m_exhausted = false;
-      m_timedOut = false;
+      if(m_culprits.size() > m_decisionStack.size())
+        m_culprits.resize(m_decisionStack.size());
     }
 
     bool Solver::backjump(unsigned long stepCount){
       // If we have an active decision, then reset it
       if(m_activeDecision.isId()){
         if(m_activeDecision->canUndo()) {
-          publish(notifyUndone,m_activeDecision);
           m_activeDecision->undo();
+          publish(notifyUndone,m_activeDecision);
         }
 
-        m_activeDecision->discard();
+        retire(m_activeDecision);
         m_activeDecision = DecisionPointId::noId();
         stepCount--;
       }
@@ -506,15 +1166,20 @@ Solver::~Solver(){
       m_timedOut = false;
 
       cleanupDecisions();
+      m_nogoods.clear();
+      m_retiredChoices = ChoiceStatistics();
     }
 
     void Solver::cleanupDecisions(){
       if(m_activeDecision.isId()){
-        m_activeDecision->discard();
+        retire(m_activeDecision);
         m_activeDecision = DecisionPointId::noId();
       }
 
-      discardAll(m_decisionStack);
+      for(DecisionStack::const_iterator it = m_decisionStack.begin(); it != m_decisionStack.end(); ++it)
+        retire(*it);
+      m_decisionStack.clear();
+      m_culprits.clear();
     }
 
     void Solver::cleanup(DecisionStack& decisionStack){
@@ -607,6 +1272,8 @@ Solver::FlawIterator::FlawIterator(const FlawManagers& flawManagers)
     void Solver::notifyRemoved(const ConstrainedVariableId variable){
       checkError(!isDecided(variable),"Attempt to remove decided variable "<< variable->toString());
       notify(notifyRemoved(variable));
+      if(m_nogoods.getSize() > 0)
+        m_nogoods.forget(variable->getKey());
     }
 
 void Solver::notifyChanged(const ConstrainedVariableId variable,
@@ -651,6 +1318,10 @@ void Solver::notifyChanged(const ConstrainedVariableId variable,
       checkError(!isDecided(token),"Attempt to remove decided token "<< token->toString());
       checkError(!hasDecidedParameter(token),"Attempt to remove token with decided parameters "<< token->toString());
       notify(notifyRemoved(token));
+
+      // A token recreated on redoing a decision gets a new key, so nogoods naming the old one are dead weight
+      if(m_nogoods.getSize() > 0)
+        m_nogoods.forget(token->getKey());
     }
 
     bool Solver::inScope(const EntityId entity){
@@ -707,6 +1378,62 @@ void Solver::notifyChanged(const ConstrainedVariableId variable,
       return priorityQueue;
     }
 
+    Solver::OpenFlawIterator::OpenFlawIterator(const Solver& solver)
+      : m_manager(solver.m_flawManagers.begin()), m_end(solver.m_flawManagers.end()),
+        m_flaws(), m_entity() {
+      if(m_manager != m_end)
+        m_flaws = (*m_manager)->createIterator();
+      advance();
+    }
+
+    Solver::OpenFlawIterator::~OpenFlawIterator() {
+      if(m_flaws.isId())
+        delete static_cast<Iterator*>(m_flaws);
+    }
+
+    bool Solver::OpenFlawIterator::done() const {return m_entity.isNoId();}
+
+    void Solver::OpenFlawIterator::next() {
+      checkError(!done(), "Cannot advance past the last flaw.");
+      m_entity = EntityId::noId();
+      advance();
+    }
+
+    const EntityId Solver::OpenFlawIterator::getEntity() const {return m_entity;}
+
+    eint Solver::OpenFlawIterator::getKey() const {return m_entity->getKey();}
+
+    const FlawManagerId Solver::OpenFlawIterator::getFlawManager() const {return *m_manager;}
+
+    Priority Solver::OpenFlawIterator::getPriority() const {return (*m_manager)->getPriority(m_entity);}
+
+    /**
+     * Flaw manager iterators may yield a noId on their way to being done, so those are skipped.
+     */
+    void Solver::OpenFlawIterator::advance() {
+      while(m_entity.isNoId() && m_manager != m_end){
+        if(!m_flaws->done()){
+          m_entity = m_flaws->next();
+          continue;
+        }
+        delete static_cast<Iterator*>(m_flaws);
+        m_flaws = IteratorId::noId();
+        if(++m_manager != m_end)
+          m_flaws = (*m_manager)->createIterator();
+      }
+    }
+
+    unsigned int Solver::getFlawCount() const {
+      unsigned int count = 0;
+      for(OpenFlawIterator it(*this); !it.done(); it.next())
+        count++;
+      return count;
+    }
+
+    bool Solver::hasFlaws() const {
+      return !OpenFlawIterator(*this).done();
+    }
+
     /**
      * @brief Will print the open decisions in priority order
      */
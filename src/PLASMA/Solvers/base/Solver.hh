@@ -11,6 +11,7 @@
 
 #include "SolverDefs.hh"
 #include "FlawManager.hh"
+#include "NogoodStore.hh"
 #include "SearchListener.hh"
 #include "EntityIterator.hh"
 #include "ConstraintEngineListener.hh"
@@ -23,7 +24,8 @@ namespace SOLVERS {
  * @brief Defines the main solver interface for identification and resolution of flaws on a plan database.
  *
  * A solver may or may not do planning i.e. goal decomposition. Most generally, it will process a set of flaws in a partial plan until
- * there are no more in scope.The Solver is a mediator between Flaw Managers and Decision Points. This solver provides a chronological backtracking search.
+ * there are no more in scope.The Solver is a mediator between Flaw Managers and Decision Points. This solver provides a chronological backtracking search,
+ * and optionally limited discrepancy or beam search (see SearchStrategy).
  *
  * @see FlawManager, DecisionPoint
  */
@@ -41,7 +43,16 @@ class Solver {
   virtual ~Solver();
 
   /**
-   * @brief Invocation to solve any flaws in scope for the current Partial Plan
+   * @brief Search strategies, selected with the 'search' attribute of the <Solver> element.
+   */
+  enum SearchStrategy {
+    DEPTH_FIRST, /*!< search="dfs", the default. Chronological backtracking. */
+    LIMITED_DISCREPANCY, /*!< search="lds", with an optional maxDiscrepancies attribute. @see solveWithDiscrepancyLimit */
+    BEAM /*!< search="beam", with a beamWidth attribute. @see solveWithBeam */
+  };
+
+  /**
+   * @brief Invocation to solve any flaws in scope for the current Partial Plan, using the configured search strategy.
    *
    * This method will NOT reset a prior search stack.
    * @param maxSteps The maximum number of additional steps permitted to resolve all flaws in THIS iteration.
@@ -56,6 +67,142 @@ class Solver {
   bool solve(unsigned int maxSteps = std::numeric_limits<unsigned int>::max(),
              unsigned int maxDepth = std::numeric_limits<unsigned int>::max());
 #endif // _MSC_VER
+  /**
+   * @brief Step budget schedules for solveWithRestarts.
+   */
+  enum RestartSchedule {
+    LUBY_RESTARTS, /*!< Budgets of baseSteps times 1, 1, 2, 1, 1, 2, 4, ... */
+    GEOMETRIC_RESTARTS /*!< Budgets of baseSteps growing by half again on every restart */
+  };
+
+  /**
+   * @brief Solve with restarts. Each run is given a step budget from the schedule. If it runs out, the decisions
+   * it made are reset and the next run starts over with a differently seeded tie breaking order.
+   * @param baseSteps The step budget unit for the schedule.
+   * @param maxRestarts The number of restarts allowed before giving up.
+   * @param schedule How the step budget changes between runs.
+   * @param seed Seed for randomized tie breaking between equally preferred flaws. Run i uses seed + i.
+   * @param retainActivity If true, the number of failed steps on each flaw is kept across restarts, and more
+   * active flaws are preferred when breaking ties.
+   * @return true if all flaws resolved, false if the search space was exhausted or all runs ran out of steps.
+   * @see solve, reset
+   */
+  bool solveWithRestarts(unsigned int baseSteps,
+                         unsigned int maxRestarts,
+                         RestartSchedule schedule = LUBY_RESTARTS,
+                         unsigned int seed = 1,
+                         bool retainActivity = true);
+
+  /**
+   * @brief Limited discrepancy search. A discrepancy is taking any but the first choice of a decision. Depth first
+   * search is run allowing no discrepancies on the stack, then one, and so on, so plans close to the heuristic
+   * are found first. Each run that finds nothing starts over from an empty stack and is announced with
+   * SearchListener::notifyRestarted.
+   * @param maxDiscrepancies The most discrepancies allowed in the last run. If that run was limited by it, the
+   * search is reported as timed out rather than exhausted.
+   * @param maxSteps The maximum number of steps over all runs.
+   * @param maxDepth The maximum growth in stack size in each run.
+   * @return true if all flaws resolved.
+   */
+#ifdef _MSC_VER
+  bool solveWithDiscrepancyLimit(unsigned int maxDiscrepancies,
+                                 unsigned int maxSteps = UINT_MAX,
+                                 unsigned int maxDepth = UINT_MAX);
+#else
+  bool solveWithDiscrepancyLimit(unsigned int maxDiscrepancies,
+                                 unsigned int maxSteps = std::numeric_limits<unsigned int>::max(),
+                                 unsigned int maxDepth = std::numeric_limits<unsigned int>::max());
+#endif // _MSC_VER
+
+  /**
+   * @brief The discrepancies allowed in the current run of a limited discrepancy search.
+   */
+  unsigned int getDiscrepancyLimit() const;
+
+  /**
+   * @brief Beam search. Every choice of the next decision of each plan in the beam is executed and propagated,
+   * and the width consistent plans with the fewest open flaws, ties going to the earlier choice, form the next
+   * beam. Only one plan is held in the database, so each plan in the beam is rebuilt from the decisions
+   * on the stack when the search began by replaying its choices; replayed steps count towards maxSteps.
+   * On success the plan found is left in the database, otherwise the search leaves it as it was.
+   * @param width The number of plans kept at each depth.
+   * @param maxSteps The maximum number of steps.
+   * @param maxDepth The maximum number of decisions in a plan of the beam.
+   * @return true if all flaws resolved. The search is reported as exhausted only if no plan was ever dropped
+   * from the beam and it began with an empty stack, otherwise running out of plans counts as timing out.
+   */
+#ifdef _MSC_VER
+  bool solveWithBeam(unsigned int width,
+                     unsigned int maxSteps = UINT_MAX,
+                     unsigned int maxDepth = UINT_MAX);
+#else
+  bool solveWithBeam(unsigned int width,
+                     unsigned int maxSteps = std::numeric_limits<unsigned int>::max(),
+                     unsigned int maxDepth = std::numeric_limits<unsigned int>::max());
+#endif // _MSC_VER
+
+  SearchStrategy getSearchStrategy() const;
+
+  /**
+   * @brief Change the strategy used by solve.
+   * @param limit The discrepancy limit or beam width, as for solveWithDiscrepancyLimit and solveWithBeam.
+   */
+  void setSearchStrategy(SearchStrategy strategy, unsigned int limit);
+
+  /**
+   * @brief The number of restarts made in the last call to solveWithRestarts.
+   */
+  unsigned int getRestartCount() const;
+
+  /**
+   * @brief The i-th term, from 1, of the Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, ...
+   */
+  static unsigned int lubyTerm(unsigned int i);
+
+  /**
+   * @brief Turn conflict-directed backjumping on or off. It is off by default.
+   *
+   * When on, every failed step is blamed on the decisions on the stack that could have contributed to the emptied domain,
+   * and a variable decision is also blamed on those that restricted its domain before it was taken. Once a decision runs
+   * out of choices, the search jumps straight back to the deepest decision blamed for its failures, discarding the
+   * decisions in between without trying their remaining choices. Open conditions, threats and other decisions that do not
+   * choose a value for a variable always backtrack chronologically.
+   */
+  void setBackjumping(bool enabled);
+
+  /**
+   * @brief Turn nogood learning on, or off with a capacity of zero. It is off by default.
+   *
+   * When a decision runs out of choices, the choices on the stack that led to it are stored as a nogood. When
+   * backjumping, only the choices blamed for its failures are stored. A choice that completes a stored nogood is
+   * then retracted without propagation. Nogoods are kept across restarts, and dropped by reset and clear. Nogoods that
+   * name a token or variable are dropped when it is deleted.
+   * @param capacity The number of nogoods kept. The least recently used is evicted first.
+   * @see NogoodStore, SearchListener::notifyNogoodHit
+   */
+  void setNogoodLearning(unsigned int capacity);
+
+  const NogoodStore& getNogoodStore() const;
+
+  /**
+   * @brief Choices built and tried by the decisions made since the last clear.
+   * @see DecisionPoint::getChoicesBuilt
+   */
+  struct ChoiceStatistics {
+    ChoiceStatistics() : decisions(0), built(0), tried(0) {}
+    double averageBuilt() const {return decisions == 0 ? 0 : static_cast<double>(built) / decisions;}
+    double averageTried() const {return decisions == 0 ? 0 : static_cast<double>(tried) / decisions;}
+
+    unsigned int decisions; /*!< Decisions whose choices were initialized */
+    unsigned long built; /*!< Choices materialized by those decisions */
+    unsigned long tried; /*!< Choices executed by those decisions */
+  };
+
+  /**
+   * @brief Statistics over retired decisions and those still on the stack.
+   */
+  ChoiceStatistics getChoiceStatistics() const;
+
   /**
    * @brief Invocation for a single step of flaw resolution.
    *
@@ -72,7 +219,7 @@ class Solver {
 
   /**
    * @brief Resets (undo and delete) a specific number of decisions, in reverse chronological order,
-   * in the internal decision stack
+   * in the internal decision stack. Learned nogoods are dropped.
    * @param depth The number of decisions to reset.
    */
   void reset(unsigned long depth);
@@ -123,10 +270,17 @@ class Solver {
   bool isExhausted() const;
 
   /**
-   * @brief tests if the search step and depth limits hane been exceeded
+   * @brief tests if the search step and depth limits hane been exceeded, or a discrepancy limit or beam width
+   * kept the search from completing.
    */
   bool isTimedOut() const;
 
+  /**
+   * @brief Stop the search in progress at its next step, as if it had run out of steps. Meant to be called by a
+   * SearchListener, so that a search run by any strategy can be abandoned. Cleared when the next search starts.
+   */
+  void interrupt();
+
   /**
    * @brief Retrieve all decisions on the stack.
    */
@@ -176,6 +330,53 @@ class Solver {
 
   std::multimap<Priority, std::string> getOpenDecisions() const;
 
+  /**
+   * @brief Walks the open flaws of each flaw manager in turn, giving the key, manager and priority of each
+   * without describing it as a string. Only valid while the plan database is unchanged.
+   */
+  class OpenFlawIterator {
+   public:
+    OpenFlawIterator(const Solver& solver);
+    ~OpenFlawIterator();
+
+    bool done() const;
+
+    /**
+     * @brief Move on to the next flaw.
+     */
+    void next();
+
+    const EntityId getEntity() const;
+    eint getKey() const;
+    const FlawManagerId getFlawManager() const;
+
+    /**
+     * @brief The priority of the current flaw, as cached by its flaw manager.
+     */
+    Priority getPriority() const;
+
+   private:
+    OpenFlawIterator(const OpenFlawIterator&);
+    OpenFlawIterator& operator=(const OpenFlawIterator&);
+
+    void advance();
+
+    FlawManagers::const_iterator m_manager;
+    const FlawManagers::const_iterator m_end;
+    IteratorId m_flaws; /*!< Over the flaws of m_manager */
+    EntityId m_entity;
+  };
+
+  /**
+   * @brief The number of open flaws.
+   */
+  unsigned int getFlawCount() const;
+
+  /**
+   * @brief True if there is an open flaw. Stops at the first one found.
+   */
+  bool hasFlaws() const;
+
   std::string printOpenDecisions() const;
 
   /**
@@ -211,6 +412,11 @@ class Solver {
 
   void doStep();
   bool conflictLevelOk();
+
+  /**
+   * @brief Chronological backtracking search, the body of solve for the default strategy.
+   */
+  bool solveDepthFirst(unsigned int maxSteps, unsigned int maxDepth);
   double m_baseConflictLevel;  // Keeps track of initial conflict level before a solver step is taken
 
   static void cleanup(DecisionStack& decisionStack);
@@ -231,6 +437,78 @@ class Solver {
 
   bool hasDecidedParameter(const TokenId token);
 
+  /**
+   * @brief Decisions blamed for the failures under an open decision.
+   */
+  struct Culprits {
+    Culprits() : depths(), all(false), recorded(false) {}
+    std::set<unsigned long> depths; /*!< Stack depths of the blamed decisions */
+    bool all; /*!< A failure could not be explained, so every shallower decision is to blame */
+    bool recorded; /*!< At least one failure has been blamed */
+  };
+
+  Culprits& getCulprits(unsigned long depth);
+
+  /**
+   * @brief Blame the choices the newly allocated active decision has to pick from on the decisions on the stack.
+   */
+  void blameChoiceRestrictions();
+
+  /**
+   * @brief Blame the failure of the active decision's current choice on the decisions on the stack.
+   */
+  void recordConflict();
+
+  /**
+   * @brief Blame the decisions on the stack whose flawed entity can be reached along constraints from the given variables.
+   */
+  void blameCone(const ConstrainedVariableSet& seeds, Culprits& culprits) const;
+
+  /**
+   * @brief Having discarded the decision at the given depth, pop back to the deepest decision blamed for its failures.
+   */
+  void jumpBack(unsigned long depth, bool cut);
+
+  bool isCulprit(const DecisionPointId decision, const std::set<eint>& cone) const;
+
+  /**
+   * @brief Undo and delete the active decision and the given number of decisions on the stack, without
+   * touching the step count or search status.
+   */
+  void retract(unsigned long depth);
+
+  /**
+   * @brief Reset the given number of decisions, keeping the nogoods learned so far.
+   */
+  void restart(unsigned long depth);
+
+  /**
+   * @brief Test if the next choice of a decision would take the search past the discrepancy limit.
+   * Records that the search was limited if so.
+   */
+  bool exceedsDiscrepancyLimit(const DecisionPointId decision);
+
+  /**
+   * @brief Make the given choices, by index, for the decisions allocated in turn.
+   * @return false if a choice is missing or fails. The stack is then left as far as it was replayed.
+   */
+  bool replay(const std::vector<unsigned int>& choices, unsigned int maxSteps);
+
+  /**
+   * @brief Add a decision to the choice statistics and discard it.
+   */
+  void retire(const DecisionPointId decision);
+
+  /**
+   * @brief Test if the active decision's current choice, together with choices on the stack, completes a stored nogood.
+   */
+  bool completesNogood();
+
+  /**
+   * @brief Having discarded the decision at the given depth, store the choices that led to it as a nogood.
+   */
+  void learnNogood(unsigned long depth, bool cut);
+
   /**
    * @brief Used to enforce scope restrictions for common filters across all flaw managers
    */
@@ -272,6 +550,20 @@ class Solver {
   DecisionStack m_decisionStack; /*!< Stack of decisions made */
   std::string m_lastExecutedDecision; /*!< Kept for debugging and UI purposes */
   std::list<SearchListenerId> m_listeners; /*!< The set of listeners for the search */
+  std::map<eint, double> m_activity; /*!< Failed steps by flawed entity key, kept across restarts */
+  bool m_collectActivity; /*!< True while solving with restarts and retaining activity */
+  unsigned int m_restartCount; /*!< Restarts made in the last call to solveWithRestarts */
+  bool m_backjumping; /*!< True if backtracking is conflict-directed */
+  std::vector<Culprits> m_culprits; /*!< Culprits for the decision at each depth, when backjumping */
+  NogoodStore m_nogoods; /*!< Nogoods learned from decisions that ran out of choices */
+  unsigned int m_cutCount; /*!< Decisions discarded with choices left untried, when learning nogoods */
+  std::vector<unsigned int> m_cutsAtAllocation; /*!< m_cutCount when the decision at each depth was allocated */
+  ChoiceStatistics m_retiredChoices; /*!< Choice statistics of decisions already discarded */
+  SearchStrategy m_strategy; /*!< Used by solve */
+  unsigned int m_strategyLimit; /*!< Discrepancy limit or beam width for m_strategy */
+  unsigned int m_discrepancyLimit; /*!< Discrepancies allowed on the stack. Unlimited outside limited discrepancy search */
+  bool m_discrepancyLimited; /*!< True once a choice has been skipped for exceeding m_discrepancyLimit */
+  bool m_interrupted; /*!< True once interrupt has been called during the search in progress */
 
   class FlawIterator : public Iterator {
    public:
@@ -67,7 +67,33 @@ namespace EUROPA {
 
       void setCutoff(unsigned int maxChoices) {m_maxChoices = maxChoices;}
 
+      /**
+       * @brief The handler that created this decision, if it was allocated by a FlawManager.
+       */
+      const FlawHandlerId& getFlawHandler() const {return m_flawHandler;}
+
+      void setFlawHandler(const FlawHandlerId handler) {m_flawHandler = handler;}
+
       const eint getFlawedEntityKey() {return m_entityKey;}
+
+      /**
+       * @brief Describe the choice currently executed. Two decisions on the same flawed entity made the
+       * same choice if and only if their signatures are equal.
+       * @return false if the choice cannot be described, in which case the solver will not learn nogoods involving it.
+       * @see NogoodStore
+       */
+      virtual bool getChoiceSignature(ChoiceSignature& /*signature*/) const {return false;}
+
+      /**
+       * @brief The number of choices executed so far.
+       */
+      unsigned int getChoicesTried() const {return m_counter;}
+
+      /**
+       * @brief The number of choices materialized so far. Decisions that generate their choices on demand
+       * report only those generated, which is never less than getChoicesTried().
+       */
+      virtual unsigned int getChoicesBuilt() const {return m_counter;}
       //    protected:
       DecisionPoint(const DbClientId client, eint entityKey, const LabelStr& explanation);
 
@@ -147,6 +173,7 @@ namespace EUROPA {
       bool m_isExecuted; /*!< True if executed has been called, and undo has not */
       bool m_initialized; /*!< True if choices have been set up. Otherwise false.*/
       ContextId m_context;
+      FlawHandlerId m_flawHandler;
       unsigned int m_maxChoices; /*!< Set to bound number of choices */
       unsigned int m_counter; /*!< Increment on execution */
     };
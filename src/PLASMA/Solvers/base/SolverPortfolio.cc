@@ -0,0 +1,192 @@
+#include "SolverPortfolio.hh"
+#include "Solver.hh"
+#include "SearchListener.hh"
+#include "PlanDatabaseFork.hh"
+#include "PlanDatabase.hh"
+#include "Mutex.hh"
+#include "Error.hh"
+#include "Debug.hh"
+#include "tinyxml.h"
+
+#include <sys/time.h>
+
+/**
+ * @file SolverPortfolio.cc
+ * @brief Provides the implementation for SolverPortfolio
+ */
+
+namespace EUROPA {
+  namespace SOLVERS {
+
+    namespace {
+      double now() {
+        timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + tv.tv_usec / 1e6;
+      }
+    }
+
+    /**
+     * @brief Everything owned by one configuration while it is searched. Listens to its solver to stop it
+     * between steps whatever strategy is searching.
+     */
+    struct SolverPortfolio::Member : public SearchListener {
+      Member(SolverPortfolio& p, unsigned int i)
+        : portfolio(p), index(i), fork(NULL), solver(), thread(), start(0), cancelled(false), outOfTime(false) {}
+
+      void notifyExecuted(DecisionPointId) {checkStop();}
+      void notifyRetractNotDone(DecisionPointId) {checkStop();}
+
+      void checkStop() {
+        if(cancelled || outOfTime)
+          return;
+        if(portfolio.stopRequested())
+          cancelled = true;
+        else if(portfolio.m_maxSeconds > 0 && now() - start >= portfolio.m_maxSeconds)
+          outOfTime = true;
+        else
+          return;
+        solver->interrupt();
+      }
+
+      SolverPortfolio& portfolio;
+      unsigned int index;
+      PlanDatabaseFork* fork;
+      SolverId solver;
+      pthread_t thread;
+      double start;
+      bool cancelled; /*!< Interrupted because another configuration found a plan */
+      bool outOfTime; /*!< Interrupted because the wall clock budget ran out */
+    };
+
+    SolverPortfolio::Statistics::Statistics()
+      : name(), solved(false), exhausted(false), timedOut(false), cancelled(false), error(),
+        stepCount(0), depth(0), seconds(0) {}
+
+    SolverPortfolio::SolverPortfolio(const RulesEngineId parent, const DbClientTransactionLogId transactions)
+      : m_parent(parent), m_transactions(transactions), m_configurations(), m_members(), m_statistics(),
+        m_maxSteps(0), m_maxDepth(0), m_maxSeconds(0), m_winner(-1) {
+      check_error(parent.isValid());
+      check_error(transactions.isValid());
+      pthread_mutex_init(&m_mutex, NULL);
+    }
+
+    SolverPortfolio::~SolverPortfolio() {
+      clearMembers();
+      for(std::vector<TiXmlElement*>::const_iterator it = m_configurations.begin(); it != m_configurations.end(); ++it)
+        delete *it;
+      pthread_mutex_destroy(&m_mutex);
+    }
+
+    void SolverPortfolio::addConfiguration(const TiXmlElement& configData) {
+      checkError(strcmp(configData.Value(), "Solver") == 0,
+                 "Configuration error. Expected element <Solver> but found " << configData.Value());
+      m_configurations.push_back(static_cast<TiXmlElement*>(configData.Clone()));
+    }
+
+    unsigned int SolverPortfolio::getConfigurationCount() const {return m_configurations.size();}
+
+    int SolverPortfolio::getWinner() const {return m_winner;}
+
+    const std::vector<SolverPortfolio::Statistics>& SolverPortfolio::getStatistics() const {return m_statistics;}
+
+    const PlanDatabaseId SolverPortfolio::getPlanDatabase(unsigned int index) const {
+      checkError(index < m_members.size(), "No configuration " << index << " has been searched.");
+      return m_members[index]->fork->getPlanDatabase();
+    }
+
+    const SolverId SolverPortfolio::getSolver(unsigned int index) const {
+      checkError(index < m_members.size(), "No configuration " << index << " has been searched.");
+      return m_members[index]->solver;
+    }
+
+    bool SolverPortfolio::solve(unsigned int maxSteps, unsigned int maxDepth, double maxSeconds) {
+      checkError(!m_configurations.empty(), "No configurations to search.");
+      clearMembers();
+      m_maxSteps = maxSteps;
+      m_maxDepth = maxDepth;
+      m_maxSeconds = maxSeconds;
+      m_winner = -1;
+      m_statistics.assign(m_configurations.size(), Statistics());
+
+      // Forks are built one at a time since each of them reads the parent's transactions
+      for(unsigned int i = 0; i < m_configurations.size(); i++) {
+        Member* member = new Member(*this, i);
+        m_members.push_back(member);
+        member->fork = new PlanDatabaseFork(m_parent, m_transactions);
+        member->solver = (new Solver(member->fork->getPlanDatabase(), *m_configurations[i]))->getId();
+        member->solver->addListener(member->getId());
+        m_statistics[i].name = member->solver->getName().toString();
+      }
+
+      for(std::vector<Member*>::const_iterator it = m_members.begin(); it != m_members.end(); ++it) {
+        int rc = pthread_create(&(*it)->thread, NULL, &SolverPortfolio::run, *it);
+        checkRuntimeError(rc == 0, "Failed to start a solver thread: " << rc);
+      }
+
+      for(std::vector<Member*>::const_iterator it = m_members.begin(); it != m_members.end(); ++it)
+        pthread_join((*it)->thread, NULL);
+
+      debugMsg("SolverPortfolio:solve", "Finished with winner " << m_winner);
+      return m_winner >= 0;
+    }
+
+    void* SolverPortfolio::run(void* arg) {
+      Member* member = static_cast<Member*>(arg);
+      member->portfolio.search(*member);
+      return NULL;
+    }
+
+    /**
+     * Members are searched with Solver::solve so that each uses its configured strategy. They are stopped
+     * from their own listener, which interrupts the solver when another member has won or time has run out.
+     */
+    void SolverPortfolio::search(Member& member) {
+      Statistics& stats = m_statistics[member.index];
+      const SolverId solver = member.solver;
+
+      member.start = now();
+      try {
+        if(stopRequested())
+          member.cancelled = true;
+        else
+          stats.solved = solver->solve(m_maxSteps, m_maxDepth);
+      }
+      catch(const Error& e) {
+        stats.error = e.getMsg();
+      }
+
+      stats.seconds = now() - member.start;
+      stats.exhausted = solver->isExhausted();
+      stats.cancelled = member.cancelled && !stats.solved;
+      stats.timedOut = !stats.cancelled && (member.outOfTime || solver->isTimedOut());
+      stats.stepCount = solver->getStepCount();
+      stats.depth = solver->getDepth();
+
+      if(stats.solved)
+        notifySolved(member.index);
+    }
+
+    bool SolverPortfolio::stopRequested() {
+      MutexGrabber grabber(m_mutex);
+      return m_winner >= 0;
+    }
+
+    void SolverPortfolio::notifySolved(unsigned int index) {
+      MutexGrabber grabber(m_mutex);
+      if(m_winner < 0)
+        m_winner = index;
+    }
+
+    void SolverPortfolio::clearMembers() {
+      for(std::vector<Member*>::const_iterator it = m_members.begin(); it != m_members.end(); ++it) {
+        Member* member = *it;
+        if(member->solver.isId())
+          delete static_cast<Solver*>(member->solver);
+        delete member->fork;
+        delete member;
+      }
+      m_members.clear();
+    }
+  }
+}
@@ -0,0 +1,125 @@
+#ifndef H_SolverPortfolio
+#define H_SolverPortfolio
+
+/**
+ * @file SolverPortfolio.hh
+ * @brief Runs several Solver configurations concurrently on independent copies of a plan database.
+ * @ingroup Solvers
+ */
+
+#include "SolverDefs.hh"
+#include "RulesEngineDefs.hh"
+
+#include <limits>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+namespace EUROPA {
+  class TiXmlElement;
+  class PlanDatabaseFork;
+
+  namespace SOLVERS {
+
+    /**
+     * @brief Races a set of Solver configurations against each other, one thread per configuration.
+     *
+     * Every configuration is given its own PlanDatabaseFork of the parent database, so the threads share
+     * only schemas and rule definitions. Each configuration is searched with Solver::solve, so with the
+     * strategy its element selects. The first configuration to find a plan stops the others; the
+     * rest stop when they exhaust their search or run out of steps, depth or time. Forks and solvers are
+     * kept until the portfolio is deleted so that the winning plan can be inspected.
+     *
+     * The parent must have been logging transactions since it was created (see PlanDatabaseFork) and
+     * must not be modified while solve() is running.
+     */
+    class SolverPortfolio {
+    public:
+      /**
+       * @brief Outcome of one configuration.
+       */
+      struct Statistics {
+        Statistics();
+
+        std::string name; /*!< The name of the Solver */
+        bool solved; /*!< Found a plan */
+        bool exhausted; /*!< Search space exhausted */
+        bool timedOut; /*!< Hit the step, depth or time budget */
+        bool cancelled; /*!< Stopped because another configuration found a plan */
+        std::string error; /*!< Message of an error raised while searching, if any */
+        unsigned int stepCount;
+        unsigned long depth;
+        double seconds; /*!< Wall clock time spent searching */
+      };
+
+      SolverPortfolio(const RulesEngineId parent, const DbClientTransactionLogId transactions);
+      ~SolverPortfolio();
+
+      /**
+       * @brief Add a configuration. The element is copied and must be a <Solver> element.
+       */
+      void addConfiguration(const TiXmlElement& configData);
+
+      unsigned int getConfigurationCount() const;
+
+      /**
+       * @brief Fork the database for every configuration and search them concurrently.
+       * @param maxSteps Step budget for each configuration.
+       * @param maxDepth Depth budget for each configuration.
+       * @param maxSeconds Wall clock budget for each configuration. Zero for no limit.
+       * @return true if some configuration found a plan.
+       */
+#ifdef _MSC_VER
+      bool solve(unsigned int maxSteps = UINT_MAX,
+                 unsigned int maxDepth = UINT_MAX,
+                 double maxSeconds = 0);
+#else
+      bool solve(unsigned int maxSteps = std::numeric_limits<unsigned int>::max(),
+                 unsigned int maxDepth = std::numeric_limits<unsigned int>::max(),
+                 double maxSeconds = 0);
+#endif //_MSC_VER
+
+      /**
+       * @brief Index of the configuration that found a plan, or -1 if none did.
+       */
+      int getWinner() const;
+
+      const std::vector<Statistics>& getStatistics() const;
+
+      /**
+       * @brief The database searched by a configuration. Only available after solve().
+       */
+      const PlanDatabaseId getPlanDatabase(unsigned int index) const;
+
+      /**
+       * @brief The solver for a configuration. Only available after solve().
+       */
+      const SolverId getSolver(unsigned int index) const;
+
+    private:
+      struct Member;
+
+      SolverPortfolio(const SolverPortfolio&);
+      SolverPortfolio& operator=(const SolverPortfolio&);
+
+      static void* run(void* arg);
+      void search(Member& member);
+      bool stopRequested();
+      void notifySolved(unsigned int index);
+      void clearMembers();
+
+      RulesEngineId m_parent;
+      DbClientTransactionLogId m_transactions;
+      std::vector<TiXmlElement*> m_configurations;
+      std::vector<Member*> m_members;
+      std::vector<Statistics> m_statistics;
+      unsigned int m_maxSteps;
+      unsigned int m_maxDepth;
+      double m_maxSeconds;
+      int m_winner; /*!< Guarded by m_mutex */
+      pthread_mutex_t m_mutex;
+    };
+  }
+}
+
+#endif
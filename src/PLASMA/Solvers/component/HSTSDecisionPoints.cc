@@ -149,19 +149,12 @@ void OpenConditionDecisionPoint::handleInitialize() {
   if((m_action == mergeFirst || m_action == mergeOnly || m_action == activateFirst)) {
 
     if(stateDomain.isMember(Token::MERGED)) {
-      m_flawedToken->getPlanDatabase()->getCompatibleTokens(m_flawedToken, m_compatibleTokens, 
-#ifdef _MSC_VER
-                                                            UINT_MAX,
-#else
-                                                            std::numeric_limits<unsigned int>::max(),
-#endif //_MSC_VER
-                                                            true);
-      m_mergeCount = m_compatibleTokens.size();
+      initializeMergeCandidates();
+      generateMergeChoice();
 	    
       if(m_mergeCount > 0) {
         debugMsg("OpenConditionDecisionPoint:handleInitialize", "Adding choice '" << Token::MERGED.toString() << "' for token " << m_flawedToken->getKey());
         m_choices.push_back(Token::MERGED);
-        std::sort<std::vector<TokenId>::iterator, TokenComparatorWrapper& >(m_compatibleTokens.begin(), m_compatibleTokens.end(), *m_comparator);
       }
       else {
         debugMsg("OpenConditionDecisionPoint:handleInitialize", "Skipping choice '" << Token::MERGED.toString() << "' for token " << m_flawedToken->getKey() 
@@ -205,6 +198,15 @@ OpenConditionDecisionPoint::~OpenConditionDecisionPoint() {
   delete m_comparator;
 }
 
+// Selecting the best remaining candidate each time yields the sorted order without sorting candidates never needed.
+std::list<TokenId>::iterator OpenConditionDecisionPoint::selectCandidate(std::list<TokenId>& candidates) {
+  std::list<TokenId>::iterator best = candidates.begin();
+  for(std::list<TokenId>::iterator it = candidates.begin(); it != candidates.end(); ++it)
+    if((*m_comparator)(*it, *best))
+      best = it;
+  return best;
+}
+
 void TokenComparator::extractTokens(const std::pair<ObjectId, std::pair<TokenId, TokenId> >& p1,
                                     const std::pair<ObjectId, std::pair<TokenId, TokenId> >& p2,
                                     TokenId& t1, TokenId& t2) {
@@ -375,6 +377,8 @@ ThreatDecisionPoint::ThreatDecisionPoint(const DbClientId client, const TokenId
 
 void ThreatDecisionPoint::handleInitialize() {
   SOLVERS::ThreatDecisionPoint::handleInitialize();
+  // The heuristic ranks choices across objects, so it needs all of them
+  generateAllChoices();
   //first order choices by object key
   // 	ObjectComparator cmp;
   // 	std::sort<std::vector<std::pair<ObjectId, std::pair<TokenId, TokenId> > >::iterator, ObjectComparator&>(m_choices.begin(), m_choices.end(), cmp);
@@ -40,7 +40,12 @@ namespace EUROPA {
       void handleInitialize();
       ~OpenConditionDecisionPoint();
       const std::vector<LabelStr>& getStateChoices(){return m_choices;}
-      const std::vector<TokenId>& getCompatibleTokens(){return m_compatibleTokens;}
+      /**
+       * @brief All compatible tokens in heuristic order. Generates any that have not been needed yet.
+       */
+      const std::vector<TokenId>& getCompatibleTokens(){generateAllMergeChoices(); return m_compatibleTokens;}
+     protected:
+      std::list<TokenId>::iterator selectCandidate(std::list<TokenId>& candidates);
      private:
       OpenConditionDecisionPoint(const OpenConditionDecisionPoint&);
       OpenConditionDecisionPoint& operator=(const OpenConditionDecisionPoint&);
@@ -1,5 +1,6 @@
 #include "OpenConditionDecisionPoint.hh"
 #include "PlanDatabase.hh"
+#include "ConstraintEngine.hh"
 #include "Token.hh"
 #include "TokenVariable.hh"
 #include "ConstrainedVariable.hh"
@@ -26,6 +27,7 @@ OpenConditionDecisionPoint::OpenConditionDecisionPoint(const DbClientId client,
       m_flawedToken(flawedToken),
       m_choices(),
       m_compatibleTokens(),
+      m_candidates(),
       m_mergeCount(0),
       m_choiceCount(0),
       m_mergeIndex(0),
@@ -45,15 +47,10 @@ const TokenId OpenConditionDecisionPoint::getToken() const{ return m_flawedToken
 void OpenConditionDecisionPoint::handleInitialize(){
   const StateDomain stateDomain(m_flawedToken->getState()->lastDomain());
 
-  // Next merge choices if there are any.
+  // Next merge choices if there are any. Only the first is found now.
   if(stateDomain.isMember(Token::MERGED)){
-    // Use exact test in this case
-    m_flawedToken->getPlanDatabase()->getCompatibleTokens(
-        m_flawedToken,
-        m_compatibleTokens,
-        EUROPA_UINT_MAX,
-        true);
-    m_mergeCount = m_compatibleTokens.size();
+    initializeMergeCandidates();
+    generateMergeChoice();
     if(m_mergeCount > 0) {
       m_choices.push_back(Token::MERGED);
       debugMsg("OpenConditionDecisionPoint:handleInitialize",
@@ -99,6 +96,49 @@ void OpenConditionDecisionPoint::handleInitialize(){
   m_choiceCount = m_choices.size();
 }
 
+void OpenConditionDecisionPoint::initializeMergeCandidates() {
+  const TokenSet& activeTokens = m_flawedToken->getPlanDatabase()->getActiveTokens(m_flawedToken->getPredicateName());
+  m_candidates.assign(activeTokens.begin(), activeTokens.end());
+}
+
+std::list<TokenId>::iterator OpenConditionDecisionPoint::selectCandidate(std::list<TokenId>& candidates) {
+  return candidates.begin();
+}
+
+bool OpenConditionDecisionPoint::generateMergeChoice() {
+  // Deeper decisions have all been retracted, so propagation restores the state the candidates were collected in.
+  PlanDatabaseId db = m_flawedToken->getPlanDatabase();
+  if(m_candidates.empty() || !db->getConstraintEngine()->propagate())
+    return false;
+
+  while(!m_candidates.empty()) {
+    std::list<TokenId>::iterator it = selectCandidate(m_candidates);
+    TokenId candidate = *it;
+    m_candidates.erase(it);
+    checkError(candidate.isValid() && candidate->isActive(),
+               "Merge candidates for " << m_flawedToken->getKey() << " must remain active.");
+
+    // Use exact test in this case
+    if(db->isCompatible(m_flawedToken, candidate, true)) {
+      m_compatibleTokens.push_back(candidate);
+      m_mergeCount = m_compatibleTokens.size();
+      return true;
+    }
+  }
+
+  debugMsg("OpenConditionDecisionPoint:generateMergeChoice",
+           "No more compatible tokens for " << m_flawedToken->getKey() << " after " << m_mergeCount);
+  return false;
+}
+
+void OpenConditionDecisionPoint::generateAllMergeChoices() {
+  while(generateMergeChoice());
+}
+
+unsigned int OpenConditionDecisionPoint::getChoicesBuilt() const {
+  return m_choiceCount + m_mergeCount - (m_mergeCount > 0 ? 1 : 0);
+}
+
 void OpenConditionDecisionPoint::handleExecute() {
   checkError(m_choiceIndex < m_choiceCount,
              "Tried to execute past available choices:" << m_choiceIndex << ">=" << m_choiceCount);
@@ -124,14 +164,25 @@ void OpenConditionDecisionPoint::handleExecute() {
   }
 }
 
+bool OpenConditionDecisionPoint::getChoiceSignature(ChoiceSignature& signature) const {
+  if(!isExecuted())
+    return false;
+  edouble target(0);
+  if(m_choices[m_choiceIndex] == Token::MERGED)
+    target = m_compatibleTokens[m_mergeIndex]->getKey();
+  signature = ChoiceSignature(m_choices[m_choiceIndex].getKey(), std::make_pair(target, edouble(0)));
+  return true;
+}
+
 void OpenConditionDecisionPoint::handleUndo() {
   debugMsg("SolverDecisionPoint:handleUndo", "Retracting open condition decision on " << m_flawedToken->getPredicateName().toString() <<
            "(" << m_flawedToken->getKey() << ").");
   m_client->cancel(m_flawedToken);
 
+  // The next merge choice, if any, is generated by hasNext once the database has been restored.
   if(m_choices[m_choiceIndex] == Token::MERGED) {
     m_mergeIndex++;
-    if(m_mergeIndex == m_mergeCount)
+    if(m_mergeIndex == m_mergeCount && m_candidates.empty())
       m_choiceIndex++;
   }
   else
@@ -139,6 +190,11 @@ void OpenConditionDecisionPoint::handleUndo() {
 }
 
 bool OpenConditionDecisionPoint::hasNext() const {
+  if(m_choiceIndex < m_choiceCount && m_choices[m_choiceIndex] == Token::MERGED && m_mergeIndex == m_mergeCount) {
+    OpenConditionDecisionPoint* self = const_cast<OpenConditionDecisionPoint*>(this);
+    if(!self->generateMergeChoice())
+      self->m_choiceIndex++;
+  }
   return m_choiceIndex < m_choiceCount;
 }
 
@@ -151,7 +207,10 @@ std::string OpenConditionDecisionPoint::toShortString() const{
     os << "EMPTY";
   }
   else if(m_choices[idx] == Token::MERGED) {
-    os << "MRG(" << m_flawedToken->getKey() << "," << m_compatibleTokens[m_mergeIndex]->getKey() << ")";
+    os << "MRG(" << m_flawedToken->getKey();
+    if(m_mergeIndex < m_mergeCount)
+      os << "," << m_compatibleTokens[m_mergeIndex]->getKey();
+    os << ")";
   }
   else if(m_choices[idx] == Token::ACTIVE) {
     os << "ACT(" << m_flawedToken->getKey() << ")";
@@ -180,6 +239,8 @@ std::string OpenConditionDecisionPoint::toString() const{
       TokenId token = *it;
       strStream << " " << token->getKey() << " ";
     }
+    if(!m_candidates.empty())
+      strStream << " (" << m_candidates.size() << " untested) ";
     strStream << "}";
   }
 
@@ -3,6 +3,7 @@
 
 #include "SolverDefs.hh"
 #include "SolverDecisionPoint.hh"
+#include <list>
 #include <vector>
 
 /**
@@ -23,6 +24,10 @@ namespace EUROPA {
      * this token. We will also permit resolution by creation and allocation of a token and then merging on that new one.
      * @li REJECT. If REJECT is a valid choice, then we will address this flaw by rejecting
      * this token.
+     *
+     * Tokens to merge with are generated on demand: candidates are tested for compatibility one at a time, in
+     * the order given by selectCandidate, and only when the previous merge has been retracted. A decision that
+     * succeeds on its first merge therefore tests as few candidates as it can.
      */
     class OpenConditionDecisionPoint: public DecisionPoint {
     public:
@@ -58,6 +63,16 @@ namespace EUROPA {
        */
       const TokenId getToken() const;
 
+      /**
+       * @brief The signature of a choice is the state assigned and, for a merge, the key of the active token.
+       */
+      virtual bool getChoiceSignature(ChoiceSignature& signature) const;
+
+      /**
+       * @brief The state choices plus the compatible tokens found so far.
+       */
+      virtual unsigned int getChoicesBuilt() const;
+
     protected:
       virtual void handleInitialize();
       virtual void handleExecute();
@@ -65,9 +80,32 @@ namespace EUROPA {
       virtual bool hasNext() const;
       virtual bool canUndo() const;
 
+      /**
+       * @brief Pick the next untested merge candidate. The default takes them in plan database order.
+       * @param candidates The untested candidates. Never empty.
+       */
+      virtual std::list<TokenId>::iterator selectCandidate(std::list<TokenId>& candidates);
+
+      /**
+       * @brief Collect the active tokens the flawed token might merge with.
+       */
+      void initializeMergeCandidates();
+
+      /**
+       * @brief Test candidates until another compatible token is appended to m_compatibleTokens.
+       * @return false if no candidates were compatible.
+       */
+      bool generateMergeChoice();
+
+      /**
+       * @brief Test all remaining candidates.
+       */
+      void generateAllMergeChoices();
+
       const TokenId m_flawedToken; /*!< The token to be resolved. */
       std::vector<LabelStr> m_choices; /*!< The sequences list of states to choose. */
-      std::vector<TokenId> m_compatibleTokens; /*!< A possibly empty collection of tokens to merge with. */
+      std::vector<TokenId> m_compatibleTokens; /*!< The tokens found so far to merge with. */
+      std::list<TokenId> m_candidates; /*!< Active tokens not yet tested for compatibility. */
       unsigned long m_mergeCount; /*!< The size of m_compatibleTokens */
       unsigned long m_choiceCount; /*!< The size of m_choices. */
       unsigned long m_mergeIndex; /*!< The position of the next choice in m_compatibleTokens. */
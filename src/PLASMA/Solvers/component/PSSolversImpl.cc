@@ -81,18 +81,11 @@ bool PSSolverImpl::solve(int maxSteps, int maxDepth) {
   }
 
   bool PSSolverImpl::hasFlaws() {
-    return !m_solver->noMoreFlaws();
+    return m_solver->hasFlaws();
   }
 
   int PSSolverImpl::getOpenDecisionCnt() {
-    int count = 0;
-    IteratorId flawIt = m_solver->createIterator();
-    while(!flawIt->done()) {
-      count++;
-      flawIt->next();
-    }
-    delete static_cast<Iterator*>(flawIt);
-    return count;
+    return m_solver->getFlawCount();
   }
 
   PSList<std::string> PSSolverImpl::getFlaws() {
@@ -118,6 +111,24 @@ bool PSSolverImpl::solve(int maxSteps, int maxDepth) {
     return retval;
   }
 
+  namespace {
+    class FlawIteratorImpl : public PSFlawIterator {
+    public:
+      FlawIteratorImpl(const SOLVERS::Solver& solver) : m_it(solver) {}
+      bool done() const {return m_it.done();}
+      void next() {m_it.next();}
+      PSEntityKey getEntityKey() const {return m_it.getEntity()->getEntityKey();}
+      const std::string& getFlawManager() const {return m_it.getFlawManager()->getName().toString();}
+      double getPriority() const {return m_it.getPriority();}
+    private:
+      SOLVERS::Solver::OpenFlawIterator m_it;
+    };
+  }
+
+  PSFlawIterator* PSSolverImpl::getFlawIterator() {
+    return new FlawIteratorImpl(*m_solver);
+  }
+
   std::string PSSolverImpl::getLastExecutedDecision() {
     return m_solver->getLastExecutedDecision();
   }
@@ -43,6 +43,7 @@ class PSSolverImpl : public PSSolver {
 
   virtual bool hasFlaws();
   virtual PSList<std::string> getFlaws();
+  virtual PSFlawIterator* getFlawIterator();
   virtual std::string getLastExecutedDecision();
 
   virtual const std::string& getConfigFilename();
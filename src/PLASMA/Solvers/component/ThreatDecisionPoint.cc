@@ -5,6 +5,9 @@
 #include "DbClient.hh"
 #include "Debug.hh"
 #include "PlanDatabase.hh"
+#include "ConstraintEngine.hh"
+
+#include <algorithm>
 
 /**
  * @author Conor McGann
@@ -23,7 +26,8 @@ namespace EUROPA {
                                            const TiXmlElement&,
                                            const LabelStr& explanation)
       : DecisionPoint(client, tokenToOrder->getKey(), explanation),
-        m_tokenToOrder(tokenToOrder), m_choices(), m_choiceCount(0), m_index(0) {
+        m_tokenToOrder(tokenToOrder), m_choices(), m_choiceCount(0), m_index(0),
+        m_objects(), m_objectIndex(0), m_objectChoiceCount(0) {
       // Here is where we would look for custom processing for configuration of the decision point
     }
 
@@ -57,32 +61,84 @@ namespace EUROPA {
 		 << m_tokenToOrder->toString() << ";" << predecessor->toString() << "; " << successor->toString());
 
       m_client->free(object, predecessor, successor);
-      m_index++; // Advance to next choice
+      m_index++; // Advance to next choice. If it has not been generated, hasNext will do so.
+    }
+
+    bool ThreatDecisionPoint::getChoiceSignature(ChoiceSignature& signature) const {
+      if(!isExecuted())
+        return false;
+      ObjectId object;
+      TokenId predecessor;
+      TokenId successor;
+      extractParts(m_index, object, predecessor, successor);
+      signature = ChoiceSignature(object->getKey(), std::make_pair(edouble(predecessor->getKey()),
+                                                                    edouble(successor->getKey())));
+      return true;
     }
 
     bool ThreatDecisionPoint::hasNext() const {
+      if(m_index == m_choiceCount)
+        const_cast<ThreatDecisionPoint*>(this)->generateChoices();
       return m_index < m_choiceCount;
     }
 
-    class ObjectComparator {
-    public:
-      bool operator() (const std::pair<ObjectId, std::pair<TokenId, TokenId> >& p1,
-		       const std::pair<ObjectId, std::pair<TokenId, TokenId> >& p2) const {
-	ObjectId o1 = p1.first;
-	ObjectId o2 = p2.first;
-	return o1->getKey() < o2->getKey();
-      }
-      bool operator==(const ObjectComparator&){return true;}
-    };
-
     /**
      * @brief populate over all objects in the tokens object domain. Should customize to change the ordering.
+     * Only the first choice is generated here.
      */
     void ThreatDecisionPoint::handleInitialize() {
-      m_tokenToOrder->getPlanDatabase()->getOrderingChoices(m_tokenToOrder, m_choices);
-      ObjectComparator cmp;
-      std::sort<std::vector<std::pair<ObjectId, std::pair<TokenId, TokenId> > >::iterator, ObjectComparator&>(m_choices.begin(), m_choices.end(), cmp);
-      m_choiceCount = m_choices.size();
+      const std::map<eint, std::pair<TokenId, ObjectSet> >& tokensToOrder =
+          m_tokenToOrder->getPlanDatabase()->getTokensToOrder();
+      std::map<eint, std::pair<TokenId, ObjectSet> >::const_iterator entry = tokensToOrder.find(m_tokenToOrder->getKey());
+      checkError(entry != tokensToOrder.end(),
+                 "Should not be calling this method if it is not a token in need of ordering. " << m_tokenToOrder->toString());
+
+      // The set is ordered by key
+      m_objects.assign(entry->second.second.begin(), entry->second.second.end());
+      generateChoices();
+    }
+
+    bool ThreatDecisionPoint::generateChoices() {
+      // Deeper decisions have all been retracted, so propagation restores the state the objects were collected in.
+      if(m_objectIndex == m_objects.size() ||
+         !m_tokenToOrder->getPlanDatabase()->getConstraintEngine()->propagate())
+        return false;
+
+      while(m_objectIndex < m_objects.size()) {
+        ObjectId object = m_objects[m_objectIndex];
+        check_error(object.isValid());
+
+        // Objects return a prefix of their choices when limited, so ask again for twice as many
+        unsigned long limit = std::max(2 * m_objectChoiceCount, 1ul);
+        std::vector<std::pair<TokenId, TokenId> > choices;
+        object->getOrderingChoices(m_tokenToOrder, choices, limit);
+        checkError(m_objectChoiceCount == 0 || choices.size() < m_objectChoiceCount ||
+                   choices[m_objectChoiceCount - 1] == m_choices.back().second,
+                   "Expected a prefix of the ordering choices for " << m_tokenToOrder->getKey() << " on " << object->getName().toString());
+
+        for(unsigned long i = m_objectChoiceCount; i < choices.size(); i++)
+          m_choices.push_back(std::make_pair(object, choices[i]));
+
+        const bool added = choices.size() > m_objectChoiceCount;
+        m_objectChoiceCount = choices.size();
+        if(choices.size() < limit) {
+          m_objectIndex++;
+          m_objectChoiceCount = 0;
+        }
+
+        if(added) {
+          m_choiceCount = m_choices.size();
+          debugMsg("ThreatDecisionPoint:generateChoices",
+                   "Have " << m_choiceCount << " choices for " << m_tokenToOrder->getKey());
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    void ThreatDecisionPoint::generateAllChoices() {
+      while(generateChoices());
     }
 
     std::string ThreatDecisionPoint::toShortString() const {
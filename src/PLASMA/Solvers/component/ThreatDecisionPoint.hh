@@ -15,6 +15,9 @@ namespace SOLVERS {
 /**
  * @brief Defines a class for formulation, execution and retraction of token ordering
  * decisions as a means to resolve object flaws.
+ *
+ * Choices are generated on demand, object by object in key order. Each object is asked for a batch of
+ * choices at a time, doubling the batch whenever the previous one has been used up.
  */
 class ThreatDecisionPoint: public DecisionPoint {
  public:
@@ -33,9 +36,30 @@ class ThreatDecisionPoint: public DecisionPoint {
   virtual std::string toString() const;
   virtual std::string toShortString() const;
 
+  /**
+   * @brief The signature of an ordering is the keys of the object, the predecessor and the successor.
+   */
+  virtual bool getChoiceSignature(ChoiceSignature& signature) const;
+
+  /**
+   * @brief The ordering choices generated so far.
+   */
+  virtual unsigned int getChoicesBuilt() const {return m_choiceCount;}
+
  protected:
   virtual void handleInitialize();
 
+  /**
+   * @brief Append the next batch of choices to m_choices.
+   * @return false if every object has been asked for all of its choices.
+   */
+  bool generateChoices();
+
+  /**
+   * @brief Append all remaining choices. For orderings that must see every choice.
+   */
+  void generateAllChoices();
+
   void extractParts(unsigned long index, ObjectId& object, TokenId& predecessor,
                     TokenId& successor) const;
 
@@ -46,6 +70,9 @@ class ThreatDecisionPoint: public DecisionPoint {
   std::vector< std::pair<ObjectId, std::pair<TokenId, TokenId> > > m_choices; /*!< Choices across all objects */
   unsigned long m_choiceCount; /*!< Stored choice count - size of m_orderingChoices */
   unsigned long m_index; /*!< Current choice position in m_orderingChoices */
+  std::vector<ObjectId> m_objects; /*!< Objects the token must be ordered on, by key */
+  unsigned long m_objectIndex; /*!< The object choices are being generated from */
+  unsigned long m_objectChoiceCount; /*!< Choices taken so far from the current object */
 
  private:
   virtual void handleExecute();
@@ -25,7 +25,8 @@ namespace EUROPA {
                                                                const LabelStr& explanation)
       : DecisionPoint(dbClient, flawedVariable->getKey(), explanation),
         m_flawedVariable(flawedVariable),
-        m_choices(ValueSource::getSource(dbClient->getSchema(),flawedVariable)){
+        m_choices(ValueSource::getSource(dbClient->getSchema(),flawedVariable)),
+        m_value(0){
       checkError(flawedVariable->lastDomain().areBoundsFinite(),
                  "Attempted to allocate a Decision Point for a domain with infinite bounds for variable " 
                  << flawedVariable->toString());
@@ -46,8 +47,14 @@ namespace EUROPA {
 
     void UnboundVariableDecisionPoint::handleInitialize(){}
 
+    bool UnboundVariableDecisionPoint::getChoiceSignature(ChoiceSignature& signature) const {
+      signature = ChoiceSignature(m_value, std::make_pair(edouble(0), edouble(0)));
+      return isExecuted();
+    }
+
     void UnboundVariableDecisionPoint::handleExecute(){
       edouble nextValue = getNext();
+      m_value = nextValue;
       debugMsg("SolverDecisionPoint:handleExecute", "For " << m_flawedVariable->toLongString() << 
                ", assigning value " << nextValue << ".");
       m_client->specify(m_flawedVariable, nextValue);
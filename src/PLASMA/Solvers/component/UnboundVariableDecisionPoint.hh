@@ -51,6 +51,11 @@ class UnboundVariableDecisionPoint: public DecisionPoint {
 
   const ConstrainedVariableId getFlawedVariable() const;
 
+  /**
+   * @brief The signature of an assignment is the value assigned.
+   */
+  virtual bool getChoiceSignature(ChoiceSignature& signature) const;
+
  protected:
 
   UnboundVariableDecisionPoint(const DbClientId client, const ConstrainedVariableId flawedVariable, const TiXmlElement& configData,
@@ -60,6 +65,8 @@ class UnboundVariableDecisionPoint: public DecisionPoint {
 
   ValueSource* m_choices;
 
+  edouble m_value; /*!< The value last assigned */
+
   virtual void handleInitialize();
 
   virtual void handleExecute();
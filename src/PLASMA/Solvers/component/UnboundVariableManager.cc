@@ -185,6 +185,8 @@ UnboundVariableManager::UnboundVariableManager(const TiXmlElement& configData)
                    " because it has " << vb->lastDomain().getSize() << " choices, as opposed to " << va->lastDomain().getSize());
           return false;
         }
+        // Equal on every count, so fall back on random tie breaking if it is on
+        return breakTie(a, b, explanation);
       }
       //if a isn't provably better, we return false
       return false;
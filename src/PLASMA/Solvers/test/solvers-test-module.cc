@@ -1,6 +1,8 @@
 #include "solvers-test-module.hh"
 //#include "Nddl.hh"
 #include "Solver.hh"
+#include "SolverPortfolio.hh"
+#include "SearchProfiler.hh"
 #include "ComponentFactory.hh"
 #include "Constraint.hh"
 #include "ConstraintType.hh"
@@ -25,6 +27,7 @@
 #include "Context.hh"
 #include "STNTemporalAdvisor.hh"
 #include "DbClientTransactionPlayer.hh"
+#include "DbClientTransactionLog.hh"
 #include "TemporalPropagator.hh"
 #include "CESchema.hh"
 #include "tinyxml.h"
@@ -241,6 +244,7 @@ class FilterTests {
 public:
   static bool test(){
     EUROPA_runTest(testRuleMatching);
+    EUROPA_runTest(testMatchTable);
     EUROPA_runTest(testVariableFiltering);
     EUROPA_runTest(testTokenFiltering);
     EUROPA_runTest(testThreatFiltering);
@@ -460,6 +464,36 @@ private:
     return true;
   }
 
+  static bool testMatchTable() {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/RuleMatchingTests.xml").c_str(), "MatchingEngine");
+    MatchingEngine me(testEngine.getId(),*root);
+    CPPUNIT_ASSERT(me.matchTableSize() == 0);
+
+    Variable<IntervalIntDomain> v0(testEngine.getConstraintEngine(), IntervalIntDomain(0, 10), false, true, "arg3");
+    Variable<IntervalIntDomain> v1(testEngine.getConstraintEngine(), IntervalIntDomain(0, 5), false, true, "arg3");
+    Variable<IntervalIntDomain> v2(testEngine.getConstraintEngine(), IntervalIntDomain(0, 5), false, true, "v2");
+
+    std::vector<MatchingRuleId> rules;
+    me.getMatches(v0.getId(), rules);
+    CPPUNIT_ASSERT(rules.size() == 2);
+    CPPUNIT_ASSERT(me.matchTableSize() == 1);
+    const unsigned int cycleCount = me.cycleCount();
+
+    // Same name, so the matches are found in the table
+    std::vector<MatchingRuleId> cached;
+    me.getMatches(v1.getId(), cached);
+    CPPUNIT_ASSERT(cached == rules);
+    CPPUNIT_ASSERT(me.cycleCount() == cycleCount);
+    CPPUNIT_ASSERT(me.matchTableSize() == 1);
+
+    me.getMatches(v2.getId(), rules);
+    CPPUNIT_ASSERT(rules.size() == 1);
+    CPPUNIT_ASSERT(me.cycleCount() == cycleCount + 1);
+    CPPUNIT_ASSERT(me.matchTableSize() == 2);
+    return true;
+  }
+
   static bool testVariableFiltering(){
     TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/FlawFilterTests.xml").c_str(), "UnboundVariableManager");
 
@@ -585,6 +619,7 @@ public:
     EUROPA_runTest(testValueEnum);
     EUROPA_runTest(testHSTSOpenConditionDecisionPoint);
     EUROPA_runTest(testHSTSThreatDecisionPoint);
+    EUROPA_runTest(testLazyChoices);
     return true;
   }
 
@@ -1594,6 +1629,88 @@ private:
     delete farHeurXml;
     return true;
   }
+
+  /**
+   * @brief Merge and ordering choices should only be generated as they are needed, and in the order
+   * an eager enumeration would have given.
+   */
+  static bool testLazyChoices() {
+    TestEngine testEngine(true);
+    testEngine.getSchema()->addPredicate("A.Foo");
+    PlanDatabaseId db = testEngine.getPlanDatabase();
+    DbClientId client = db->getClient();
+    Timeline o1(db, "A", "o1");
+
+    IntervalToken tok1(db, "A.Foo", false, false, IntervalIntDomain(0, 10), IntervalIntDomain(10, 20),
+                       IntervalIntDomain(10, 10), "o1");
+    IntervalToken tok2(db, "A.Foo", false, false, IntervalIntDomain(20, 30), IntervalIntDomain(30, 40),
+                       IntervalIntDomain(10, 10), "o1");
+    IntervalToken tok3(db, "A.Foo", false, false, IntervalIntDomain(40, 50), IntervalIntDomain(50, 60),
+                       IntervalIntDomain(10, 10), "o1");
+    client->activate(tok1.getId());
+    client->activate(tok2.getId());
+    client->activate(tok3.getId());
+    IntervalToken flawedToken(db, "A.Foo", false, false, IntervalIntDomain(0, 50), IntervalIntDomain(10, 60),
+                              IntervalIntDomain(10, 10), "o1");
+    CPPUNIT_ASSERT(client->propagate());
+
+    std::vector<TokenId> compatibleTokens;
+    db->getCompatibleTokens(flawedToken.getId(), compatibleTokens, std::numeric_limits<unsigned int>::max(), true);
+    CPPUNIT_ASSERT(compatibleTokens.size() == 3);
+
+    std::string ocHeur("<FlawHandler component=\"OpenConditionDecisionPoint\"/>");
+    TiXmlElement* ocXml = initXml(ocHeur);
+    SOLVERS::OpenConditionDecisionPoint oc(client, flawedToken.getId(), *ocXml);
+    DecisionPoint& ocDecision = oc;
+    oc.initialize();
+    // One merge, plus activation
+    CPPUNIT_ASSERT(oc.getChoicesBuilt() == 2);
+    for(unsigned int i = 0; i < compatibleTokens.size(); i++){
+      CPPUNIT_ASSERT(ocDecision.hasNext());
+      ocDecision.execute();
+      CPPUNIT_ASSERT(flawedToken.isMerged() && flawedToken.getActiveToken() == compatibleTokens[i]);
+      CPPUNIT_ASSERT(oc.getChoicesTried() == i + 1 && oc.getChoicesBuilt() == i + 2);
+      ocDecision.undo();
+    }
+    CPPUNIT_ASSERT(ocDecision.hasNext());
+    ocDecision.execute();
+    CPPUNIT_ASSERT(flawedToken.isActive());
+    CPPUNIT_ASSERT(oc.getChoicesBuilt() == 4);
+
+    // Now order the active token on the timeline
+    client->constrain(o1.getId(), tok1.getId(), tok2.getId());
+    client->constrain(o1.getId(), tok2.getId(), tok3.getId());
+    CPPUNIT_ASSERT(client->propagate());
+
+    std::vector<OrderingChoice> orderingChoices;
+    db->getOrderingChoices(flawedToken.getId(), orderingChoices);
+    CPPUNIT_ASSERT(orderingChoices.size() > 2);
+
+    std::string threatHeur("<FlawHandler component=\"ThreatDecisionPoint\"/>");
+    TiXmlElement* threatXml = initXml(threatHeur);
+    SOLVERS::ThreatDecisionPoint threat(client, flawedToken.getId(), *threatXml);
+    DecisionPoint& threatDecision = threat;
+    threat.initialize();
+    CPPUNIT_ASSERT(threat.getChoicesBuilt() == 1);
+    for(unsigned int i = 0; i < orderingChoices.size(); i++){
+      CPPUNIT_ASSERT(threatDecision.hasNext());
+      threatDecision.execute();
+      ChoiceSignature signature;
+      CPPUNIT_ASSERT(threat.getChoiceSignature(signature));
+      CPPUNIT_ASSERT(signature.first == orderingChoices[i].first->getKey());
+      CPPUNIT_ASSERT(signature.second.first == orderingChoices[i].second.first->getKey());
+      CPPUNIT_ASSERT(signature.second.second == orderingChoices[i].second.second->getKey());
+      CPPUNIT_ASSERT(threat.getChoicesBuilt() <= 2 * threat.getChoicesTried());
+      threatDecision.undo();
+    }
+    CPPUNIT_ASSERT(!threatDecision.hasNext());
+    CPPUNIT_ASSERT(threat.getChoicesBuilt() == orderingChoices.size());
+
+    ocDecision.undo();
+    delete ocXml;
+    delete threatXml;
+    return true;
+  }
 };
 
 class SolverTests {
@@ -1614,6 +1731,18 @@ public:
     EUROPA_runTest(testDeleteAfterCommit);
     EUROPA_runTest(testSingleonGuardLoop);
     EUROPA_runTest(testNoMoreFlawsAfterAddition);
+    EUROPA_runTest(testPortfolio);
+    EUROPA_runTest(testPortfolioSearchStrategies);
+    EUROPA_runTest(testRestarts);
+    EUROPA_runTest(testBackjumping);
+    EUROPA_runTest(testBackjumpingOverOpenCondition);
+    EUROPA_runTest(testNogoodStore);
+    EUROPA_runTest(testNogoods);
+    EUROPA_runTest(testFlawEnumeration);
+    EUROPA_runTest(testChoiceStatistics);
+    EUROPA_runTest(testSearchProfiler);
+    EUROPA_runTest(testDiscrepancySearch);
+    EUROPA_runTest(testBeamSearch);
     return true;
   }
 
@@ -1637,6 +1766,551 @@ private:
   }
 
 
+  static bool testPortfolio() {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "Portfolio");
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    client->enableTransactionLogging();
+    DbClientTransactionLog txLog(client);
+
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "v0"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "v1"));
+    client->createConstraint("neq", scope);
+    CPPUNIT_ASSERT(client->propagate());
+
+    SolverPortfolio portfolio(testEngine.getRulesEngine(), txLog.getId());
+    for(TiXmlElement* child = root->FirstChildElement(); child != NULL; child = child->NextSiblingElement())
+      portfolio.addConfiguration(*child);
+    CPPUNIT_ASSERT(portfolio.getConfigurationCount() == 2);
+    CPPUNIT_ASSERT(portfolio.solve(100, 100));
+
+    const int winner = portfolio.getWinner();
+    CPPUNIT_ASSERT(winner == 0 || winner == 1);
+    const std::vector<SolverPortfolio::Statistics>& stats = portfolio.getStatistics();
+    CPPUNIT_ASSERT(stats.size() == 2);
+    CPPUNIT_ASSERT(stats[0].name == "PortfolioMin" && stats[1].name == "PortfolioMax");
+    CPPUNIT_ASSERT(stats[winner].solved && stats[winner].stepCount == 2);
+    for(unsigned int i = 0; i < stats.size(); i++)
+      CPPUNIT_ASSERT((stats[i].solved || stats[i].cancelled) && !stats[i].exhausted && stats[i].error.empty());
+
+    // The plan lives in the winner's fork, and the parent is left alone
+    const ConstrainedVariableSet& solved = portfolio.getPlanDatabase(winner)->getGlobalVariables();
+    CPPUNIT_ASSERT(solved.size() == 2);
+    for(ConstrainedVariableSet::const_iterator it = solved.begin(); it != solved.end(); ++it)
+      CPPUNIT_ASSERT((*it)->lastDomain().isSingleton());
+    for(std::vector<ConstrainedVariableId>::const_iterator it = scope.begin(); it != scope.end(); ++it)
+      CPPUNIT_ASSERT(!(*it)->lastDomain().isSingleton());
+
+    return true;
+  }
+
+  /**
+   * @brief Each configuration is searched with the strategy it selects. Depth first search would solve
+   * this problem, limited discrepancy search with one discrepancy does not.
+   */
+  static bool testPortfolioSearchStrategies() {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "SearchStrategies");
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    client->enableTransactionLogging();
+    DbClientTransactionLog txLog(client);
+
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "y0"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "y1"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "y2"));
+    client->createConstraint("lazyAllDiff", scope);
+    CPPUNIT_ASSERT(client->propagate());
+
+    {
+      SolverPortfolio portfolio(testEngine.getRulesEngine(), txLog.getId());
+      portfolio.addConfiguration(*root->FirstChildElement());
+      CPPUNIT_ASSERT(!portfolio.solve());
+      CPPUNIT_ASSERT(portfolio.getWinner() == -1);
+      const SolverPortfolio::Statistics& stats = portfolio.getStatistics()[0];
+      CPPUNIT_ASSERT(stats.name == "DiscrepancySolver");
+      CPPUNIT_ASSERT(stats.timedOut && !stats.exhausted && !stats.cancelled && stats.error.empty());
+      CPPUNIT_ASSERT(portfolio.getSolver(0)->getDiscrepancyLimit() == std::numeric_limits<unsigned int>::max());
+    }
+
+    {
+      SolverPortfolio portfolio(testEngine.getRulesEngine(), txLog.getId());
+      portfolio.addConfiguration(*root->FirstChildElement()->NextSiblingElement());
+      CPPUNIT_ASSERT(portfolio.solve());
+      const SolverPortfolio::Statistics& stats = portfolio.getStatistics()[0];
+      CPPUNIT_ASSERT(stats.name == "BeamSolver" && stats.solved && stats.depth == 3);
+
+      // The beam tries every choice of each decision, so it takes more steps than the plan has decisions
+      CPPUNIT_ASSERT(stats.stepCount > stats.depth);
+      std::vector<ConstrainedVariableId> solved;
+      const ConstrainedVariableSet& vars = portfolio.getPlanDatabase(0)->getGlobalVariables();
+      solved.insert(solved.end(), vars.begin(), vars.end());
+      CPPUNIT_ASSERT(allDifferent(solved));
+    }
+
+    return true;
+  }
+
+  static bool testRestarts() {
+    static const unsigned int luby[] = {1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8};
+    for(unsigned int i = 0; i < sizeof(luby) / sizeof(luby[0]); i++)
+      CPPUNIT_ASSERT(Solver::lubyTerm(i + 1) == luby[i]);
+
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "SimpleCSPSolver");
+    TiXmlElement* child = root->FirstChildElement();
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 3), "v0"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 3), "v1"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 3), "v2"));
+    client->createConstraint("allDiff", scope);
+
+    // Three steps are needed, so with a unit budget the Luby runs get 1, 1, 2, 1, 1, 2 and then 4 steps
+    {
+      Solver solver(testEngine.getPlanDatabase(), *child);
+      CPPUNIT_ASSERT(solver.solveWithRestarts(1, 10));
+      CPPUNIT_ASSERT(solver.getRestartCount() == 6);
+      CPPUNIT_ASSERT(solver.getDepth() == 3);
+      solver.reset();
+      for(std::vector<ConstrainedVariableId>::const_iterator it = scope.begin(); it != scope.end(); ++it)
+        CPPUNIT_ASSERT(!(*it)->lastDomain().isSingleton());
+    }
+
+    // Geometric runs get 1, 1, 2 and then 3 steps
+    {
+      Solver solver(testEngine.getPlanDatabase(), *child);
+      CPPUNIT_ASSERT(solver.solveWithRestarts(1, 10, Solver::GEOMETRIC_RESTARTS, 7));
+      CPPUNIT_ASSERT(solver.getRestartCount() == 3);
+      solver.reset();
+    }
+
+    // Out of restarts
+    {
+      Solver solver(testEngine.getPlanDatabase(), *child);
+      CPPUNIT_ASSERT(!solver.solveWithRestarts(1, 2));
+      CPPUNIT_ASSERT(solver.getRestartCount() == 2);
+      CPPUNIT_ASSERT(solver.isTimedOut() && !solver.isExhausted());
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Decide x0 and x1 first, then fail on y0 and y1 which are only tied to x0. Backjumping
+   * should skip the choices for x1 but keep those for x0.
+   */
+  static unsigned int searchForBackjumping(bool backjumping, bool solvable) {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "Backjumping");
+    TiXmlElement* child = root->FirstChildElement();
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y0"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y1"));
+    if(solvable)
+      scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "x0"));
+    else
+      scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y2"));
+    client->createConstraint("lazyAllDiff", scope);
+    if(!solvable)
+      client->createVariable("int", IntervalIntDomain(0, 2), "x0");
+    client->createVariable("int", IntervalIntDomain(0, 2), "x1");
+
+    Solver solver(testEngine.getPlanDatabase(), *child);
+    solver.setBackjumping(backjumping);
+    const bool solved = solver.solve();
+    CPPUNIT_ASSERT(solved == solvable);
+    CPPUNIT_ASSERT(solved || solver.isExhausted());
+    if(solved){
+      const ConstrainedVariableId x0 = scope.back();
+      CPPUNIT_ASSERT(x0->lastDomain().getSingletonValue() == 2);
+    }
+    return solver.getStepCount();
+  }
+
+  static bool testBackjumping() {
+    const unsigned int chronological = searchForBackjumping(false, true);
+    const unsigned int backjumping = searchForBackjumping(true, true);
+    CPPUNIT_ASSERT(backjumping < chronological);
+
+    // Nothing the y's depend on was decided, so the search gives up once they run out of choices
+    CPPUNIT_ASSERT(searchForBackjumping(true, false) < searchForBackjumping(false, false));
+    return true;
+  }
+
+  /**
+   * @brief A token that can only be merged fails on the one token it is compatible with, because deciding
+   * the start of the other token first put it out of reach. No constraint ties that decision to the failure,
+   * so only chronological backtracking from the open condition gets back to it.
+   */
+  static bool testBackjumpingOverOpenCondition() {
+    TestEngine testEngine(true);
+    testEngine.getSchema()->addPredicate("A.Foo");
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "BackjumpingOverOpenCondition");
+    TiXmlElement* child = root->FirstChildElement();
+    PlanDatabaseId db = testEngine.getPlanDatabase();
+    DbClientId client = db->getClient();
+    Object o1(db, "A", "o1");
+
+    IntervalToken fixedToken(db, "A.Foo", false, false, IntervalIntDomain(5, 5), IntervalIntDomain(8, 8),
+                             IntervalIntDomain(3, 3), "o1");
+    IntervalToken freeToken(db, "A.Foo", false, false, IntervalIntDomain(0, 10), IntervalIntDomain(1, 11),
+                            IntervalIntDomain(1, 1), "o1");
+    client->activate(fixedToken.getId());
+    client->activate(freeToken.getId());
+    IntervalToken flawedToken(db, "A.Foo", false, false, IntervalIntDomain(5, 5), IntervalIntDomain(6, 15),
+                              IntervalIntDomain(1, 10), "o1");
+    // The flawed token can only be merged
+    StateDomain active;
+    active.remove(Token::MERGED);
+    active.remove(Token::REJECTED);
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(flawedToken.getState());
+    scope.push_back(client->createVariable("TokenStates", active, "notState"));
+    client->createConstraint("neq", scope);
+
+    // Merging onto the fixed token would give the flawed token the same duration as y
+    scope.clear();
+    scope.push_back(flawedToken.duration());
+    scope.push_back(client->createVariable("int", IntervalIntDomain(3, 3), "y"));
+    client->createConstraint("lazyAllDiff", scope);
+    CPPUNIT_ASSERT(client->propagate());
+
+    Solver solver(db, *child);
+    solver.setBackjumping(true);
+    CPPUNIT_ASSERT(solver.solve());
+    CPPUNIT_ASSERT(flawedToken.isMerged() && flawedToken.getActiveToken() == freeToken.getId());
+    CPPUNIT_ASSERT(freeToken.start()->lastDomain().getSingletonValue() == 5);
+    return true;
+  }
+
+  static bool testNogoodStore() {
+    const NogoodStore::Choice a(eint(1), ChoiceSignature(0, std::make_pair(edouble(0), edouble(0))));
+    const NogoodStore::Choice b(eint(2), ChoiceSignature(1, std::make_pair(edouble(0), edouble(0))));
+    const NogoodStore::Choice c(eint(3), ChoiceSignature(2, std::make_pair(edouble(4), edouble(5))));
+
+    NogoodStore store(2);
+    NogoodStore::Nogood ab;
+    ab.push_back(a);
+    ab.push_back(b);
+    store.add(ab);
+    store.add(ab);
+    store.add(NogoodStore::Nogood());
+    CPPUNIT_ASSERT(store.getSize() == 1);
+
+    std::set<NogoodStore::Choice> context;
+    CPPUNIT_ASSERT(store.match(b, context) == NULL);
+    context.insert(a);
+    CPPUNIT_ASSERT(store.match(b, context) != NULL);
+    CPPUNIT_ASSERT(store.match(c, context) == NULL);
+    CPPUNIT_ASSERT(store.getHitCount() == 1 && store.getMissCount() == 2);
+
+    // Matching {a, b} again makes {c} the least recently used, so it goes first
+    store.add(NogoodStore::Nogood(1, c));
+    CPPUNIT_ASSERT(store.match(a, std::set<NogoodStore::Choice>(&b, &b + 1)) != NULL);
+    store.add(NogoodStore::Nogood(1, a));
+    CPPUNIT_ASSERT(store.getSize() == 2);
+    CPPUNIT_ASSERT(!store.mentions(c));
+    CPPUNIT_ASSERT(store.mentions(a) && store.mentions(b));
+    CPPUNIT_ASSERT(store.match(a, std::set<NogoodStore::Choice>()) != NULL);
+
+    store.setCapacity(1);
+    CPPUNIT_ASSERT(store.getSize() == 1 && !store.mentions(b));
+    store.clear();
+    CPPUNIT_ASSERT(store.getSize() == 0 && store.getHitCount() == 3);
+
+    // Forgetting a key drops the nogoods that name it, whether as a flawed entity or in a signature
+    store.setCapacity(3);
+    store.add(ab);
+    store.add(NogoodStore::Nogood(1, c));
+    store.forget(eint(5));
+    CPPUNIT_ASSERT(store.getSize() == 1 && !store.mentions(c));
+    store.forget(eint(3));
+    CPPUNIT_ASSERT(store.getSize() == 1);
+    store.forget(eint(2));
+    CPPUNIT_ASSERT(store.getSize() == 0 && !store.mentions(a));
+    store.add(ab);
+    CPPUNIT_ASSERT(store.getSize() == 1);
+    return true;
+  }
+
+  class NogoodCounter : public SearchListener {
+  public:
+    NogoodCounter() : hits(0), misses(0) {}
+    void notifyNogoodHit(DecisionPointId) {hits++;}
+    void notifyNogoodMiss(DecisionPointId) {misses++;}
+    unsigned int hits, misses;
+  };
+
+  /**
+   * @brief Restart on a problem with no solution. Each run only gets so far, so without nogoods the search never
+   * finishes, while nogoods carry what earlier runs proved into later ones.
+   */
+  static bool testNogoods() {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "Backjumping");
+    TiXmlElement* child = root->FirstChildElement();
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y0"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y1"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y2"));
+    client->createConstraint("lazyAllDiff", scope);
+    client->createVariable("int", IntervalIntDomain(0, 2), "x0");
+    client->createVariable("int", IntervalIntDomain(0, 2), "x1");
+
+    {
+      Solver solver(testEngine.getPlanDatabase(), *child);
+      CPPUNIT_ASSERT(!solver.solveWithRestarts(4, 50));
+      CPPUNIT_ASSERT(solver.isTimedOut() && solver.getRestartCount() == 50);
+      solver.reset();
+    }
+
+    {
+      Solver solver(testEngine.getPlanDatabase(), *child);
+      solver.setNogoodLearning(100);
+      NogoodCounter counter;
+      solver.addListener(counter.getId());
+      CPPUNIT_ASSERT(!solver.solveWithRestarts(4, 50));
+      CPPUNIT_ASSERT(solver.isExhausted() && solver.getRestartCount() < 50);
+      const NogoodStore& nogoods = solver.getNogoodStore();
+      CPPUNIT_ASSERT(counter.hits > 0 && counter.hits == nogoods.getHitCount());
+      CPPUNIT_ASSERT(counter.misses == nogoods.getMissCount());
+      CPPUNIT_ASSERT(nogoods.getSize() > 0 && nogoods.getSize() <= 100);
+
+      solver.clear();
+      CPPUNIT_ASSERT(nogoods.getSize() == 0);
+    }
+
+    {
+      Solver solver(testEngine.getPlanDatabase(), *child);
+      solver.setNogoodLearning(2);
+      solver.solveWithRestarts(4, 10);
+      CPPUNIT_ASSERT(solver.getNogoodStore().getSize() > 0 && solver.getNogoodStore().getSize() <= 2);
+
+      // The database may change before the next search, so nothing learned is kept
+      solver.reset();
+      CPPUNIT_ASSERT(solver.getNogoodStore().getSize() == 0);
+    }
+
+    return true;
+  }
+
+  static bool testFlawEnumeration() {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "Backjumping");
+    TiXmlElement* child = root->FirstChildElement();
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    std::map<eint, Priority> expected;
+    expected[client->createVariable("int", IntervalIntDomain(0, 2), "x0")->getKey()] = 1;
+    expected[client->createVariable("int", IntervalIntDomain(0, 2), "x1")->getKey()] = 2;
+    expected[client->createVariable("int", IntervalIntDomain(0, 2), "y0")->getKey()] = 10;
+    CPPUNIT_ASSERT(client->propagate());
+
+    Solver solver(testEngine.getPlanDatabase(), *child);
+    CPPUNIT_ASSERT(solver.hasFlaws());
+    CPPUNIT_ASSERT(solver.getFlawCount() == 3);
+
+    std::map<eint, Priority> found;
+    for(Solver::OpenFlawIterator it(solver); !it.done(); it.next()){
+      CPPUNIT_ASSERT(it.getKey() == it.getEntity()->getKey());
+      CPPUNIT_ASSERT(it.getFlawManager()->getName() == LabelStr("UnboundVariableManager"));
+      found[it.getKey()] = it.getPriority();
+    }
+    CPPUNIT_ASSERT(found == expected);
+    CPPUNIT_ASSERT(solver.getOpenDecisions().size() == 3);
+
+    solver.step();
+    CPPUNIT_ASSERT(solver.getFlawCount() == 2);
+    CPPUNIT_ASSERT(solver.solve());
+    CPPUNIT_ASSERT(!solver.hasFlaws() && solver.getFlawCount() == 0);
+    CPPUNIT_ASSERT(Solver::OpenFlawIterator(solver).done());
+    return true;
+  }
+
+  static bool testChoiceStatistics() {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "Backjumping");
+    TiXmlElement* child = root->FirstChildElement();
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y0"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y1"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y2"));
+    client->createConstraint("lazyAllDiff", scope);
+    client->createVariable("int", IntervalIntDomain(0, 2), "x0");
+
+    Solver solver(testEngine.getPlanDatabase(), *child);
+    CPPUNIT_ASSERT(solver.getChoiceStatistics().decisions == 0);
+    CPPUNIT_ASSERT(!solver.solve());
+    Solver::ChoiceStatistics stats = solver.getChoiceStatistics();
+    CPPUNIT_ASSERT(stats.decisions > 0);
+    CPPUNIT_ASSERT(stats.tried > stats.decisions);
+    CPPUNIT_ASSERT(stats.built >= stats.tried);
+    CPPUNIT_ASSERT(stats.averageBuilt() >= stats.averageTried() && stats.averageTried() > 1);
+
+    solver.clear();
+    CPPUNIT_ASSERT(solver.getChoiceStatistics().decisions == 0);
+    return true;
+  }
+
+  static bool testSearchProfiler() {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "Backjumping");
+    TiXmlElement* child = root->FirstChildElement();
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y0"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y1"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 1), "y2"));
+    client->createConstraint("lazyAllDiff", scope);
+    client->createVariable("int", IntervalIntDomain(0, 2), "x0");
+
+    Solver solver(testEngine.getPlanDatabase(), *child);
+    SearchProfiler profiler(testEngine.getConstraintEngine(), 5);
+    solver.addListener(profiler.getId());
+    CPPUNIT_ASSERT(!solver.solve());
+
+    const SearchProfiler::Profile& total = profiler.getTotal();
+    CPPUNIT_ASSERT(total.decisions == solver.getChoiceStatistics().decisions);
+    CPPUNIT_ASSERT(total.intervals[SearchProfiler::EXECUTE] == solver.getChoiceStatistics().tried);
+    CPPUNIT_ASSERT(total.intervals[SearchProfiler::UNDO] > 0);
+    CPPUNIT_ASSERT(total.constraintExecutions[SearchProfiler::PROPAGATE] > 0);
+
+    // Every decision came from a Min handler: the one for x0 or the default
+    const std::map<std::string, SearchProfiler::Profile>& byType = profiler.getProfilesByType();
+    CPPUNIT_ASSERT(byType.find("Min") != byType.end());
+    CPPUNIT_ASSERT(byType.find("Min")->second.decisions == total.decisions);
+    CPPUNIT_ASSERT(byType.find("unknown")->second.decisions == 0);
+    CPPUNIT_ASSERT(profiler.getProfilesByHandler().size() == 3);
+
+    // Only the first few intervals are traced
+    unsigned int intervals = 0;
+    for(int phase = 0; phase < SearchProfiler::PHASE_COUNT; phase++)
+      intervals += total.intervals[phase];
+    CPPUNIT_ASSERT(profiler.getTraceEventCount() == 5);
+    CPPUNIT_ASSERT(profiler.getTraceEventCount() + profiler.getDroppedTraceEventCount() == intervals);
+
+    std::stringstream trace;
+    profiler.writeTrace(trace);
+    CPPUNIT_ASSERT(trace.str().find("{\"traceEvents\":[") == 0);
+    CPPUNIT_ASSERT(trace.str().find("\"name\":\"generate\",\"cat\":\"Min\"") != std::string::npos);
+
+    profiler.clear();
+    CPPUNIT_ASSERT(profiler.getTotal().decisions == 0 && profiler.getTraceEventCount() == 0);
+    solver.removeListener(profiler.getId());
+    return true;
+  }
+
+  class OutcomeCounter : public SearchListener {
+  public:
+    OutcomeCounter() : restarts(0), timeouts(0), exhausted(0), completed(0) {}
+    void notifyRestarted() {restarts++;}
+    void notifyTimedOut() {timeouts++;}
+    void notifyExhausted() {exhausted++;}
+    void notifyCompleted() {completed++;}
+    unsigned int restarts, timeouts, exhausted, completed;
+  };
+
+  static bool allDifferent(const std::vector<ConstrainedVariableId>& scope) {
+    std::set<edouble> values;
+    for(std::vector<ConstrainedVariableId>::const_iterator it = scope.begin(); it != scope.end(); ++it){
+      if(!(*it)->lastDomain().isSingleton())
+        return false;
+      values.insert((*it)->lastDomain().getSingletonValue());
+    }
+    return values.size() == scope.size();
+  }
+
+  /**
+   * @brief Min picks 0 for every variable, so a solution needs two discrepancies.
+   */
+  static bool testDiscrepancySearch() {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "SearchStrategies");
+    TiXmlElement* child = root->FirstChildElement();
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "y0"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "y1"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "y2"));
+    client->createConstraint("lazyAllDiff", scope);
+
+    Solver solver(testEngine.getPlanDatabase(), *child);
+    CPPUNIT_ASSERT(solver.getSearchStrategy() == Solver::LIMITED_DISCREPANCY);
+    OutcomeCounter counter;
+    solver.addListener(counter.getId());
+
+    // Configured for at most one discrepancy
+    CPPUNIT_ASSERT(!solver.solve());
+    CPPUNIT_ASSERT(solver.isTimedOut() && !solver.isExhausted());
+    CPPUNIT_ASSERT(counter.restarts == 1 && counter.timeouts == 1);
+
+    solver.setSearchStrategy(Solver::LIMITED_DISCREPANCY, 2);
+    CPPUNIT_ASSERT(solver.solve());
+    CPPUNIT_ASSERT(allDifferent(scope));
+    CPPUNIT_ASSERT(counter.restarts == 3);
+    solver.reset();
+
+    // Steps are limited over all runs
+    CPPUNIT_ASSERT(!solver.solveWithDiscrepancyLimit(2, 5));
+    CPPUNIT_ASSERT(solver.isTimedOut() && solver.getStepCount() == 5);
+    solver.reset();
+
+    // Without a solution, the search is exhausted once a run is not limited by discrepancies
+    ConstrainedVariableId y3 = client->createVariable("int", IntervalIntDomain(0, 2), "y3");
+    scope.push_back(y3);
+    client->createConstraint("lazyAllDiff", scope);
+    CPPUNIT_ASSERT(!solver.solveWithDiscrepancyLimit(std::numeric_limits<unsigned int>::max()));
+    CPPUNIT_ASSERT(solver.isExhausted() && !solver.isTimedOut());
+    CPPUNIT_ASSERT(solver.getDiscrepancyLimit() == std::numeric_limits<unsigned int>::max());
+    solver.removeListener(counter.getId());
+    return true;
+  }
+
+  static bool testBeamSearch() {
+    TestEngine testEngine;
+    TiXmlElement* root = initXml( (getTestLoadLibraryPath() + "/SolverTests.xml").c_str(), "SearchStrategies");
+    TiXmlElement* child = root->FirstChildElement()->NextSiblingElement();
+    DbClientId client = testEngine.getPlanDatabase()->getClient();
+    std::vector<ConstrainedVariableId> scope;
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "y0"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "y1"));
+    scope.push_back(client->createVariable("int", IntervalIntDomain(0, 2), "y2"));
+    client->createConstraint("lazyAllDiff", scope);
+
+    Solver solver(testEngine.getPlanDatabase(), *child);
+    CPPUNIT_ASSERT(solver.getSearchStrategy() == Solver::BEAM);
+    OutcomeCounter counter;
+    solver.addListener(counter.getId());
+
+    // A beam of one keeps 0 for the first two variables, and then runs out of plans
+    CPPUNIT_ASSERT(!solver.solveWithBeam(1));
+    CPPUNIT_ASSERT(solver.isTimedOut() && !solver.isExhausted());
+    CPPUNIT_ASSERT(solver.getDepth() == 0 && !scope[0]->lastDomain().isSingleton());
+
+    // Configured for a beam of three, which holds 0,1 long enough to find 0,1,2
+    CPPUNIT_ASSERT(solver.solve());
+    CPPUNIT_ASSERT(allDifferent(scope) && solver.getDepth() == 3);
+    CPPUNIT_ASSERT(counter.completed == 1);
+    solver.reset();
+
+    CPPUNIT_ASSERT(!solver.solveWithBeam(3, 10));
+    CPPUNIT_ASSERT(solver.isTimedOut() && solver.getStepCount() <= 10);
+    solver.reset();
+
+    // Nothing is dropped from a wide enough beam, so running out of plans means there is no solution
+    ConstrainedVariableId y3 = client->createVariable("int", IntervalIntDomain(0, 2), "y3");
+    scope.push_back(y3);
+    client->createConstraint("lazyAllDiff", scope);
+    CPPUNIT_ASSERT(!solver.solveWithBeam(100));
+    CPPUNIT_ASSERT(solver.isExhausted() && !solver.isTimedOut());
+    solver.removeListener(counter.getId());
+    return true;
+  }
+
   /**
    * @brief Tests for an infinite loop when binding a singleton guard.
    */
@@ -65,6 +65,8 @@ namespace EUROPA {
 
       virtual PSList<PSToken*> getTokens() = 0;
       virtual PSToken* getTokenByKey(PSEntityKey id) = 0;
+      virtual PSTokenIterator* getTokensOverlapping(PSObject* object, double lb, double ub) = 0;
+      virtual PSTokenIterator* getActiveTokensStartingIn(const std::string& predicate, double lb, double ub) = 0;
 
       virtual PSList<PSVariable*> getGlobalVariables() = 0;
 
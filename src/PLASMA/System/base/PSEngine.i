@@ -173,7 +173,9 @@ namespace EUROPA {
   class PSConstraint;
   class PSObject;
   class PSSolver;
+  class PSFlawIterator;
   class PSToken;
+  class PSTokenIterator;
   class PSVariable;
   class PSVarValue;
   class PSDataType;
@@ -307,6 +309,10 @@ namespace EUROPA {
 
     PSList<PSToken*> getTokens();
     PSToken* getTokenByKey(PSEntityKey id);
+    %newobject getTokensOverlapping;
+    PSTokenIterator* getTokensOverlapping(PSObject* object, double lb, double ub);
+    %newobject getActiveTokensStartingIn;
+    PSTokenIterator* getActiveTokensStartingIn(const std::string& predicate, double lb, double ub);
 
     bool getAutoPropagation() const;
     void setAutoPropagation(bool v);
@@ -420,6 +426,8 @@ namespace EUROPA {
 
     int getOpenDecisionCnt();
     PSList<std::string> getFlaws();
+    %newobject getFlawIterator;
+    PSFlawIterator* getFlawIterator();
     std::string getLastExecutedDecision();
 
     const std::string& getConfigFilename();
@@ -431,6 +439,19 @@ namespace EUROPA {
     PSSolver();
   };
 
+  class PSFlawIterator
+  {
+  public:
+    virtual ~PSFlawIterator();
+    bool done() const;
+    void next();
+    PSEntityKey getEntityKey() const;
+    const std::string& getFlawManager() const;
+    double getPriority() const;
+  protected:
+    PSFlawIterator();
+  };
+
   enum PSTokenState { INACTIVE,ACTIVE,MERGED,REJECTED };
 
   class PSToken : public PSEntity
@@ -474,6 +495,16 @@ namespace EUROPA {
     PSToken();
   };
 
+  class PSTokenIterator
+  {
+  public:
+    virtual ~PSTokenIterator();
+    bool done() const;
+    PSToken* next();
+  protected:
+    PSTokenIterator();
+  };
+
   enum PSVarType {INTEGER,DOUBLE,BOOLEAN,STRING,OBJECT};
 
   class PSVariable : public PSEntity
@@ -589,6 +620,7 @@ namespace EUROPA {
       void deleteObject(PSObject* obj) = 0;
 
       PSToken* createToken(const std::string& predicateName, bool rejectable, bool isFact) = 0;
+      PSList<PSToken*> createTokens(const std::string& predicateName, unsigned int count, bool rejectable, bool isFact) = 0;
       void deleteToken(PSToken* token) = 0;
 
       void constrain(PSObject* object, PSToken* predecessor, PSToken* successor) = 0;
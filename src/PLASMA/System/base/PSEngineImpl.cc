@@ -100,6 +100,18 @@ PSEngineImpl::PSEngineImpl() : m_started(false) {}
     return getPlanDatabase()->getTokenByKey(id);
   }
 
+  PSTokenIterator* PSEngineImpl::getTokensOverlapping(PSObject* object, double lb, double ub)
+  {
+    check_runtime_error(isStarted(),"PSEngine has not been started");
+    return getPlanDatabase()->getTokensOverlapping(object, lb, ub);
+  }
+
+  PSTokenIterator* PSEngineImpl::getActiveTokensStartingIn(const std::string& predicate, double lb, double ub)
+  {
+    check_runtime_error(isStarted(),"PSEngine has not been started");
+    return getPlanDatabase()->getActiveTokensStartingIn(predicate, lb, ub);
+  }
+
   PSList<PSVariable*>  PSEngineImpl::getGlobalVariables()
   {
     check_runtime_error(isStarted(),"PSEngine has not been started");
@@ -47,6 +47,8 @@ namespace EUROPA {
 
     virtual PSList<PSToken*> getTokens();
     virtual PSToken* getTokenByKey(PSEntityKey id);
+    virtual PSTokenIterator* getTokensOverlapping(PSObject* object, double lb, double ub);
+    virtual PSTokenIterator* getActiveTokensStartingIn(const std::string& predicate, double lb, double ub);
 
     virtual PSList<PSVariable*> getGlobalVariables();
 
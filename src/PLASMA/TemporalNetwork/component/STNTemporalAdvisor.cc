@@ -15,6 +15,13 @@ namespace EUROPA {
 
   STNTemporalAdvisor::~STNTemporalAdvisor(){}
 
+  TemporalAdvisorId STNTemporalAdvisor::copy(const ConstraintEngineId constraintEngine) const {
+    TemporalPropagatorId propagator = constraintEngine->getPropagatorByName(m_propagator->getName());
+    checkError(propagator.isValid(),
+               "No temporal propagator named " << m_propagator->getName().toString() << " to copy onto.");
+    return (new STNTemporalAdvisor(propagator))->getId();
+  }
+
   bool STNTemporalAdvisor::canPrecede(const TokenId first, const TokenId second){    
     if (!DefaultTemporalAdvisor::canPrecede(first, second))
       return false;
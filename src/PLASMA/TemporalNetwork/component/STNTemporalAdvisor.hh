@@ -42,6 +42,11 @@ namespace EUROPA{
                                           std::vector<eint>& ubs);
 
     unsigned int mostRecentRepropagation() const;
+
+    /**
+     * @brief Binds the copy to the propagator of the same name in the given engine.
+     */
+    TemporalAdvisorId copy(const ConstraintEngineId constraintEngine) const;
   private:
     TemporalPropagatorId m_propagator;
 
@@ -35,6 +35,10 @@ namespace EUROPA {
 
   typedef Id<TimepointWrapper> TimepointWrapperId;
 
+PropagatorId TemporalPropagator::copy(const ConstraintEngineId constraintEngine) const {
+  return (new TemporalPropagator(getName(), constraintEngine))->getId();
+}
+
 TemporalPropagator::TemporalPropagator(const LabelStr& name, 
                                        const ConstraintEngineId constraintEngine)
     : Propagator(name, constraintEngine), m_tnet((new TemporalNetwork())->getId()),
@@ -23,6 +23,7 @@ namespace EUROPA {
   public:
     TemporalPropagator(const LabelStr& name, const ConstraintEngineId constraintEngine);
     virtual ~TemporalPropagator();
+    PropagatorId copy(const ConstraintEngineId constraintEngine) const;
     void execute();
     bool updateRequired() const;
 